@@ -0,0 +1,196 @@
+//
+//  BenchHttpServer.cpp
+//  StackManagerQt/bench
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "BenchHttpServer.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+#include <QTcpSocket>
+
+const qint64 WRITE_CHUNK_BYTES = 64 * 1024;
+const int THROTTLE_TICK_MS = 10;
+
+BenchHttpServer::BenchHttpServer(QObject* parent) :
+    QTcpServer(parent),
+    _bytesPerSec(0),
+    _port(0),
+    _requestCount(0),
+    _throttleTimer(this)
+{
+    _throttleTimer.setInterval(THROTTLE_TICK_MS);
+    connect(&_throttleTimer, &QTimer::timeout, this, &BenchHttpServer::refillBudgets);
+    connect(this, &QTcpServer::newConnection, this, &BenchHttpServer::handleNewConnection);
+}
+
+void BenchHttpServer::setFile(const QString& path, const QByteArray& body) {
+    QMutexLocker locker(&_mutex);
+    _files[path] = body;
+}
+
+void BenchHttpServer::setThrottle(qint64 bytesPerSec) {
+    QMutexLocker locker(&_mutex);
+    _bytesPerSec = bytesPerSec;
+}
+
+void BenchHttpServer::queueFaults(const QList<Fault>& faults) {
+    QMutexLocker locker(&_mutex);
+    _faults << faults;
+}
+
+quint16 BenchHttpServer::getPort() {
+    QMutexLocker locker(&_mutex);
+    return _port;
+}
+
+int BenchHttpServer::getRequestCount() {
+    QMutexLocker locker(&_mutex);
+    return _requestCount;
+}
+
+void BenchHttpServer::start() {
+    if (!listen(QHostAddress::LocalHost)) {
+        qWarning() << "Benchmark HTTP server could not listen -" << errorString();
+        return;
+    }
+
+    _throttleTimer.start();
+
+    QMutexLocker locker(&_mutex);
+    _port = serverPort();
+}
+
+void BenchHttpServer::handleNewConnection() {
+    while (hasPendingConnections()) {
+        QTcpSocket* socket = nextPendingConnection();
+        _responses.insert(socket, Response());
+
+        connect(socket, &QTcpSocket::readyRead, this, &BenchHttpServer::handleReadyRead);
+        connect(socket, &QTcpSocket::bytesWritten, this, &BenchHttpServer::handleBytesWritten);
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+    }
+}
+
+void BenchHttpServer::handleReadyRead() {
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    if (!_responses.contains(socket) || _responses[socket].isHeaderRead) {
+        // one request per connection, anything after it is ignored
+        socket->readAll();
+        return;
+    }
+
+    Response& response = _responses[socket];
+
+    response.request += socket->readAll();
+    if (response.request.contains("\r\n\r\n")) {
+        response.isHeaderRead = true;
+        respond(socket, response);
+    }
+}
+
+void BenchHttpServer::respond(QTcpSocket* socket, Response& response) {
+    // GET /path HTTP/1.1
+    QList<QByteArray> requestLine = response.request.left(response.request.indexOf("\r\n")).split(' ');
+    QString path = requestLine.size() > 1 ? QString::fromUtf8(requestLine[1]) : QString();
+
+    Fault fault = FaultNone;
+    bool hasFile = false;
+    {
+        QMutexLocker locker(&_mutex);
+        ++_requestCount;
+
+        if (!_faults.isEmpty()) {
+            fault = _faults.takeFirst();
+        }
+
+        hasFile = _files.contains(path);
+        if (hasFile) {
+            response.body = _files[path];
+        }
+    }
+
+    if (!hasFile || fault == FaultServerError) {
+        socket->write(hasFile ? "HTTP/1.1 503 Service Unavailable\r\n" : "HTTP/1.1 404 Not Found\r\n");
+        socket->write("Content-Length: 0\r\nConnection: close\r\n\r\n");
+        socket->disconnectFromHost();
+        _responses.remove(socket);
+        return;
+    }
+
+    socket->write(QString("HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\n"
+                          "Content-Length: %1\r\nConnection: close\r\n\r\n").arg(response.body.size()).toLatin1());
+
+    response.dropsConnection = fault == FaultDropConnection;
+    response.end = response.dropsConnection ? response.body.size() / 2 : response.body.size();
+
+    pump(socket);
+}
+
+void BenchHttpServer::handleBytesWritten() {
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    if (_responses.contains(socket)) {
+        pump(socket);
+    }
+}
+
+void BenchHttpServer::refillBudgets() {
+    qint64 bytesPerSec;
+    {
+        QMutexLocker locker(&_mutex);
+        bytesPerSec = _bytesPerSec;
+    }
+
+    if (bytesPerSec <= 0 || _responses.isEmpty()) {
+        return;
+    }
+
+    // a late tick does not make up for lost time beyond a second's worth
+    QList<QTcpSocket*> sockets = _responses.keys();
+    foreach(QTcpSocket* socket, sockets) {
+        Response& response = _responses[socket];
+        response.budget = qMin(response.budget + bytesPerSec * THROTTLE_TICK_MS / 1000, bytesPerSec);
+        pump(socket);
+    }
+}
+
+void BenchHttpServer::pump(QTcpSocket* socket) {
+    Response& response = _responses[socket];
+    if (!response.isHeaderRead) {
+        return;
+    }
+
+    bool isThrottled;
+    {
+        QMutexLocker locker(&_mutex);
+        isThrottled = _bytesPerSec > 0;
+    }
+
+    // keep only a chunk queued on the socket, the body is never copied into it whole
+    while (response.offset < response.end && socket->bytesToWrite() < WRITE_CHUNK_BYTES) {
+        qint64 chunk = qMin(WRITE_CHUNK_BYTES, response.end - response.offset);
+        if (isThrottled) {
+            chunk = qMin(chunk, response.budget);
+            if (chunk <= 0) {
+                return;
+            }
+            response.budget -= chunk;
+        }
+
+        socket->write(response.body.constData() + response.offset, chunk);
+        response.offset += chunk;
+    }
+
+    if (response.offset == response.end && socket->bytesToWrite() == 0) {
+        bool dropsConnection = response.dropsConnection;
+        _responses.remove(socket);
+
+        if (dropsConnection) {
+            socket->abort();
+        } else {
+            socket->disconnectFromHost();
+        }
+    }
+}
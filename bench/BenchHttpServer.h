@@ -0,0 +1,110 @@
+//
+//  BenchHttpServer.h
+//  StackManagerQt/bench
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_BenchHttpServer_h
+#define hifi_BenchHttpServer_h
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QTcpServer>
+#include <QThread>
+#include <QTimer>
+#include <QUrl>
+
+class QTcpSocket;
+
+// A local stand-in for the download servers and the domain-server's HTTP API. Serves whatever
+// bodies it was given by path, one request per connection, optionally throttled to a fixed rate,
+// and can be told to fail the next few requests. Meant to live on a thread of its own so serving
+// does not compete with the client under test for the event loop; the setters may be called
+// from any thread.
+class BenchHttpServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    enum Fault {
+        FaultNone = 0,
+        FaultServerError, // answers 503
+        FaultDropConnection // closes the connection halfway through the body
+    };
+
+    BenchHttpServer(QObject* parent = 0);
+
+    void setFile(const QString& path, const QByteArray& body);
+    void setThrottle(qint64 bytesPerSec); // 0 for as fast as the socket takes it
+    void queueFaults(const QList<Fault>& faults); // one for each of the next requests
+
+    quint16 getPort();
+    int getRequestCount();
+
+public slots:
+    void start(); // on the server's thread
+
+private slots:
+    void handleNewConnection();
+    void handleReadyRead();
+    void handleBytesWritten();
+    void refillBudgets();
+
+private:
+    struct Response {
+        Response() : offset(0), end(0), budget(0), isHeaderRead(false), dropsConnection(false) {}
+
+        QByteArray request;
+        QByteArray body;
+        qint64 offset;
+        qint64 end; // where to stop writing the body, short of its size for a dropped connection
+        qint64 budget; // bytes the throttle still allows
+        bool isHeaderRead;
+        bool dropsConnection;
+    };
+
+    void respond(QTcpSocket* socket, Response& response);
+    void pump(QTcpSocket* socket);
+
+    QMutex _mutex;
+    QHash<QString, QByteArray> _files;
+    qint64 _bytesPerSec;
+    QList<Fault> _faults;
+    quint16 _port;
+    int _requestCount;
+
+    QHash<QTcpSocket*, Response> _responses;
+    QTimer _throttleTimer;
+};
+
+// a server on its own thread that goes away with the benchmark
+class BenchServerThread
+{
+public:
+    BenchServerThread() {
+        _server = new BenchHttpServer();
+        _server->moveToThread(&_thread);
+        QObject::connect(&_thread, &QThread::finished, _server, &QObject::deleteLater);
+        _thread.start();
+
+        QMetaObject::invokeMethod(_server, "start", Qt::BlockingQueuedConnection);
+    }
+
+    ~BenchServerThread() {
+        _thread.quit();
+        _thread.wait();
+    }
+
+    BenchHttpServer* getServer() { return _server; }
+
+    QString getBaseUrl() { return QString("http://127.0.0.1:%1").arg(_server->getPort()); }
+    QUrl urlFor(const QString& path) { return QUrl(getBaseUrl() + path); }
+
+private:
+    QThread _thread;
+    BenchHttpServer* _server;
+};
+
+#endif
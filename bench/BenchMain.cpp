@@ -0,0 +1,333 @@
+//
+//  BenchMain.cpp
+//  StackManagerQt/bench
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+//  stack-manager-bench measures the Stack Manager's hot paths against local fixtures: log capture
+//  from chatty children, downloads and zip extraction from a local HTTP server, stack start and
+//  stop, startup of the real binary, rendering and scraping of the metrics endpoint, and polling
+//  of domain-server stats. Results are written as JSON so runs can be compared between releases.
+//
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+#include <cstdio>
+
+#include "Benchmarks.h"
+#include "GlobalData.h"
+#include "ProcessStats.h"
+#include "StackManagerVersion.h"
+
+const QString LOG_CAPTURE_SUITE = "log-capture";
+const QString DOWNLOAD_SUITE = "download";
+const QString ZIP_SUITE = "zip";
+const QString STACK_SUITE = "stack";
+const QString STARTUP_SUITE = "startup";
+const QString METRICS_SUITE = "metrics";
+const QString DOMAIN_STATS_SUITE = "domain-stats";
+
+void benchWait(int msecs) {
+    QEventLoop loop;
+    QTimer::singleShot(msecs, &loop, SLOT(quit()));
+    loop.exec();
+}
+
+bool benchWaitForSignal(QObject* sender, const char* signal, int timeoutMSecs) {
+    QEventLoop loop;
+    QTimer timer;
+    timer.setSingleShot(true);
+
+    QObject::connect(sender, signal, &loop, SLOT(quit()));
+    QObject::connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+
+    timer.start(timeoutMSecs);
+    loop.exec();
+
+    return timer.isActive();
+}
+
+qint64 benchResidentBytes() {
+    ProcessSample sample;
+    return ProcessStats::sample(QCoreApplication::applicationPid(), sample) ? sample.residentBytes : -1;
+}
+
+qint64 benchCpuMSecs() {
+    ProcessSample sample;
+    return ProcessStats::sample(QCoreApplication::applicationPid(), sample) ? sample.cpuMSecs : -1;
+}
+
+QString benchToolPath(const QString& name) {
+#ifdef Q_OS_WIN
+    return QCoreApplication::applicationDirPath() + "/" + name + ".exe";
+#else
+    return QCoreApplication::applicationDirPath() + "/" + name;
+#endif
+}
+
+static double percentile(const QVector<double>& sorted, double fraction) {
+    int index = qBound(0, int(fraction * sorted.size()), sorted.size() - 1);
+    return sorted[index];
+}
+
+QJsonObject benchSummary(QVector<double> values) {
+    QJsonObject summary;
+    summary["count"] = values.size();
+
+    if (values.isEmpty()) {
+        return summary;
+    }
+
+    std::sort(values.begin(), values.end());
+
+    double total = 0;
+    foreach(double value, values) {
+        total += value;
+    }
+
+    summary["min"] = values.first();
+    summary["p50"] = percentile(values, 0.5);
+    summary["p90"] = percentile(values, 0.9);
+    summary["p99"] = percentile(values, 0.99);
+    summary["max"] = values.last();
+    summary["mean"] = total / values.size();
+    return summary;
+}
+
+static QList<int> parseIntList(const QString& text) {
+    QList<int> values;
+    foreach(const QString& item, text.split(',', QString::SkipEmptyParts)) {
+        int value = item.trimmed().toInt();
+        if (value > 0) {
+            values << value;
+        }
+    }
+    return values;
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("Stack Manager Bench");
+    app.setOrganizationName("High Fidelity");
+
+    // GlobalData puts downloads and child logs under the data location, keep them out of the real one
+    QStandardPaths::setTestModeEnabled(true);
+
+    QStringList suites = QStringList() << LOG_CAPTURE_SUITE << DOWNLOAD_SUITE << ZIP_SUITE << STACK_SUITE << STARTUP_SUITE
+                                       << METRICS_SUITE << DOMAIN_STATS_SUITE;
+
+    BenchOptions options;
+    options.logRates << 1000 << 10000 << 50000;
+#ifdef Q_OS_OSX
+    options.stackManagerPath = QCoreApplication::applicationDirPath() + "/StackManager.app/Contents/MacOS/StackManager";
+#else
+    options.stackManagerPath = benchToolPath("StackManager");
+#endif
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("High Fidelity Stack Manager benchmarks");
+    const QCommandLineOption helpOption = parser.addHelpOption();
+
+    const QCommandLineOption outputOption("output", "Write results here instead of to stdout", "json-file");
+    parser.addOption(outputOption);
+
+    const QCommandLineOption suiteOption("suite", "Only run these, comma separated: " + suites.join(", "), "names");
+    parser.addOption(suiteOption);
+
+    const QCommandLineOption logRatesOption("log-rates", "Child stdout lines per second for each log capture run", "list");
+    parser.addOption(logRatesOption);
+
+    const QCommandLineOption logSecondsOption("log-seconds", "How long each chatty child runs", "seconds");
+    parser.addOption(logSecondsOption);
+
+    const QCommandLineOption lineBytesOption("line-bytes", "Size of each chatty child line", "bytes");
+    parser.addOption(lineBytesOption);
+
+    const QCommandLineOption downloadOption("download-mb", "Size of the unthrottled download", "megabytes");
+    parser.addOption(downloadOption);
+
+    const QCommandLineOption throttleOption("throttle-kbps", "Rate of the throttled download", "kilobytes");
+    parser.addOption(throttleOption);
+
+    const QCommandLineOption zipFilesOption("zip-files", "Files in the extracted archive", "count");
+    parser.addOption(zipFilesOption);
+
+    const QCommandLineOption zipFileSizeOption("zip-file-kb", "Size of each file in the extracted archive", "kilobytes");
+    parser.addOption(zipFileSizeOption);
+
+    const QCommandLineOption stackIterationsOption("stack-iterations", "Stack start/stop cycles", "count");
+    parser.addOption(stackIterationsOption);
+
+    const QCommandLineOption stackClientsOption("stack-assignment-clients", "Assignment-clients in the benchmark stack", "count");
+    parser.addOption(stackClientsOption);
+
+    const QCommandLineOption stackManagerOption("stack-manager", "Stack Manager binary to time startup of", "path");
+    parser.addOption(stackManagerOption);
+
+    const QCommandLineOption startupRunsOption("startup-runs", "Stack Manager launches to time", "count");
+    parser.addOption(startupRunsOption);
+
+    const QCommandLineOption startupSettleOption("startup-settle", "How long each launch runs before it is quit", "seconds");
+    parser.addOption(startupSettleOption);
+
+    const QCommandLineOption metricsSeriesOption("metrics-series", "Series in the scraped metrics registry", "count");
+    parser.addOption(metricsSeriesOption);
+
+    const QCommandLineOption metricsScrapesOption("metrics-scrapes", "Scrapes of the metrics endpoint to time", "count");
+    parser.addOption(metricsScrapesOption);
+
+    if (!parser.parse(QCoreApplication::arguments())) {
+        qCritical() << parser.errorText() << endl;
+        parser.showHelp(1);
+    }
+
+    if (parser.isSet(helpOption)) {
+        parser.showHelp();
+    }
+
+    if (parser.isSet(logRatesOption)) {
+        options.logRates = parseIntList(parser.value(logRatesOption));
+    }
+    if (parser.isSet(logSecondsOption)) {
+        options.logSeconds = qMax(1, parser.value(logSecondsOption).toInt());
+    }
+    if (parser.isSet(lineBytesOption)) {
+        options.logLineBytes = qMax(64, parser.value(lineBytesOption).toInt());
+    }
+    if (parser.isSet(downloadOption)) {
+        options.downloadMB = qMax(1, parser.value(downloadOption).toInt());
+    }
+    if (parser.isSet(throttleOption)) {
+        options.throttleKBps = qMax(1, parser.value(throttleOption).toInt());
+    }
+    if (parser.isSet(zipFilesOption)) {
+        options.zipFiles = qMax(1, parser.value(zipFilesOption).toInt());
+    }
+    if (parser.isSet(zipFileSizeOption)) {
+        options.zipFileKB = qMax(1, parser.value(zipFileSizeOption).toInt());
+    }
+    if (parser.isSet(stackIterationsOption)) {
+        options.stackIterations = qMax(1, parser.value(stackIterationsOption).toInt());
+    }
+    if (parser.isSet(stackClientsOption)) {
+        options.stackAssignmentClients = qMax(1, parser.value(stackClientsOption).toInt());
+    }
+    if (parser.isSet(stackManagerOption)) {
+        options.stackManagerPath = parser.value(stackManagerOption);
+    }
+    if (parser.isSet(startupRunsOption)) {
+        options.startupRuns = qMax(1, parser.value(startupRunsOption).toInt());
+    }
+    if (parser.isSet(startupSettleOption)) {
+        options.startupSettleSecs = qMax(1, parser.value(startupSettleOption).toInt());
+    }
+
+    if (parser.isSet(metricsSeriesOption)) {
+        options.metricsSeries = qMax(1, parser.value(metricsSeriesOption).toInt());
+    }
+    if (parser.isSet(metricsScrapesOption)) {
+        options.metricsScrapes = qMax(1, parser.value(metricsScrapesOption).toInt());
+    }
+
+    if (parser.isSet(suiteOption)) {
+        suites = parser.value(suiteOption).split(',', QString::SkipEmptyParts);
+    }
+
+    QTemporaryDir workDir;
+    if (!workDir.isValid()) {
+        qCritical() << "Could not create a scratch directory.";
+        return 1;
+    }
+    options.workPath = workDir.path();
+
+    // the directories a real install would already have
+    QDir().mkpath(GlobalData::getInstance().getClientsLaunchPath());
+    QDir().mkpath(GlobalData::getInstance().getProcessLogsPath());
+
+    QJsonObject results;
+    int exitCode = 0;
+    foreach(const QString& suite, suites) {
+        qDebug() << "Running" << suite << "benchmark.";
+
+        QElapsedTimer suiteTimer;
+        suiteTimer.start();
+
+        QJsonObject result;
+        if (suite == LOG_CAPTURE_SUITE) {
+            result = runLogCaptureBenchmark(options);
+        } else if (suite == DOWNLOAD_SUITE) {
+            result = runDownloadBenchmark(options);
+        } else if (suite == ZIP_SUITE) {
+            result = runZipBenchmark(options);
+        } else if (suite == STACK_SUITE) {
+            result = runStackBenchmark(options);
+        } else if (suite == STARTUP_SUITE) {
+            result = runStartupBenchmark(options);
+        } else if (suite == METRICS_SUITE) {
+            result = runMetricsBenchmark(options);
+        } else if (suite == DOMAIN_STATS_SUITE) {
+            result = runDomainStatsBenchmark(options);
+        } else {
+            qWarning() << "Ignoring unknown benchmark" << suite;
+            continue;
+        }
+
+        result["suite_ms"] = double(suiteTimer.elapsed());
+        results[suite] = result;
+
+        if (!result.value("failed_checks").toArray().isEmpty()) {
+            qWarning() << suite << "failed" << result.value("failed_checks").toArray().size() << "checks.";
+            exitCode = 1;
+        }
+    }
+
+    // only ever the test-mode location, see above
+    QDir(QStandardPaths::writableLocation(QStandardPaths::DataLocation)).removeRecursively();
+
+    QJsonObject host;
+    host["cpus"] = QThread::idealThreadCount();
+    host["qt"] = QString(qVersion());
+#if defined Q_OS_OSX
+    host["os"] = QString("mac");
+#elif defined Q_OS_WIN32
+    host["os"] = QString("win");
+#elif defined Q_OS_LINUX
+    host["os"] = QString("linux");
+#endif
+
+    QJsonObject root;
+    root["version"] = BUILD_VERSION;
+    root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["host"] = host;
+    root["results"] = results;
+
+    QByteArray json = QJsonDocument(root).toJson();
+
+    if (!parser.isSet(outputOption)) {
+        fwrite(json.constData(), 1, json.size(), stdout);
+        return exitCode;
+    }
+
+    QSaveFile outputFile(parser.value(outputOption));
+    if (!outputFile.open(QIODevice::WriteOnly) || outputFile.write(json) != json.size() || !outputFile.commit()) {
+        qCritical() << "Could not write results to" << parser.value(outputOption);
+        return 1;
+    }
+
+    qDebug() << "Wrote results to" << parser.value(outputOption);
+    return exitCode;
+}
@@ -0,0 +1,66 @@
+//
+//  Benchmarks.h
+//  StackManagerQt/bench
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_Benchmarks_h
+#define hifi_Benchmarks_h
+
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+class QObject;
+
+struct BenchOptions {
+    BenchOptions() : logSeconds(5), logLineBytes(120), downloadMB(64), throttleKBps(8 * 1024), zipFiles(200),
+        zipFileKB(256), stackIterations(5), stackAssignmentClients(4), startupRuns(3), startupSettleSecs(5),
+        metricsSeries(500), metricsScrapes(200) {}
+
+    QList<int> logRates; // stdout lines per second for each run, stderr gets a tenth of it
+    int logSeconds;
+    int logLineBytes;
+    int downloadMB;
+    int throttleKBps;
+    int zipFiles;
+    int zipFileKB;
+    int stackIterations;
+    int stackAssignmentClients;
+    QString stackManagerPath;
+    int startupRuns;
+    int startupSettleSecs;
+    int metricsSeries;
+    int metricsScrapes;
+    QString workPath; // scratch space, removed afterwards
+};
+
+QJsonObject runLogCaptureBenchmark(const BenchOptions& options);
+QJsonObject runDownloadBenchmark(const BenchOptions& options);
+QJsonObject runZipBenchmark(const BenchOptions& options);
+QJsonObject runStackBenchmark(const BenchOptions& options);
+QJsonObject runStartupBenchmark(const BenchOptions& options);
+QJsonObject runMetricsBenchmark(const BenchOptions& options);
+
+// also checks the poller against canned domain-server replies, any failures are listed in the
+// result's failed_checks and fail the run
+QJsonObject runDomainStatsBenchmark(const BenchOptions& options);
+
+// runs the event loop for this long
+void benchWait(int msecs);
+
+// runs the event loop until the signal comes or the timeout passes, false on timeout
+bool benchWaitForSignal(QObject* sender, const char* signal, int timeoutMSecs);
+
+qint64 benchResidentBytes();
+qint64 benchCpuMSecs();
+
+// a tool built alongside the benchmarks
+QString benchToolPath(const QString& name);
+
+// count, min, p50, p90, p99, max and mean
+QJsonObject benchSummary(QVector<double> values);
+
+#endif
@@ -0,0 +1,109 @@
+//
+//  ChattyChild.cpp
+//  StackManagerQt/bench
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+//  stack-manager-chatty-child writes hifi-style log lines to stdout and stderr at fixed rates,
+//  standing in for a domain-server or assignment-client in the benchmarks. Every line carries
+//  its sequence number and the wall-clock time it was written, so whoever captures the output
+//  can work out how late it arrived. Arguments it does not know are ignored.
+//
+//    stack-manager-chatty-child [--stdout-rate lines/s] [--stderr-rate lines/s]
+//                               [--line-bytes n] [--seconds n]
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QThread>
+
+const int DEFAULT_STDOUT_LINES_PER_SEC = 10;
+const int DEFAULT_STDERR_LINES_PER_SEC = 1;
+const int DEFAULT_LINE_BYTES = 120;
+const int TICK_MS = 5;
+
+struct ChattyStream {
+    ChattyStream(FILE* file, int linesPerSec) : file(file), linesPerSec(linesPerSec), written(0) {}
+
+    FILE* file;
+    int linesPerSec;
+    qint64 written;
+};
+
+static int intArgument(int argc, char* argv[], const char* name, int defaultValue) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (strcmp(argv[i], name) == 0) {
+            return atoi(argv[i + 1]);
+        }
+    }
+    return defaultValue;
+}
+
+static void writeLines(ChattyStream& stream, qint64 due, const QByteArray& prefix, int lineBytes) {
+    if (stream.written >= due) {
+        return;
+    }
+
+    char line[4096];
+    const char* level = stream.file == stderr ? "WARNING" : "DEBUG";
+
+    for (; stream.written < due; ++stream.written) {
+        int length = snprintf(line, sizeof(line) - 1, "[%s] [%s] [%lld] [bench] seq=%lld sent=%lld ",
+                              prefix.constData(), level, (long long)QCoreApplication::applicationPid(),
+                              (long long)stream.written, (long long)QDateTime::currentMSecsSinceEpoch());
+
+        // pad out to the asked for size, newline included
+        int lineEnd = qBound(length, lineBytes - 1, int(sizeof(line)) - 1);
+        memset(line + length, 'x', lineEnd - length);
+        line[lineEnd] = '\n';
+
+        fwrite(line, 1, lineEnd + 1, stream.file);
+    }
+
+    fflush(stream.file);
+}
+
+int main(int argc, char* argv[]) {
+    ChattyStream out(stdout, intArgument(argc, argv, "--stdout-rate", DEFAULT_STDOUT_LINES_PER_SEC));
+    ChattyStream err(stderr, intArgument(argc, argv, "--stderr-rate", DEFAULT_STDERR_LINES_PER_SEC));
+    int lineBytes = intArgument(argc, argv, "--line-bytes", DEFAULT_LINE_BYTES);
+    qint64 runMSecs = qint64(intArgument(argc, argv, "--seconds", 0)) * 1000; // 0 runs until terminated
+
+    QElapsedTimer clock;
+    clock.start();
+
+    QByteArray prefix;
+    qint64 prefixSecs = -1;
+
+    while (true) {
+        qint64 elapsed = clock.elapsed();
+        bool isLastTick = runMSecs > 0 && elapsed >= runMSecs;
+        if (isLastTick) {
+            // lands exactly on rate times duration
+            elapsed = runMSecs;
+        }
+
+        qint64 nowSecs = QDateTime::currentMSecsSinceEpoch() / 1000;
+        if (nowSecs != prefixSecs) {
+            prefix = QDateTime::currentDateTime().toString("MM/dd hh:mm:ss").toLatin1();
+            prefixSecs = nowSecs;
+        }
+
+        writeLines(out, out.linesPerSec * elapsed / 1000, prefix, lineBytes);
+        writeLines(err, err.linesPerSec * elapsed / 1000, prefix, lineBytes);
+
+        if (isLastTick) {
+            break;
+        }
+
+        QThread::msleep(TICK_MS);
+    }
+
+    return 0;
+}
@@ -0,0 +1,202 @@
+//
+//  DomainStatsBench.cpp
+//  StackManagerQt/bench
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QNetworkAccessManager>
+
+#include "BenchHttpServer.h"
+#include "Benchmarks.h"
+#include "DomainStatsPoller.h"
+#include "HttpClient.h"
+
+const QString NODES_PATH = "/nodes.json";
+const QString ASSIGNMENTS_PATH = "/assignments.json";
+
+const QStringList NODE_TYPES = QStringList() << "audio-mixer" << "avatar-mixer" << "agent";
+const int PENDING_ASSIGNMENTS = 2;
+const int FULFILLED_ASSIGNMENTS = 5;
+
+const int POLL_TIMEOUT_MS = 10 * 1000;
+const int RING_OVERRUN_POLLS = 25;
+
+// slow enough that a second poll comes while the first is still reading nodes.json
+const int SLOW_POLL_NODES = 40;
+const qint64 SLOW_POLL_BYTES_PER_SEC = 4 * 1024;
+const int SKIPPED_POLL_SETTLE_MS = 500;
+
+// node i has type i % 3 and reports 10 * (i + 1) kbps in and 5 * (i + 1) out
+static double inboundKbpsOf(int node) {
+    return 10.0 * (node + 1);
+}
+
+static double outboundKbpsOf(int node) {
+    return 5.0 * (node + 1);
+}
+
+static QByteArray nodesJson(int nodeCount, bool hasBandwidth) {
+    QJsonArray nodes;
+    for (int i = 0; i < nodeCount; ++i) {
+        QJsonObject node;
+        node["type"] = NODE_TYPES[i % NODE_TYPES.size()];
+        node["uuid"] = QString("00000000-0000-0000-0000-%1").arg(i, 12, 10, QChar('0'));
+        if (hasBandwidth) {
+            node["inbound_kbps"] = inboundKbpsOf(i);
+            node["outbound_kbps"] = outboundKbpsOf(i);
+        }
+        nodes.append(node);
+    }
+
+    QJsonObject root;
+    root["nodes"] = nodes;
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+static QByteArray assignmentsJson() {
+    QJsonObject queued;
+    for (int i = 0; i < PENDING_ASSIGNMENTS; ++i) {
+        queued[QString("queued-%1").arg(i)] = QJsonObject();
+    }
+
+    QJsonObject fulfilled;
+    for (int i = 0; i < FULFILLED_ASSIGNMENTS; ++i) {
+        fulfilled[QString("fulfilled-%1").arg(i)] = QJsonObject();
+    }
+
+    QJsonObject root;
+    root["queued"] = queued;
+    root["fulfilled"] = fulfilled;
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+// every poll a different count, so each slot of the ring can be told apart
+static int nodeCountForPoll(int poll) {
+    return 1 + poll % 7;
+}
+
+static void check(QStringList& failedChecks, bool condition, const QString& description) {
+    if (!condition) {
+        qWarning() << "Check failed:" << description;
+        failedChecks << description;
+    }
+}
+
+static bool pollOnce(DomainStatsPoller& poller) {
+    poller.poll();
+    return benchWaitForSignal(&poller, SIGNAL(sampled()), POLL_TIMEOUT_MS);
+}
+
+static void checkLatestSample(QStringList& failedChecks, const DomainStatsPoller& poller, int nodeCount,
+                              bool hasBandwidth) {
+    const DomainStatsSample& latest = poller.getLatestSample();
+
+    check(failedChecks, latest.nodeCount == nodeCount, QString("latest sample has %1 nodes").arg(nodeCount));
+    check(failedChecks, latest.pendingAssignments == PENDING_ASSIGNMENTS, "pending assignments are counted");
+    check(failedChecks, latest.fulfilledAssignments == FULFILLED_ASSIGNMENTS, "fulfilled assignments are counted");
+    check(failedChecks, latest.hasBandwidth == hasBandwidth,
+          hasBandwidth ? "reported bandwidth is noticed" : "missing bandwidth is noticed");
+
+    for (int type = 0; type < NODE_TYPES.size(); ++type) {
+        int expectedNodes = 0;
+        double expectedInboundKbps = 0.0;
+        double expectedOutboundKbps = 0.0;
+        for (int node = type; node < nodeCount; node += NODE_TYPES.size()) {
+            ++expectedNodes;
+            if (hasBandwidth) {
+                expectedInboundKbps += inboundKbpsOf(node);
+                expectedOutboundKbps += outboundKbpsOf(node);
+            }
+        }
+
+        int index = poller.getNodeTypes().indexOf(NODE_TYPES[type]);
+        bool hasType = index >= 0 && index < latest.nodesByType.size();
+
+        check(failedChecks, expectedNodes == 0 || (hasType && latest.nodesByType[index] == expectedNodes),
+              QString("%1 nodes are counted").arg(NODE_TYPES[type]));
+        check(failedChecks, !hasType || (latest.inboundKbpsByType[index] == expectedInboundKbps
+                                         && latest.outboundKbpsByType[index] == expectedOutboundKbps),
+              QString("%1 bandwidth is summed").arg(NODE_TYPES[type]));
+    }
+}
+
+QJsonObject runDomainStatsBenchmark(const BenchOptions& options) {
+    Q_UNUSED(options);
+
+    BenchServerThread serverThread;
+    BenchHttpServer* server = serverThread.getServer();
+    server->setFile(ASSIGNMENTS_PATH, assignmentsJson());
+
+    QNetworkAccessManager manager;
+    HttpClient httpClient(&manager);
+
+    // never started, every poll below is asked for explicitly
+    DomainStatsPoller poller(&httpClient);
+    poller.setBaseUrl(serverThread.getBaseUrl());
+
+    QStringList failedChecks;
+    QVector<double> pollTimes;
+
+    // more polls than the ring holds, so the oldest ones have to have been overwritten
+    int pollCount = DomainStatsPoller::HISTORY_SAMPLES + RING_OVERRUN_POLLS;
+    int completedPolls = 0;
+    for (; completedPolls < pollCount; ++completedPolls) {
+        server->setFile(NODES_PATH, nodesJson(nodeCountForPoll(completedPolls), true));
+
+        QElapsedTimer timer;
+        timer.start();
+        if (!pollOnce(poller)) {
+            check(failedChecks, false, QString("poll %1 produces a sample").arg(completedPolls));
+            break;
+        }
+        pollTimes << timer.nsecsElapsed() / 1000000.0;
+    }
+
+    if (completedPolls == pollCount) {
+        check(failedChecks, poller.getSampleCount() == DomainStatsPoller::HISTORY_SAMPLES, "the ring is full");
+
+        bool isInOrder = true;
+        for (int i = 0; i < poller.getSampleCount(); ++i) {
+            int poll = pollCount - poller.getSampleCount() + i;
+            isInOrder &= poller.getSample(i).nodeCount == nodeCountForPoll(poll);
+        }
+        check(failedChecks, isInOrder, "the ring holds the newest polls, oldest first");
+
+        checkLatestSample(failedChecks, poller, nodeCountForPoll(pollCount - 1), true);
+    }
+
+    // a tick that comes while a poll is out is skipped, not queued behind it
+    server->setFile(NODES_PATH, nodesJson(SLOW_POLL_NODES, true));
+    server->setThrottle(SLOW_POLL_BYTES_PER_SEC);
+    int requestsBefore = server->getRequestCount();
+
+    poller.poll();
+    poller.poll();
+    bool isSampled = benchWaitForSignal(&poller, SIGNAL(sampled()), POLL_TIMEOUT_MS);
+    bool isSampledAgain = benchWaitForSignal(&poller, SIGNAL(sampled()), SKIPPED_POLL_SETTLE_MS);
+    server->setThrottle(0);
+
+    check(failedChecks, isSampled, "a slow poll produces a sample");
+    check(failedChecks, !isSampledAgain, "a poll asked for while one is out is skipped");
+    check(failedChecks, server->getRequestCount() - requestsBefore == 2,
+          "a skipped poll makes no requests of its own");
+
+    // a domain-server that doesn't report bandwidth
+    server->setFile(NODES_PATH, nodesJson(NODE_TYPES.size(), false));
+    if (pollOnce(poller)) {
+        checkLatestSample(failedChecks, poller, NODE_TYPES.size(), false);
+    } else {
+        check(failedChecks, false, "a poll without bandwidth produces a sample");
+    }
+
+    QJsonObject result;
+    result["polls"] = completedPolls;
+    result["poll_ms"] = benchSummary(pollTimes);
+    result["failed_checks"] = QJsonArray::fromStringList(failedChecks);
+    return result;
+}
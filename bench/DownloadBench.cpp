@@ -0,0 +1,259 @@
+//
+//  DownloadBench.cpp
+//  StackManagerQt/bench
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include <quazip.h>
+#include <quazipfile.h>
+#include <quazipnewinfo.h>
+
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QNetworkAccessManager>
+#include <QTimer>
+
+#include "BenchHttpServer.h"
+#include "Benchmarks.h"
+#include "Downloader.h"
+#include "GlobalData.h"
+#include "HttpClient.h"
+
+const int MEMORY_SAMPLE_INTERVAL_MS = 10;
+const int DOWNLOAD_TIMEOUT_MS = 5 * 60 * 1000;
+
+const QString DOWNLOAD_PATH = "/binaries/bench-download.bin";
+const QString THROTTLED_PATH = "/binaries/bench-throttled.bin";
+const QString ARCHIVE_PATH = "/binaries/bench-archive.zip";
+const QString ARCHIVE_DIRECTORY = "bench-archive/";
+
+// something between log output and binaries, so the deflater has real work to do
+static QByteArray benchBody(qint64 size, quint32 seed) {
+    QByteArray body(size, Qt::Uninitialized);
+    char* data = body.data();
+    quint32 state = seed;
+
+    for (qint64 i = 0; i < size; ++i) {
+        state = state * 1664525 + 1013904223;
+        data[i] = (state >> 24) < 64 ? char(state >> 16) : "[DEBUG] assignment-client\n"[i % 26];
+    }
+    return body;
+}
+
+struct DownloadRun {
+    DownloadRun() : isSuccess(false), downloadMSecs(-1), installMSecs(-1), peakMemoryBytes(0) {}
+
+    bool isSuccess;
+    qint64 downloadMSecs;
+    qint64 installMSecs;
+    qint64 peakMemoryBytes; // over what was resident when the download started
+    HttpHostMetrics metrics;
+};
+
+// drives one Downloader to the end, watching resident memory on the way
+class DownloadWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    DownloadWatcher(const QUrl& url, DownloadRun& run) : _url(url), _run(run), _baseline(0) {}
+
+    void exec() {
+        QNetworkAccessManager manager;
+        HttpClient httpClient(&manager);
+
+        Downloader downloader(_url);
+        connect(&downloader, &Downloader::downloadCompleted, this, &DownloadWatcher::handleCompleted);
+        connect(&downloader, &Downloader::installingFiles, this, &DownloadWatcher::handleInstalling);
+        connect(&downloader, &Downloader::downloadFailed, this, &DownloadWatcher::handleFailed);
+        connect(&downloader, &Downloader::filesInstallationFailed, this, &DownloadWatcher::handleFailed);
+        connect(&downloader, &Downloader::filesSuccessfullyInstalled, this, &DownloadWatcher::handleInstalled);
+
+        QTimer memoryTimer;
+        memoryTimer.setInterval(MEMORY_SAMPLE_INTERVAL_MS);
+        connect(&memoryTimer, &QTimer::timeout, this, &DownloadWatcher::sampleMemory);
+
+        _baseline = benchResidentBytes();
+        memoryTimer.start();
+        _clock.start();
+
+        downloader.start(&httpClient);
+        if (!benchWaitForSignal(this, SIGNAL(done()), DOWNLOAD_TIMEOUT_MS)) {
+            qWarning() << "Download of" << _url << "timed out.";
+        }
+
+        sampleMemory();
+
+        foreach(const HttpHostMetrics& metrics, httpClient.getMetrics()) {
+            _run.metrics.requests += metrics.requests;
+            _run.metrics.attempts += metrics.attempts;
+            _run.metrics.failures += metrics.failures;
+            _run.metrics.timeouts += metrics.timeouts;
+            _run.metrics.bytesReceived += metrics.bytesReceived;
+        }
+    }
+
+signals:
+    void done();
+
+private slots:
+    void handleCompleted() {
+        _run.downloadMSecs = _clock.elapsed();
+    }
+
+    void handleInstalling() {
+        _installClock.start();
+    }
+
+    void handleFailed() {
+        emit done();
+    }
+
+    void handleInstalled() {
+        _run.installMSecs = _installClock.elapsed();
+        _run.isSuccess = true;
+        emit done();
+    }
+
+    void sampleMemory() {
+        qint64 resident = benchResidentBytes();
+        if (resident >= 0 && _baseline >= 0) {
+            _run.peakMemoryBytes = qMax(_run.peakMemoryBytes, resident - _baseline);
+        }
+    }
+
+private:
+    QUrl _url;
+    DownloadRun& _run;
+    qint64 _baseline;
+    QElapsedTimer _clock;
+    QElapsedTimer _installClock;
+};
+
+static QJsonObject describeRun(const DownloadRun& run, qint64 bodyBytes) {
+    QJsonObject result;
+    result["success"] = run.isSuccess;
+    result["bytes"] = double(bodyBytes);
+    result["download_ms"] = double(run.downloadMSecs);
+    result["install_ms"] = double(run.installMSecs);
+    if (run.downloadMSecs > 0) {
+        result["mb_per_sec"] = bodyBytes / (1024.0 * 1024.0) / (run.downloadMSecs / 1000.0);
+    }
+    result["peak_memory_bytes"] = double(run.peakMemoryBytes);
+    result["requests"] = double(run.metrics.requests);
+    result["attempts"] = double(run.metrics.attempts);
+    result["failures"] = double(run.metrics.failures);
+    result["timeouts"] = double(run.metrics.timeouts);
+    return result;
+}
+
+static QJsonObject download(BenchServerThread& serverThread, const QString& path, qint64 bodyBytes) {
+    DownloadRun run;
+    DownloadWatcher watcher(serverThread.urlFor(path), run);
+    watcher.exec();
+
+    QFile::remove(GlobalData::getInstance().getClientsLaunchPath() + QFileInfo(path).fileName());
+
+    return describeRun(run, bodyBytes);
+}
+
+QJsonObject runDownloadBenchmark(const BenchOptions& options) {
+    BenchServerThread serverThread;
+    BenchHttpServer* server = serverThread.getServer();
+
+    qint64 downloadBytes = qint64(options.downloadMB) * 1024 * 1024;
+    qint64 throttleBytesPerSec = qint64(options.throttleKBps) * 1024;
+    qint64 throttledBytes = throttleBytesPerSec * 3; // a few seconds' worth
+
+    QJsonObject result;
+
+    server->setFile(DOWNLOAD_PATH, benchBody(downloadBytes, 1));
+    result["unthrottled"] = download(serverThread, DOWNLOAD_PATH, downloadBytes);
+
+    // a 503 and a connection cut halfway, both retried by the client
+    server->queueFaults(QList<BenchHttpServer::Fault>() << BenchHttpServer::FaultServerError
+                        << BenchHttpServer::FaultDropConnection);
+    result["faults"] = download(serverThread, DOWNLOAD_PATH, downloadBytes);
+    server->setFile(DOWNLOAD_PATH, QByteArray());
+
+    server->setFile(THROTTLED_PATH, benchBody(throttledBytes, 2));
+    server->setThrottle(throttleBytesPerSec);
+    QJsonObject throttled = download(serverThread, THROTTLED_PATH, throttledBytes);
+    throttled["throttle_bytes_per_sec"] = double(throttleBytesPerSec);
+    result["throttled"] = throttled;
+
+    return result;
+}
+
+static bool writeArchive(const QString& archivePath, const BenchOptions& options, qint64& extractedBytes) {
+    QuaZip zip(archivePath);
+    if (!zip.open(QuaZip::mdCreate)) {
+        return false;
+    }
+
+    QuaZipFile zipFile(&zip);
+
+    // extraction only creates directories it has an entry for
+    if (!zipFile.open(QIODevice::WriteOnly, QuaZipNewInfo(ARCHIVE_DIRECTORY))) {
+        return false;
+    }
+    zipFile.close();
+
+    extractedBytes = 0;
+    for (int i = 0; i < options.zipFiles; ++i) {
+        QByteArray body = benchBody(qint64(options.zipFileKB) * 1024, i + 3);
+
+        QString name = QString("%1file-%2.bin").arg(ARCHIVE_DIRECTORY).arg(i);
+        if (!zipFile.open(QIODevice::WriteOnly, QuaZipNewInfo(name))) {
+            return false;
+        }
+        zipFile.write(body);
+        zipFile.close();
+
+        extractedBytes += body.size();
+    }
+
+    zip.close();
+    return zip.getZipError() == 0;
+}
+
+QJsonObject runZipBenchmark(const BenchOptions& options) {
+    QJsonObject result;
+
+    QString archivePath = options.workPath + "/bench-archive.zip";
+    qint64 extractedBytes = 0;
+    if (!writeArchive(archivePath, options, extractedBytes)) {
+        result["error"] = QString("could not write the archive");
+        return result;
+    }
+
+    QFile archiveFile(archivePath);
+    archiveFile.open(QIODevice::ReadOnly);
+    QByteArray archive = archiveFile.readAll();
+    archiveFile.close();
+
+    BenchServerThread serverThread;
+    serverThread.getServer()->setFile(ARCHIVE_PATH, archive);
+
+    // the install step is the archive written to disk and every file in it extracted
+    DownloadRun run;
+    DownloadWatcher watcher(serverThread.urlFor(ARCHIVE_PATH), run);
+    watcher.exec();
+
+    QString launchPath = GlobalData::getInstance().getClientsLaunchPath();
+    QFile::remove(launchPath + QFileInfo(ARCHIVE_PATH).fileName());
+    QDir(launchPath + ARCHIVE_DIRECTORY).removeRecursively();
+
+    result = describeRun(run, archive.size());
+    result["files"] = options.zipFiles;
+    result["extracted_bytes"] = double(extractedBytes);
+    if (run.installMSecs > 0) {
+        result["extract_mb_per_sec"] = extractedBytes / (1024.0 * 1024.0) / (run.installMSecs / 1000.0);
+    }
+    return result;
+}
+
+#include "DownloadBench.moc"
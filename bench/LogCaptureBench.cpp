@@ -0,0 +1,118 @@
+//
+//  LogCaptureBench.cpp
+//  StackManagerQt/bench
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonArray>
+
+#include "BackgroundProcess.h"
+#include "Benchmarks.h"
+
+const int CAPTURE_SAMPLE_INTERVAL_MS = 10;
+
+// output the child wrote before it exited gets this long to show up
+const int CAPTURE_DRAIN_TIMEOUT_MS = 10 * 1000;
+
+static qint64 sentTimeOf(const QByteArray& message) {
+    int start = message.indexOf("sent=");
+    if (start < 0) {
+        return -1;
+    }
+    start += 5;
+
+    int end = message.indexOf(' ', start);
+    return message.mid(start, end < 0 ? -1 : end - start).toLongLong();
+}
+
+static QJsonObject runCapture(const BenchOptions& options, int stdoutRate) {
+    int stderrRate = qMax(1, stdoutRate / 10);
+    int expectedLines = (stdoutRate + stderrRate) * options.logSeconds;
+
+    BackgroundProcess process(benchToolPath("stack-manager-chatty-child"));
+    const LogStore& logStore = process.getLogStore();
+
+    QVector<double> latencies;
+    latencies.reserve(expectedLines);
+    int nextLine = 0;
+
+    QElapsedTimer clock;
+    clock.start();
+    qint64 startCpuMSecs = benchCpuMSecs();
+    qint64 exitedMSecs = -1;
+    qint64 lastLineMSecs = -1;
+
+    process.start(QStringList() << "--stdout-rate" << QString::number(stdoutRate)
+                  << "--stderr-rate" << QString::number(stderrRate)
+                  << "--line-bytes" << QString::number(options.logLineBytes)
+                  << "--seconds" << QString::number(options.logSeconds));
+
+    // the store is only looked at between captures, so arrival is known to within a sample
+    while (true) {
+        benchWait(CAPTURE_SAMPLE_INTERVAL_MS);
+        qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+        for (int line = qMax(nextLine, logStore.getFirstLine()); line < logStore.getEndLine(); ++line) {
+            qint64 sent = sentTimeOf(logStore.getMessage(line));
+            if (sent > 0) {
+                latencies << double(now - sent);
+                lastLineMSecs = clock.elapsed();
+            }
+        }
+        nextLine = logStore.getEndLine();
+
+        if (exitedMSecs < 0 && process.state() == QProcess::NotRunning) {
+            exitedMSecs = clock.elapsed();
+        }
+
+        if (latencies.size() >= expectedLines) {
+            break;
+        }
+
+        if (exitedMSecs >= 0 && clock.elapsed() - exitedMSecs > CAPTURE_DRAIN_TIMEOUT_MS) {
+            qWarning() << "Gave up waiting for" << expectedLines - latencies.size() << "lines of child output.";
+            break;
+        }
+    }
+
+    qint64 captureCpuMSecs = benchCpuMSecs() - startCpuMSecs;
+
+    if (process.state() != QProcess::NotRunning) {
+        process.stop();
+    }
+
+    QJsonObject result;
+    result["stdout_lines_per_sec"] = stdoutRate;
+    result["stderr_lines_per_sec"] = stderrRate;
+    result["seconds"] = options.logSeconds;
+    result["line_bytes"] = options.logLineBytes;
+    result["lines_expected"] = expectedLines;
+    result["lines_captured"] = latencies.size();
+    result["bytes_captured"] = double(logStore.getAppendedBytes());
+    result["captured_mb_per_sec"] = logStore.getAppendedBytes() / (1024.0 * 1024.0) / options.logSeconds;
+    result["store_memory_bytes"] = double(logStore.getMemoryUsage());
+    result["capture_cpu_ms"] = double(captureCpuMSecs);
+
+    // how far capture trails a child that has already gone
+    if (exitedMSecs >= 0 && lastLineMSecs >= 0) {
+        result["drain_after_exit_ms"] = double(qMax(qint64(0), lastLineMSecs - exitedMSecs));
+    }
+    result["latency_ms"] = benchSummary(latencies);
+    return result;
+}
+
+QJsonObject runLogCaptureBenchmark(const BenchOptions& options) {
+    QJsonArray runs;
+
+    foreach(int stdoutRate, options.logRates) {
+        runs.append(runCapture(options, stdoutRate));
+    }
+
+    QJsonObject result;
+    result["runs"] = runs;
+    return result;
+}
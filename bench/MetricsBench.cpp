@@ -0,0 +1,93 @@
+//
+//  MetricsBench.cpp
+//  StackManagerQt/bench
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include <QElapsedTimer>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QThread>
+
+#include "Benchmarks.h"
+#include "HttpClient.h"
+#include "MetricsExporter.h"
+#include "MetricsRegistry.h"
+
+const int RENDER_ITERATIONS = 1000;
+const int SCRAPE_TIMEOUT_MS = 10 * 1000;
+
+// series shaped like the collector's: one family per stat, one series per process
+const int SERIES_PER_PROCESS = 10;
+
+QJsonObject runMetricsBenchmark(const BenchOptions& options) {
+    MetricsRegistry& registry = MetricsRegistry::getInstance();
+
+    int processes = qMax(1, options.metricsSeries / SERIES_PER_PROCESS);
+    for (int process = 0; process < processes; ++process) {
+        QStringList labels = QStringList() << "process" << QString("Assignment Client %1").arg(process + 1);
+
+        for (int stat = 0; stat < SERIES_PER_PROCESS; ++stat) {
+            int series = registry.registerSeries(stat % 2 ? MetricsRegistry::Gauge : MetricsRegistry::Counter,
+                                                 QString("stack_manager_bench_stat_%1").arg(stat),
+                                                 "A stat standing in for the collector's.", labels,
+                                                 stat % 3 ? 1 : 1000);
+            registry.set(series, qint64(process) * 7919 + stat * 104729);
+        }
+    }
+
+    QByteArray body;
+    QVector<double> renderTimes;
+    for (int i = 0; i < RENDER_ITERATIONS; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        registry.render(body);
+        renderTimes << timer.nsecsElapsed() / 1000.0;
+    }
+
+    QThread exporterThread;
+    MetricsExporter* exporter = new MetricsExporter(registry, 0);
+    exporter->moveToThread(&exporterThread);
+    QObject::connect(&exporterThread, &QThread::finished, exporter, &QObject::deleteLater);
+    exporterThread.start();
+    QMetaObject::invokeMethod(exporter, "start", Qt::BlockingQueuedConnection);
+
+    QNetworkAccessManager manager;
+    HttpClient httpClient(&manager);
+    QNetworkRequest request(QUrl(QString("http://127.0.0.1:%1/metrics").arg(exporter->getPort())));
+
+    QVector<double> scrapeTimes;
+    int failedScrapes = 0;
+    qint64 scrapedBytes = 0;
+
+    for (int i = 0; i < options.metricsScrapes; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+
+        HttpRequest* scrape = httpClient.get(request, HttpRequestPolicy(SCRAPE_TIMEOUT_MS));
+        scrape->setAutoDelete(false);
+
+        if (benchWaitForSignal(scrape, SIGNAL(finished()), SCRAPE_TIMEOUT_MS) && scrape->isSuccess()) {
+            scrapeTimes << timer.nsecsElapsed() / 1000000.0;
+            scrapedBytes = scrape->getBody().size();
+        } else {
+            ++failedScrapes;
+        }
+
+        delete scrape;
+    }
+
+    exporterThread.quit();
+    exporterThread.wait();
+
+    QJsonObject result;
+    result["series"] = processes * SERIES_PER_PROCESS;
+    result["body_bytes"] = body.size();
+    result["render_us"] = benchSummary(renderTimes);
+    result["scrapes"] = options.metricsScrapes;
+    result["failed_scrapes"] = failedScrapes;
+    result["scraped_bytes"] = double(scrapedBytes);
+    result["scrape_ms"] = benchSummary(scrapeTimes);
+    return result;
+}
@@ -0,0 +1,215 @@
+//
+//  StackBench.cpp
+//  StackManagerQt/bench
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QProcess>
+
+#include "BackgroundProcess.h"
+#include "Benchmarks.h"
+#include "StackLauncher.h"
+#include "StackProfile.h"
+
+const int STACK_START_TIMEOUT_MS = 30 * 1000;
+const int STACK_SETTLE_MS = 500;
+const int STACK_POLL_INTERVAL_MS = 1;
+
+const int STARTUP_QUIT_TIMEOUT_MS = 30 * 1000;
+
+// the chatty child under the name a stack binary would have
+static QString linkChattyChild(const QString& path) {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile::remove(path);
+
+    if (!QFile::link(benchToolPath("stack-manager-chatty-child"), path)) {
+        // no links on this filesystem, a copy does as well
+        QFile::copy(benchToolPath("stack-manager-chatty-child"), path);
+    }
+    return path;
+}
+
+static LaunchStep chattyStep(const QString& name, const QString& binary, const QString& program) {
+    LaunchStep step;
+    step.name = name;
+    step.binary = binary;
+    step.program = program;
+    step.restartPolicy = RestartNever;
+    step.isLatencySensitive = false;
+    return step;
+}
+
+static bool isStackUp(const StackLauncher& launcher) {
+    foreach(BackgroundProcess* process, launcher.getProcesses()) {
+        if (process->state() != QProcess::Running) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QJsonObject runStackBenchmark(const BenchOptions& options) {
+    QString binPath = options.workPath + "/stack/";
+
+    // the default profile's shape: the domain-server, then the assignment-clients all at once
+    LaunchPlan plan;
+    plan.stages << (QList<LaunchStep>() << chattyStep("Domain Server", StackProfile::DOMAIN_SERVER_BINARY,
+                                                      linkChattyChild(binPath + "domain-server")));
+
+    // replicas of one binary, started in the same second, as a profile's assignment-clients are
+    QString assignmentClientPath = linkChattyChild(binPath + "assignment-client");
+    QList<LaunchStep> assignmentClients;
+    for (int i = 0; i < options.stackAssignmentClients; ++i) {
+        QString name = QString("assignment-client-%1").arg(i + 1);
+        assignmentClients << chattyStep(name, StackProfile::ASSIGNMENT_CLIENT_BINARY, assignmentClientPath);
+    }
+    plan.stages << assignmentClients;
+
+    StackLauncher launcher(plan);
+
+    QVector<double> startTimes;
+    QVector<double> stopTimes;
+    int failedStarts = 0;
+
+    for (int iteration = 0; iteration < options.stackIterations; ++iteration) {
+        QElapsedTimer clock;
+        clock.start();
+
+        launcher.start();
+        while (!isStackUp(launcher) && clock.elapsed() < STACK_START_TIMEOUT_MS) {
+            benchWait(STACK_POLL_INTERVAL_MS);
+        }
+
+        if (isStackUp(launcher)) {
+            startTimes << double(clock.nsecsElapsed()) / 1000000.0;
+        } else {
+            ++failedStarts;
+        }
+
+        benchWait(STACK_SETTLE_MS);
+
+        clock.restart();
+        launcher.stop();
+        stopTimes << double(clock.nsecsElapsed()) / 1000000.0;
+
+        // let the finished children be reported before the next round
+        benchWait(STACK_SETTLE_MS);
+    }
+
+    QJsonObject result;
+    result["processes"] = 1 + options.stackAssignmentClients;
+    result["iterations"] = options.stackIterations;
+    result["failed_starts"] = failedStarts;
+    result["start_ms"] = benchSummary(startTimes);
+    result["stop_ms"] = benchSummary(stopTimes);
+    return result;
+}
+
+// the first span of this name in a Chrome trace, as its end in milliseconds since process start
+static double traceEndMSecs(const QJsonArray& events, const QStringList& names, double* durationMSecs = NULL) {
+    foreach(const QJsonValue& value, events) {
+        QJsonObject event = value.toObject();
+        if (names.contains(event["name"].toString())) {
+            if (durationMSecs) {
+                *durationMSecs = event["dur"].toDouble() / 1000.0;
+            }
+            return (event["ts"].toDouble() + event["dur"].toDouble()) / 1000.0;
+        }
+    }
+    return -1;
+}
+
+QJsonObject runStartupBenchmark(const BenchOptions& options) {
+    QJsonObject result;
+
+    if (!QFileInfo(options.stackManagerPath).isExecutable()) {
+        result["skipped"] = QString("no Stack Manager binary at ") + options.stackManagerPath;
+        return result;
+    }
+
+    // a build directory, so no binaries are downloaded, with stand-ins the stack could be started from
+    QString startupPath = options.workPath + "/startup/";
+    linkChattyChild(startupPath + "build/domain-server/domain-server");
+    linkChattyChild(startupPath + "build/assignment-client/assignment-client");
+
+    // a home of its own keeps our logs, caches and settings away from the user's
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert("HOME", startupPath + "home");
+    environment.insert("XDG_DATA_HOME", startupPath + "home/data");
+    environment.insert("XDG_CONFIG_HOME", startupPath + "home/config");
+    environment.insert("XDG_CACHE_HOME", startupPath + "home/cache");
+    environment.insert("QT_QPA_PLATFORM", "offscreen");
+    environment.remove("HIFI_STACK_MANAGER_TRACE");
+
+    QVector<double> constructorTimes;
+    QVector<double> readyTimes;
+    QVector<double> windowTimes;
+    QVector<double> quitTimes;
+    int failedRuns = 0;
+
+    for (int run = 0; run < options.startupRuns; ++run) {
+        QString tracePath = QString("%1trace-%2.json").arg(startupPath).arg(run);
+
+        QProcess stackManager;
+        stackManager.setProcessEnvironment(environment);
+        stackManager.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        stackManager.setStandardOutputFile(QProcess::nullDevice());
+        stackManager.start(options.stackManagerPath, QStringList() << "--trace" << tracePath
+                           << "-b" << startupPath + "build");
+
+        if (!stackManager.waitForStarted()) {
+            ++failedRuns;
+            continue;
+        }
+
+        benchWait(options.startupSettleSecs * 1000);
+
+        // SIGTERM quits cleanly, which is when the trace is written
+        QElapsedTimer quitClock;
+        quitClock.start();
+        stackManager.terminate();
+        if (!stackManager.waitForFinished(STARTUP_QUIT_TIMEOUT_MS)) {
+            stackManager.kill();
+            stackManager.waitForFinished();
+            ++failedRuns;
+            continue;
+        }
+        quitTimes << double(quitClock.elapsed());
+
+        QFile traceFile(tracePath);
+        if (!traceFile.open(QIODevice::ReadOnly)) {
+            ++failedRuns;
+            continue;
+        }
+        QJsonArray events = QJsonDocument::fromJson(traceFile.readAll()).object()["traceEvents"].toArray();
+
+        double constructorMSecs = -1;
+        double readyMSecs = traceEndMSecs(events, QStringList() << "AppDelegate", &constructorMSecs);
+        if (readyMSecs >= 0) {
+            constructorTimes << constructorMSecs;
+            readyTimes << readyMSecs;
+        }
+
+        // whichever window came up first, the downloader or the main window
+        double windowMSecs = traceEndMSecs(events, QStringList() << "MainWindow::show" << "DownloadManager");
+        if (windowMSecs >= 0) {
+            windowTimes << windowMSecs;
+        }
+    }
+
+    result["runs"] = options.startupRuns;
+    result["failed_runs"] = failedRuns;
+    result["constructor_ms"] = benchSummary(constructorTimes);
+    result["constructed_since_exec_ms"] = benchSummary(readyTimes);
+    result["window_shown_since_exec_ms"] = benchSummary(windowTimes);
+    result["quit_ms"] = benchSummary(quitTimes);
+    return result;
+}
@@ -0,0 +1,370 @@
+//
+//  Spawner.cpp
+//  StackManagerQt/spawner
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+//  stack-manager-spawner launches and reaps the Stack Manager's children with posix_spawn, so
+//  the big GUI process never has to fork. It is deliberately Qt-free to stay small.
+//
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "SpawnerProtocol.h"
+
+extern char** environ;
+
+const int ORPHAN_GRACE_PERIOD_SECS = 5;
+const size_t READ_CHUNK_BYTES = 64 * 1024;
+
+static int childSignalPipe[2] = { -1, -1 };
+static int originalDirectory = -1;
+
+// live children, by pid, with the id the manager knows them by
+static std::map<pid_t, std::string> children;
+
+static void handleChildSignal(int) {
+    int savedErrno = errno;
+    char wakeUp = 0;
+    if (write(childSignalPipe[1], &wakeUp, 1) < 0) {
+        // the pipe is full, so the main loop is already going to wake up
+    }
+    errno = savedErrno;
+}
+
+static void setCloseOnExec(int fd) {
+    fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) | FD_CLOEXEC);
+}
+
+static std::string numberString(long long value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%lld", value);
+    return buffer;
+}
+
+static bool writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        length -= written;
+    }
+    return true;
+}
+
+static bool sendMessage(int socketFD, const std::vector<std::string>& fields) {
+    std::string payload;
+    for (size_t i = 0; i < fields.size(); ++i) {
+        payload += fields[i];
+        payload += '\0';
+    }
+
+    uint32_t length = payload.size();
+    return writeAll(socketFD, reinterpret_cast<const char*>(&length), sizeof(length))
+        && writeAll(socketFD, payload.data(), payload.size());
+}
+
+static void sendFailure(int socketFD, const std::string& id, const std::string& reason) {
+    std::vector<std::string> fields;
+    fields.push_back(FAILED_MESSAGE);
+    fields.push_back(id);
+    fields.push_back(reason);
+    sendMessage(socketFD, fields);
+}
+
+static void spawnChild(int socketFD, const std::vector<std::string>& fields) {
+    const size_t FIRST_ARGUMENT_FIELD = 7;
+
+    if (fields.size() < FIRST_ARGUMENT_FIELD) {
+        sendFailure(socketFD, fields.size() > 1 ? fields[1] : std::string(), "malformed spawn request");
+        return;
+    }
+
+    const std::string& id = fields[1];
+    const std::string& program = fields[2];
+    const std::string& workingDirectory = fields[3];
+    size_t argumentCount = strtoul(fields[6].c_str(), NULL, 10);
+
+    if (fields.size() < FIRST_ARGUMENT_FIELD + argumentCount) {
+        sendFailure(socketFD, id, "malformed spawn request");
+        return;
+    }
+
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(program.c_str()));
+    for (size_t i = 0; i < argumentCount; ++i) {
+        argv.push_back(const_cast<char*>(fields[FIRST_ARGUMENT_FIELD + i].c_str()));
+    }
+    argv.push_back(NULL);
+
+    std::vector<char*> envp;
+    for (size_t i = FIRST_ARGUMENT_FIELD + argumentCount; i < fields.size(); ++i) {
+        envp.push_back(const_cast<char*>(fields[i].c_str()));
+    }
+    bool inheritsEnvironment = envp.empty();
+    envp.push_back(NULL);
+
+    posix_spawn_file_actions_t fileActions;
+    posix_spawn_file_actions_init(&fileActions);
+    posix_spawn_file_actions_addopen(&fileActions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    // append mode so the manager can truncate the files under the child when it rotates them
+    posix_spawn_file_actions_addopen(&fileActions, STDOUT_FILENO, fields[4].c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    posix_spawn_file_actions_addopen(&fileActions, STDERR_FILENO, fields[5].c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+
+    // we ignore SIGPIPE, which exec would otherwise hand down
+    sigset_t noSignals;
+    sigemptyset(&noSignals);
+    sigset_t defaultSignals;
+    sigemptyset(&defaultSignals);
+    sigaddset(&defaultSignals, SIGPIPE);
+    sigaddset(&defaultSignals, SIGCHLD);
+
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    posix_spawnattr_setsigmask(&attributes, &noSignals);
+    posix_spawnattr_setsigdefault(&attributes, &defaultSignals);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    // single threaded, so moving our own working directory around the spawn is safe
+    pid_t pid = 0;
+    int result = 0;
+    if (!workingDirectory.empty() && chdir(workingDirectory.c_str()) != 0) {
+        result = errno;
+    } else {
+        result = posix_spawn(&pid, program.c_str(), &fileActions, &attributes, &argv[0],
+                             inheritsEnvironment ? environ : &envp[0]);
+    }
+
+    if (!workingDirectory.empty() && fchdir(originalDirectory) != 0) {
+        perror("stack-manager-spawner: could not return to its working directory");
+    }
+
+    posix_spawnattr_destroy(&attributes);
+    posix_spawn_file_actions_destroy(&fileActions);
+
+    if (result != 0) {
+        sendFailure(socketFD, id, strerror(result));
+        return;
+    }
+
+    children[pid] = id;
+
+    std::vector<std::string> reply;
+    reply.push_back(SPAWNED_MESSAGE);
+    reply.push_back(id);
+    reply.push_back(numberString(pid));
+    sendMessage(socketFD, reply);
+}
+
+static void signalChild(const std::vector<std::string>& fields) {
+    if (fields.size() < 3) {
+        return;
+    }
+
+    int signalNumber = fields[2] == KILL_SIGNAL_NAME ? SIGKILL : SIGTERM;
+
+    std::map<pid_t, std::string>::const_iterator it = children.begin();
+    for (; it != children.end(); ++it) {
+        if (it->second == fields[1]) {
+            kill(it->first, signalNumber);
+            return;
+        }
+    }
+}
+
+static void reapChildren(int socketFD) {
+    int status = 0;
+    pid_t pid = 0;
+
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        std::map<pid_t, std::string>::iterator it = children.find(pid);
+        if (it == children.end()) {
+            continue;
+        }
+
+        bool wasSignaled = WIFSIGNALED(status);
+
+        std::vector<std::string> fields;
+        fields.push_back(EXITED_MESSAGE);
+        fields.push_back(it->second);
+        fields.push_back(numberString(wasSignaled ? WTERMSIG(status) : WEXITSTATUS(status)));
+        fields.push_back(wasSignaled ? "1" : "0");
+        sendMessage(socketFD, fields);
+
+        children.erase(it);
+    }
+}
+
+// false on a message we can't make sense of, after which the stream can't be trusted
+static bool handleMessages(int socketFD, std::string& buffer) {
+    size_t consumed = 0;
+
+    while (buffer.size() - consumed >= sizeof(uint32_t)) {
+        uint32_t length = 0;
+        memcpy(&length, buffer.data() + consumed, sizeof(length));
+
+        if (length > MAX_SPAWNER_MESSAGE_BYTES) {
+            fprintf(stderr, "stack-manager-spawner: %u byte message is too large\n", length);
+            return false;
+        }
+
+        if (buffer.size() - consumed - sizeof(length) < length) {
+            break;
+        }
+
+        std::vector<std::string> fields;
+        const char* field = buffer.data() + consumed + sizeof(length);
+        const char* end = field + length;
+        while (field < end) {
+            const char* fieldEnd = static_cast<const char*>(memchr(field, '\0', end - field));
+            if (!fieldEnd) {
+                fieldEnd = end;
+            }
+            fields.push_back(std::string(field, fieldEnd - field));
+            field = fieldEnd + 1;
+        }
+
+        consumed += sizeof(length) + length;
+
+        if (fields.empty()) {
+            continue;
+        } else if (fields[0] == SPAWN_MESSAGE) {
+            spawnChild(socketFD, fields);
+        } else if (fields[0] == SIGNAL_MESSAGE) {
+            signalChild(fields);
+        } else {
+            fprintf(stderr, "stack-manager-spawner: unknown message %s\n", fields[0].c_str());
+        }
+    }
+
+    buffer.erase(0, consumed);
+    return true;
+}
+
+static void stopOrphanedChildren() {
+    // the manager is gone, don't leave its stack running unattended
+    std::map<pid_t, std::string>::const_iterator it = children.begin();
+    for (; it != children.end(); ++it) {
+        kill(it->first, SIGTERM);
+    }
+
+    for (int second = 0; second < ORPHAN_GRACE_PERIOD_SECS && !children.empty(); ++second) {
+        sleep(1);
+
+        pid_t pid = 0;
+        while ((pid = waitpid(-1, NULL, WNOHANG)) > 0) {
+            children.erase(pid);
+        }
+    }
+
+    for (it = children.begin(); it != children.end(); ++it) {
+        kill(it->first, SIGKILL);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <socket path>\n", argv[0]);
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    originalDirectory = open(".", O_RDONLY);
+    setCloseOnExec(originalDirectory);
+
+    if (pipe(childSignalPipe) != 0) {
+        perror("stack-manager-spawner: pipe");
+        return 1;
+    }
+    for (int i = 0; i < 2; ++i) {
+        setCloseOnExec(childSignalPipe[i]);
+        fcntl(childSignalPipe[i], F_SETFL, fcntl(childSignalPipe[i], F_GETFL) | O_NONBLOCK);
+    }
+
+    struct sigaction childAction;
+    memset(&childAction, 0, sizeof(childAction));
+    childAction.sa_handler = handleChildSignal;
+    childAction.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    sigaction(SIGCHLD, &childAction, NULL);
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(argv[1]) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "stack-manager-spawner: socket path %s is too long\n", argv[1]);
+        return 1;
+    }
+    strncpy(address.sun_path, argv[1], sizeof(address.sun_path) - 1);
+
+    int socketFD = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socketFD < 0 || connect(socketFD, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) {
+        perror("stack-manager-spawner: connect");
+        return 1;
+    }
+    setCloseOnExec(socketFD);
+
+    std::string buffer;
+    std::vector<char> chunk(READ_CHUNK_BYTES);
+
+    struct pollfd pollFDs[2];
+    pollFDs[0].fd = socketFD;
+    pollFDs[0].events = POLLIN;
+    pollFDs[1].fd = childSignalPipe[0];
+    pollFDs[1].events = POLLIN;
+
+    for (;;) {
+        if (poll(pollFDs, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("stack-manager-spawner: poll");
+            break;
+        }
+
+        if (pollFDs[1].revents & POLLIN) {
+            while (read(childSignalPipe[0], &chunk[0], chunk.size()) > 0) {
+            }
+            reapChildren(socketFD);
+        }
+
+        if (pollFDs[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            ssize_t bytesRead = read(socketFD, &chunk[0], chunk.size());
+            if (bytesRead < 0 && errno == EINTR) {
+                continue;
+            }
+            if (bytesRead <= 0) {
+                break;
+            }
+
+            buffer.append(&chunk[0], bytesRead);
+            if (!handleMessages(socketFD, buffer)) {
+                break;
+            }
+        }
+    }
+
+    stopOrphanedChildren();
+    return 0;
+}
@@ -0,0 +1,34 @@
+//
+//  SpawnerProtocol.h
+//  StackManagerQt/spawner
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_SpawnerProtocol_h
+#define hifi_SpawnerProtocol_h
+
+// Messages between the Stack Manager and stack-manager-spawner over a local socket. Each one is
+// a native-endian 32-bit payload length followed by the payload, a run of NUL-terminated
+// fields the first of which names the message.
+//
+//  manager to spawner:  spawn <id> <program> <working dir> <stdout file> <stderr file> <argc> <args...> <env...>
+//                       signal <id> TERM|KILL
+//  spawner to manager:  spawned <id> <pid>
+//                       failed <id> <reason>
+//                       exited <id> <exit code, or signal number> <1 when killed by a signal>
+//
+// An empty working dir keeps the spawner's, and no env entries inherit the spawner's environment.
+
+const char SPAWN_MESSAGE[] = "spawn";
+const char SIGNAL_MESSAGE[] = "signal";
+const char SPAWNED_MESSAGE[] = "spawned";
+const char FAILED_MESSAGE[] = "failed";
+const char EXITED_MESSAGE[] = "exited";
+
+const char TERMINATE_SIGNAL_NAME[] = "TERM";
+const char KILL_SIGNAL_NAME[] = "KILL";
+
+const unsigned int MAX_SPAWNER_MESSAGE_BYTES = 1024 * 1024;
+
+#endif
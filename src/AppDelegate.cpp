@@ -7,11 +7,33 @@
 //
 
 #include <csignal>
+#include <cstdio>
 
 #include "AppDelegate.h"
+#include "AsyncLogWriter.h"
 #include "BackgroundProcess.h"
 #include "GlobalData.h"
+#include "DomainNameCache.h"
+#include "DomainSettingsSync.h"
+#include "DomainStatsPoller.h"
 #include "DownloadManager.h"
+#include "HttpClient.h"
+#include "LocalServiceDiscovery.h"
+#include "LogIndexService.h"
+#include "LogMetrics.h"
+#include "LogTimeline.h"
+#include "LogUpdateScheduler.h"
+#include "MetricsCollector.h"
+#include "MetricsExporter.h"
+#include "MetricsRegistry.h"
+#include "ProcessPlacement.h"
+#include "ProcessSpawner.h"
+#include "StackInstance.h"
+#include "StackLauncher.h"
+#include "StackProfile.h"
+#include "Tracer.h"
+#include "UpdateService.h"
+#include "WarmAssignmentPool.h"
 
 #include <QDateTime>
 #include <QDebug>
@@ -22,8 +44,8 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QEventLoop>
 #include <QMessageBox>
-#include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QUrlQuery>
 #include <QUuid>
@@ -39,7 +61,18 @@ const QByteArray HIGH_FIDELITY_USER_AGENT = "Mozilla/5.0 (HighFidelity)";
 
 const int VERSION_CHECK_INTERVAL_MS = 86400000; // a day
 
-const int WAIT_FOR_CHILD_MSECS = 5000;
+// the local domain-server is often still coming up when it is first asked something
+const HttpRequestPolicy DOMAIN_SERVER_REQUEST_POLICY(5 * 1000, 3);
+const HttpRequestPolicy REMOTE_REQUEST_POLICY(15 * 1000, 3);
+// startup waits on the MD5 checks in turn, and a failed one only means the files are fetched again
+const HttpRequestPolicy STARTUP_MD5_REQUEST_POLICY(5 * 1000);
+const int CONTENT_SET_STALL_TIMEOUT_MS = 30 * 1000;
+
+const QStringList INDEX_PATH_KEY_PATH = QStringList() << "paths" << "/" << "viewpoint";
+
+const int MAX_STACK_COUNT = 16;
+
+const char TRACE_ENVIRONMENT_VARIABLE[] = "HIFI_STACK_MANAGER_TRACE";
 
 void signalHandler(int param) {
     AppDelegate* app = AppDelegate::getInstance();
@@ -47,35 +80,45 @@ void signalHandler(int param) {
     app->quit();
 }
 
-static QTextStream* outStream = NULL;
+static AsyncLogWriter* logWriter = NULL;
+
+// set up before the crash handler is installed, the handler itself may only write(2) them
+static const char CRASH_NOTE[] = "Stack Manager crashed, the lines above were still queued and have no timestamps.\n";
+static int crashLogDescriptor = -1;
+static int crashStderrDescriptor = -1;
+
+void crashSignalHandler(int param) {
+    // flush() locks and allocates, neither is safe here, so the queue is walked and written as it stands
+    if (logWriter && crashLogDescriptor >= 0) {
+        logWriter->writePendingForCrash(crashLogDescriptor);
+        AsyncLogWriter::writeForCrash(crashLogDescriptor, CRASH_NOTE, sizeof(CRASH_NOTE) - 1);
+    }
+    if (crashStderrDescriptor >= 0) {
+        AsyncLogWriter::writeForCrash(crashStderrDescriptor, CRASH_NOTE, sizeof(CRASH_NOTE) - 1);
+    }
+
+    signal(param, SIG_DFL);
+    raise(param);
+}
 
 void myMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg) {
     Q_UNUSED(context);
 
-    QString dateTime = QDateTime::currentDateTime().toString("dd/MM/yyyy hh:mm:ss");
-    QString txt = QString("[%1] ").arg(dateTime);
+    if (!logWriter) {
+        fprintf(stdout, "%s\n", qPrintable(msg));
+        return;
+    }
 
-    //in this function, you can write the message to any stream!
-    switch (type) {
-        case QtDebugMsg:
-            fprintf(stdout, "Debug: %s\n", qPrintable(msg));
-            txt += msg;
-            break;
-        case QtWarningMsg:
-            fprintf(stdout, "Warning: %s\n", qPrintable(msg));
-            txt += msg;
-            break;
-        case QtCriticalMsg:
-            fprintf(stdout, "Critical: %s\n", qPrintable(msg));
-            txt += msg;
-            break;
-        case QtFatalMsg:
-            fprintf(stdout, "Fatal: %s\n", qPrintable(msg));
-            txt += msg;
+    // filter before anything is copied or formatted
+    if (!logWriter->accepts(type)) {
+        return;
     }
 
-    if (outStream) {
-        *outStream << txt << endl;
+    logWriter->enqueue(type, msg);
+
+    if (type == QtFatalMsg) {
+        // Qt aborts right after a fatal message
+        logWriter->flush();
     }
 }
 
@@ -85,37 +128,238 @@ AppDelegate::AppDelegate(int argc, char* argv[]) :
     _dsReady(false),
     _dsResourcesReady(false),
     _acReady(false),
+    _profilePath(StackProfile::DEFAULT_PROFILE_PATH),
+    _automaticPlacement(false),
+    _stackLauncher(NULL),
     _domainServerProcess(NULL),
-    _acMonitorProcess(NULL),
-    _domainServerName("localhost")
+    _nextScriptNumber(1),
+    _warmAssignmentPool(NULL),
+    _stackCount(1),
+    _domainServerName("localhost"),
+    _domainNameCache(NULL),
+    _minimumLogLevel(QtDebugMsg),
+    _updateService(NULL),
+    _logLifecycleManager(NULL),
+    _logTimeline(NULL),
+    _logUpdateScheduler(NULL),
+    _useProcessSpawner(true),
+    _processSpawner(NULL),
+    _domainStatsPoller(NULL),
+    _statsIntervalSecs(0),
+    _logMetrics(NULL),
+    _logIndexThread(NULL),
+    _logIndexService(NULL),
+    _serviceDiscoveryThread(NULL),
+    _localServiceDiscovery(NULL),
+    _metricsPort(0),
+    _metricsCollector(NULL),
+    _metricsThread(NULL),
+    _metricsExporter(NULL)
 {
+    TraceSpan constructorSpan("startup", "AppDelegate");
+
     // be a signal handler for SIGTERM so we can stop child processes if we get it
     signal(SIGTERM, signalHandler);
 
-    // look for command-line options
-    parseCommandLine();
-
+    // set these first, GlobalData derives its data paths from them
     setApplicationName("Stack Manager");
     setOrganizationName("High Fidelity");
     setOrganizationDomain("io.highfidelity.StackManager");
 
-    QFile* logFile = new QFile("last_run_log", this);
-    if (!logFile->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    // look for command-line options
+    parseCommandLine();
+
+    // startup has been recorded so far in case a trace was asked for
+    Tracer::setEnabled(!_tracePath.isEmpty());
+
+    logWriter = new AsyncLogWriter("last_run_log");
+    if (!logWriter->isFileOpen()) {
         qDebug() << "Failed to open log file. Will not be able to write STDOUT/STDERR to file.";
-    } else {
-        outStream = new QTextStream(logFile);
     }
-
+    logWriter->setMinimumLevel(_minimumLogLevel);
+    logWriter->start(QThread::LowPriority);
 
     qInstallMessageHandler(myMessageHandler);
-    _domainServerProcess = new BackgroundProcess(GlobalData::getInstance().getDomainServerExecutablePath(), this);
-    _acMonitorProcess = new BackgroundProcess(GlobalData::getInstance().getAssignmentClientExecutablePath(), this);
+    crashLogDescriptor = logWriter->getFileDescriptor();
+    crashStderrDescriptor = fileno(stderr);
+    signal(SIGSEGV, crashSignalHandler);
+    signal(SIGABRT, crashSignalHandler);
+
+    // children are launched from a small helper, started while we are still small ourselves
+    if (_useProcessSpawner) {
+        _processSpawner = new ProcessSpawner(this);
+        _processSpawner->start(ProcessSpawner::defaultHelperPath());
+    }
+
+    // the last known name is right far more often than "localhost", /id and the API confirm it later
+    _domainNameCache = new DomainNameCache(GlobalData::getInstance().getDomainNameCachePath());
+    QString cachedDomainName;
+    if (_domainNameCache->lookup(_domainNameCache->getLastDomainID(), cachedDomainName) != DomainNameCache::Missing) {
+        _domainServerName = cachedDomainName;
+    }
+
+    // created before any child starts so every output file gets registered for rotation
+    _logLifecycleManager = new LogLifecycleManager(GlobalData::getInstance().getProcessLogsPath(),
+                                                   _logLifecyclePolicy, this);
+
+    // child output reaches the log viewers through here, at most once per frame
+    _logUpdateScheduler = new LogUpdateScheduler(this);
+
+    // the primary stack's topology comes from a profile, the built-in one matches what we always ran
+    LaunchPlan launchPlan;
+    if (!loadLaunchPlan(_profilePath, launchPlan)) {
+        loadLaunchPlan(StackProfile::DEFAULT_PROFILE_PATH, launchPlan);
+    }
+
+    if (_automaticPlacement || launchPlan.automaticPlacement) {
+        // with several stacks only the primary stack's share of the host is ours to hand out
+        QVector<int> availableCpus = StackInstance::cpuSetForStack(0, _stackCount);
+        if (availableCpus.isEmpty()) {
+            for (int cpu = 0; cpu < QThread::idealThreadCount(); ++cpu) {
+                availableCpus << cpu;
+            }
+        }
+        _scriptedCpuSet = ProcessPlacement::placeAutomatically(launchPlan, availableCpus);
+    }
+
+    // scripted assignment-clients stay off the mixers' cores, and inside the primary stack's share
+    if (_scriptedCpuSet.isEmpty()) {
+        _scriptedCpuSet = StackInstance::cpuSetForStack(0, _stackCount);
+    }
+    if (_warmAssignmentPool) {
+        _warmAssignmentPool->setCpuSet(_scriptedCpuSet);
+    }
+
+    _stackLauncher = new StackLauncher(launchPlan, this);
+    _domainServerProcess = _stackLauncher->getFirstProcess(StackProfile::DOMAIN_SERVER_BINARY);
+
+    _logTimeline = new LogTimeline(this);
+    _logMetrics = new LogMetrics(this);
+    if (!_metricsConfigPath.isEmpty()) {
+        _logMetrics->loadConfiguration(_metricsConfigPath);
+    }
+
+    foreach(BackgroundProcess* process, _stackLauncher->getProcesses()) {
+        _logTimeline->addSource(_stackLauncher->getName(process), &process->getLogStore());
+        _logMetrics->addSource(_stackLauncher->getName(process), &process->getLogStore());
+        connect(process, SIGNAL(stateChanged(QProcess::ProcessState)),
+                SLOT(handleStackProcessStateChanged(QProcess::ProcessState)));
+    }
+
+    // the primary stack above keeps the default ports and directories, any others get their own
+    if (_stackCount > 1) {
+        foreach(BackgroundProcess* process, _stackLauncher->getProcesses()) {
+            // a CPU set from the profile wins over the stack's share
+            if (process->getCpuSet().isEmpty()) {
+                process->setCpuSet(StackInstance::cpuSetForStack(0, _stackCount));
+            }
+            connect(process, SIGNAL(stateChanged(QProcess::ProcessState)), this, SIGNAL(stacksChanged()));
+        }
+
+        for (int index = 1; index < _stackCount; ++index) {
+            StackInstance* stack = new StackInstance(index, _stackCount, this);
+            _extraStacks << stack;
+
+            _logTimeline->addSource(stack->getName() + " Domain Server", &stack->getDomainServerProcess()->getLogStore());
+            _logTimeline->addSource(stack->getName() + " Assignment Clients",
+                                    &stack->getAssignmentClientMonitorProcess()->getLogStore());
+            _logMetrics->addSource(stack->getName() + " Domain Server", &stack->getDomainServerProcess()->getLogStore());
+            _logMetrics->addSource(stack->getName() + " Assignment Clients",
+                                   &stack->getAssignmentClientMonitorProcess()->getLogStore());
+
+            connect(stack, &StackInstance::stateChanged, this, &AppDelegate::stacksChanged);
+        }
+    }
+    connect(_logMetrics, &LogMetrics::thresholdCrossed, this, &AppDelegate::processAlert);
+    connect(_logMetrics, &LogMetrics::alertStateChanged, this, &AppDelegate::handleLogAlertStateChanged);
 
     _manager = new QNetworkAccessManager(this);
+    _httpClient = new HttpClient(_manager, this);
+
+    _domainSettingsSync = new DomainSettingsSync(_httpClient, this);
+    connect(_domainSettingsSync, &DomainSettingsSync::valueSynced, this, &AppDelegate::handleSettingSynced);
+
+    // whatever started it, a restart policy, an update or the user, a new domain-server may not
+    // hold the settings we last saw
+    if (_domainServerProcess) {
+        connect(_domainServerProcess, SIGNAL(started()), _domainSettingsSync, SLOT(invalidate()));
+    }
+
+    _domainStatsPoller = new DomainStatsPoller(_httpClient, this);
+    _domainStatsPoller->setBaseUrl(_statsBaseUrl);
+    if (_statsIntervalSecs > 0) {
+        _domainStatsPoller->setInterval(_statsIntervalSecs * 1000);
+    }
+
+    // indexing child output can take a while for big logs, keep it off the GUI thread
+    _logIndexThread = new QThread(this);
+    _logIndexService = new LogIndexService(GlobalData::getInstance().getProcessLogsPath());
+    _logIndexService->moveToThread(_logIndexThread);
+    connect(_logIndexThread, &QThread::started, _logIndexService, &LogIndexService::start);
+    connect(_logIndexThread, &QThread::finished, _logIndexService, &QObject::deleteLater);
+
+    // configured log counters are regexes over every captured line, they run alongside the index
+    _logMetrics->setCounterThread(_logIndexThread);
+    _logIndexThread->start(QThread::LowPriority);
+
+    // reading a shared-memory segment can wait on its lock, so discovery gets a thread as well
+    _serviceDiscoveryThread = new QThread(this);
+    _localServiceDiscovery = new LocalServiceDiscovery();
+    _localServiceDiscovery->addService(DOMAIN_SERVER_LOCAL_PORT_KEY, StackProfile::DOMAIN_SERVER_BINARY);
+    _localServiceDiscovery->addService(DOMAIN_SERVER_LOCAL_HTTP_PORT_KEY, StackProfile::DOMAIN_SERVER_BINARY);
+    _localServiceDiscovery->addService(DOMAIN_SERVER_LOCAL_HTTPS_PORT_KEY, StackProfile::DOMAIN_SERVER_BINARY);
+    _localServiceDiscovery->addService(ASSIGNMENT_CLIENT_MONITOR_LOCAL_PORT_KEY, StackProfile::ASSIGNMENT_CLIENT_BINARY);
+    _localServiceDiscovery->moveToThread(_serviceDiscoveryThread);
+    connect(_serviceDiscoveryThread, &QThread::started, _localServiceDiscovery, &LocalServiceDiscovery::start);
+    connect(_serviceDiscoveryThread, &QThread::finished, _localServiceDiscovery, &QObject::deleteLater);
+    connect(_localServiceDiscovery, &LocalServiceDiscovery::portChanged, this, &AppDelegate::handleLocalServicePortChanged);
+    _serviceDiscoveryThread->start(QThread::LowPriority);
+
+    if (_metricsPort > 0) {
+        MetricsRegistry& registry = MetricsRegistry::getInstance();
+
+        _metricsCollector = new MetricsCollector(registry, this);
+        foreach(BackgroundProcess* process, _stackLauncher->getProcesses()) {
+            _metricsCollector->addProcess(_stackLauncher->getName(process), process, _stackLauncher);
+        }
+        foreach(StackInstance* stack, _extraStacks) {
+            _metricsCollector->addProcess(stack->getName() + " Domain Server", stack->getDomainServerProcess());
+            _metricsCollector->addProcess(stack->getName() + " Assignment Clients",
+                                          stack->getAssignmentClientMonitorProcess());
+        }
+        _metricsCollector->setLogMetrics(_logMetrics);
+        _metricsCollector->setHttpClient(_httpClient);
+
+        // scrapes are answered from the registry on a thread of their own
+        _metricsThread = new QThread(this);
+        _metricsExporter = new MetricsExporter(registry, _metricsPort);
+        _metricsExporter->moveToThread(_metricsThread);
+        connect(_metricsThread, &QThread::started, _metricsExporter, &MetricsExporter::start);
+        connect(_metricsThread, &QThread::finished, _metricsExporter, &QObject::deleteLater);
+        _metricsThread->start(QThread::LowPriority);
+    }
 
     _window = new MainWindow();
 
     createExecutablePath();
+
+    // if the user has set hifiBuildDirectory they manage their own binaries
+    if (!GlobalData::getInstance().isGetHifiBuildDirectorySet()) {
+        _updateService = new UpdateService(_httpClient, this);
+
+        // an update staged by a previous run can go live now since nothing is running yet
+        if (_updateService->hasStagedUpdate()) {
+            _updateService->activateStagedUpdate();
+        }
+
+        connect(_updateService, &UpdateService::updateStaged, this, &AppDelegate::handleUpdateStaged);
+        connect(_updateService, &UpdateService::activationDue, this, &AppDelegate::applyStagedUpdate);
+
+        if (_scheduledUpdateTime.isValid()) {
+            _updateService->setScheduledActivationTime(_scheduledUpdateTime);
+        }
+    }
+
     downloadLatestExecutablesAndRequirements();
 
     _checkVersionTimer.setInterval(0);
@@ -126,6 +370,10 @@ AppDelegate::AppDelegate(int argc, char* argv[]) :
 }
 
 AppDelegate::~AppDelegate() {
+    if (_warmAssignmentPool) {
+        _warmAssignmentPool->stop();
+    }
+
     QHash<QUuid, BackgroundProcess*>::iterator it = _scriptProcesses.begin();
 
     qDebug() << "Stopping scripted assignment-client processes prior to quit.";
@@ -136,29 +384,49 @@ AppDelegate::~AppDelegate() {
         it = _scriptProcesses.erase(it);
 
         // make sure the process is dead
-        backgroundProcess->terminate();
-        backgroundProcess->waitForFinished();
+        backgroundProcess->stop();
         backgroundProcess->deleteLater();
     }
 
-    qDebug() << "Stopping domain-server process prior to quit.";
-    _domainServerProcess->terminate();
-    _domainServerProcess->waitForFinished();
+    delete _domainNameCache;
+
+    qDebug() << "Stopping stack processes prior to quit.";
+    _stackLauncher->stop();
 
-    qDebug() << "Stopping assignment-client process prior to quit.";
-    _acMonitorProcess->terminate();
-    _acMonitorProcess->waitForFinished();
+    foreach(StackInstance* stack, _extraStacks) {
+        qDebug() << "Stopping" << stack->getName() << "prior to quit.";
+        stack->stop();
+    }
 
-    _domainServerProcess->deleteLater();
-    _acMonitorProcess->deleteLater();
+    _stackLauncher->deleteLater();
 
     _window->deleteLater();
 
-    delete outStream;
-    outStream = NULL;
+    _logIndexThread->quit();
+    _logIndexThread->wait();
+
+    _serviceDiscoveryThread->quit();
+    _serviceDiscoveryThread->wait();
+
+    if (_metricsThread) {
+        _metricsThread->quit();
+        _metricsThread->wait();
+    }
+
+    // stops the writer thread and drains anything still queued
+    qInstallMessageHandler(0);
+    delete logWriter;
+    logWriter = NULL;
+
+    // only once the writer thread has stopped recording into the ring
+    if (!_tracePath.isEmpty()) {
+        Tracer::writeChromeTrace(_tracePath);
+    }
 }
 
 void AppDelegate::parseCommandLine() {
+    TraceSpan span("startup", "parseCommandLine");
+
     QCommandLineParser parser;
     parser.setApplicationDescription("High Fidelity Stack Manager");
     parser.addHelpOption();
@@ -168,6 +436,55 @@ void AppDelegate::parseCommandLine() {
     const QCommandLineOption hifiBuildDirectoryOption("b", "Path to build of hifi", "build-directory");
     parser.addOption(hifiBuildDirectoryOption);
 
+    const QCommandLineOption updateTimeOption("update-at", "Daily time to activate staged updates", "hh:mm");
+    parser.addOption(updateTimeOption);
+
+    const QCommandLineOption logLevelOption("log-level", "Lowest level written to last_run_log", "debug|info|warning|critical");
+    parser.addOption(logLevelOption);
+
+    const QCommandLineOption metricsConfigOption("metrics-config", "Log counters and alert thresholds", "json-file");
+    parser.addOption(metricsConfigOption);
+
+    const QCommandLineOption profileOption("profile", "Stack profile describing the processes to run", "json-file");
+    parser.addOption(profileOption);
+
+    const QCommandLineOption autoPlacementOption("auto-placement", "Give each mixer a CPU core of its own");
+    parser.addOption(autoPlacementOption);
+
+    const QCommandLineOption cgroupOption("cgroup", "Delegated cgroup v2 directory for CPU and memory caps", "path");
+    parser.addOption(cgroupOption);
+
+    const QCommandLineOption statsUrlOption("stats-url", "Poll domain stats from here instead of the local domain-server", "url");
+    parser.addOption(statsUrlOption);
+
+    const QCommandLineOption statsIntervalOption("stats-interval", "Seconds between domain stats polls", "seconds");
+    parser.addOption(statsIntervalOption);
+
+    const QCommandLineOption noSpawnerOption("no-spawner", "Start children from the Stack Manager itself, not the spawner helper");
+    parser.addOption(noSpawnerOption);
+
+    const QCommandLineOption warmPoolOption("warm-pool", "Keep up to this many scripted assignment-clients started ahead of demand", "count");
+    parser.addOption(warmPoolOption);
+
+    const QCommandLineOption traceOption("trace", "Record startup, downloads, spawns and log flushes as a Chrome trace "
+                                         "written on quit, also set by HIFI_STACK_MANAGER_TRACE", "json-file");
+    parser.addOption(traceOption);
+
+    const QCommandLineOption metricsPortOption("metrics-port", "Serve OpenMetrics at http://127.0.0.1:<port>/metrics", "port");
+    parser.addOption(metricsPortOption);
+
+    const QCommandLineOption stacksOption("stacks", "Number of isolated stacks to run on this host, Linux only", "count");
+    parser.addOption(stacksOption);
+
+    const QCommandLineOption logSegmentOption("log-segment-mb", "Rotate child logs at this size", "megabytes");
+    parser.addOption(logSegmentOption);
+
+    const QCommandLineOption logRetentionDaysOption("log-retention-days", "Delete child logs older than this", "days");
+    parser.addOption(logRetentionDaysOption);
+
+    const QCommandLineOption logRetentionSizeOption("log-retention-mb", "Cap total size of child logs", "megabytes");
+    parser.addOption(logRetentionSizeOption);
+
     if (!parser.parse(QCoreApplication::arguments())) {
         qCritical() << parser.errorText() << endl;
         parser.showHelp();
@@ -184,42 +501,157 @@ void AppDelegate::parseCommandLine() {
         qDebug() << "hifiBuildDirectory=" << hifiBuildDirectory << "\n";
         GlobalData::getInstance().setHifiBuildDirectory(hifiBuildDirectory);
     }
-}
 
-void AppDelegate::toggleStack(bool start) {
-    toggleDomainServer(start);
-    toggleAssignmentClientMonitor(start);
-    toggleScriptedAssignmentClients(start);
-    emit stackStateChanged(start);
+    if (parser.isSet(updateTimeOption)) {
+        _scheduledUpdateTime = QTime::fromString(parser.value(updateTimeOption), "hh:mm");
+        if (!_scheduledUpdateTime.isValid()) {
+            qWarning() << "Ignoring invalid update time" << parser.value(updateTimeOption);
+        }
+    }
+
+    if (parser.isSet(logLevelOption) && !AsyncLogWriter::levelFromName(parser.value(logLevelOption), _minimumLogLevel)) {
+        qWarning() << "Ignoring invalid log level" << parser.value(logLevelOption);
+    }
+
+    if (parser.isSet(metricsConfigOption)) {
+        _metricsConfigPath = parser.value(metricsConfigOption);
+    }
+
+    if (parser.isSet(profileOption)) {
+        _profilePath = parser.value(profileOption);
+    }
+
+    _automaticPlacement = parser.isSet(autoPlacementOption);
+
+    if (parser.isSet(cgroupOption)) {
+        ProcessPlacement::setCgroupRoot(parser.value(cgroupOption));
+    }
+
+    _useProcessSpawner = !parser.isSet(noSpawnerOption);
+
+    if (parser.isSet(statsUrlOption)) {
+        _statsBaseUrl = parser.value(statsUrlOption);
+    }
+
+    if (parser.isSet(statsIntervalOption)) {
+        _statsIntervalSecs = parser.value(statsIntervalOption).toInt();
+        if (_statsIntervalSecs <= 0) {
+            qWarning() << "Ignoring invalid stats interval" << parser.value(statsIntervalOption);
+        }
+    }
+
+    if (parser.isSet(warmPoolOption)) {
+        int warmPoolSize = parser.value(warmPoolOption).toInt();
+        if (warmPoolSize > 0) {
+            _warmAssignmentPool = new WarmAssignmentPool(warmPoolSize, this);
+        } else {
+            qWarning() << "Ignoring invalid warm pool size" << parser.value(warmPoolOption);
+        }
+    }
+
+    _tracePath = QString::fromLocal8Bit(qgetenv(TRACE_ENVIRONMENT_VARIABLE));
+    if (parser.isSet(traceOption)) {
+        _tracePath = parser.value(traceOption);
+    }
+
+    if (parser.isSet(metricsPortOption)) {
+        int metricsPort = parser.value(metricsPortOption).toInt();
+        if (metricsPort > 0 && metricsPort <= 65535) {
+            _metricsPort = metricsPort;
+        } else {
+            qWarning() << "Ignoring invalid metrics port" << parser.value(metricsPortOption);
+        }
+    }
+
+    if (parser.isSet(stacksOption)) {
+        int stackCount = parser.value(stacksOption).toInt();
+        if (stackCount > 1 && !StackInstance::canIsolateStacks()) {
+            qWarning() << "Running only one stack, the children's settings can't be kept apart on this platform.";
+        } else if (stackCount >= 1 && stackCount <= MAX_STACK_COUNT) {
+            _stackCount = stackCount;
+        } else {
+            qWarning() << "Ignoring invalid stack count" << parser.value(stacksOption);
+        }
+    }
+
+    const qint64 BYTES_PER_MB = 1024 * 1024;
+
+    if (parser.isSet(logSegmentOption) && parser.value(logSegmentOption).toInt() > 0) {
+        _logLifecyclePolicy.maxSegmentBytes = parser.value(logSegmentOption).toInt() * BYTES_PER_MB;
+    }
+
+    if (parser.isSet(logRetentionDaysOption) && parser.value(logRetentionDaysOption).toInt() > 0) {
+        _logLifecyclePolicy.retentionDays = parser.value(logRetentionDaysOption).toInt();
+    }
+
+    if (parser.isSet(logRetentionSizeOption) && parser.value(logRetentionSizeOption).toInt() > 0) {
+        _logLifecyclePolicy.retentionTotalBytes = parser.value(logRetentionSizeOption).toInt() * BYTES_PER_MB;
+    }
 }
 
-void AppDelegate::toggleDomainServer(bool start) {
+bool AppDelegate::loadLaunchPlan(const QString& profilePath, LaunchPlan& plan) {
+    StackProfile profile;
+    QStringList errors;
 
+    if (!profile.load(profilePath, errors) || !profile.compile(plan, errors)) {
+        qCritical() << "Stack profile" << profilePath << "is invalid:" << errors.join("; ");
+        return false;
+    }
+
+    qDebug() << "Running stack profile" << profile.getName() << "with" << plan.stages.size() << "launch stages.";
+    return true;
+}
+
+void AppDelegate::toggleStack(bool start) {
     if (start) {
-        _domainServerProcess->start(QStringList());
+        _stackLauncher->start();
 
-        _window->getLogsWidget()->addTab(_domainServerProcess->getLogViewer(), "Domain Server");
+        foreach(BackgroundProcess* process, _stackLauncher->getProcesses()) {
+            _window->addProcessLogTab(process, _stackLauncher->getName(process));
+        }
 
         if (_domainServerID.isEmpty()) {
             // after giving the domain server some time to set up, ask for its ID
             QTimer::singleShot(1000, this, SLOT(requestDomainServerID()));
         }
     } else {
-        _domainServerProcess->terminate();
-        _domainServerProcess->waitForFinished(WAIT_FOR_CHILD_MSECS);
-        _domainServerProcess->kill();
+        _stackLauncher->stop();
+
+        // the next domain-server may not start with the settings we last saw
+        _domainSettingsSync->invalidate();
     }
-}
 
-void AppDelegate::toggleAssignmentClientMonitor(bool start) {
+    toggleScriptedAssignmentClients(start);
+
     if (start) {
-        _acMonitorProcess->start(QStringList() << "-n" << "4");
-        _window->getLogsWidget()->addTab(_acMonitorProcess->getLogViewer(), "Assignment Clients");
+        _domainStatsPoller->start();
     } else {
-        _acMonitorProcess->terminate();
-        _acMonitorProcess->waitForFinished(WAIT_FOR_CHILD_MSECS);
-        _acMonitorProcess->kill();
+        _domainStatsPoller->stop();
     }
+
+    if (_warmAssignmentPool) {
+        if (start) {
+            _warmAssignmentPool->start();
+        } else {
+            _warmAssignmentPool->stop();
+        }
+    }
+
+    foreach(StackInstance* stack, _extraStacks) {
+        if (start) {
+            stack->start();
+            _window->addProcessLogTab(stack->getDomainServerProcess(), stack->getName() + " Domain Server");
+            _window->addProcessLogTab(stack->getAssignmentClientMonitorProcess(), stack->getName() + " Assignment Clients");
+        } else {
+            stack->stop();
+        }
+    }
+
+    emit stackStateChanged(start);
+}
+
+void AppDelegate::toggleAssignmentClientMonitor(bool start) {
+    _stackLauncher->toggleBinary(StackProfile::ASSIGNMENT_CLIENT_BINARY, start);
 }
 
 void AppDelegate::toggleScriptedAssignmentClients(bool start) {
@@ -227,45 +659,46 @@ void AppDelegate::toggleScriptedAssignmentClients(bool start) {
         if (start) {
             scriptProcess->start(scriptProcess->getLastArgList());
         } else {
-            scriptProcess->terminate();
-            scriptProcess->waitForFinished(WAIT_FOR_CHILD_MSECS);
-            scriptProcess->kill();
+            scriptProcess->stop();
         }
     }
 }
 
-int AppDelegate::startScriptedAssignment(const QUuid& scriptID, const QString& pool) {
+void AppDelegate::startScriptedAssignment(const QUuid& scriptID, const QString& pool) {
 
     BackgroundProcess* scriptProcess = _scriptProcesses.value(scriptID);
 
     if (!scriptProcess) {
-        QStringList argList = QStringList() << "-t" << "2";
-        if (!pool.isEmpty()) {
-            argList << "--pool" << pool;
-        }
+        scriptProcess = _warmAssignmentPool ? _warmAssignmentPool->take(pool) : NULL;
 
-        scriptProcess = new BackgroundProcess(GlobalData::getInstance().getAssignmentClientExecutablePath(),
-                                              this);
-
-        scriptProcess->start(argList);
+        if (scriptProcess) {
+            scriptProcess->setParent(this);
+        } else {
+            scriptProcess = new BackgroundProcess(GlobalData::getInstance().getAssignmentClientExecutablePath(),
+                                                  this);
+            scriptProcess->setCpuSet(_scriptedCpuSet);
+            scriptProcess->start(WarmAssignmentPool::argumentsForPool(pool));
+        }
 
-        qint64 processID = scriptProcess->processId();
+        // through the spawner the PID only arrives later, so processes are told apart by a number of our own
+        QString scriptNumber = QString::number(_nextScriptNumber++);
         _scriptProcesses.insert(scriptID, scriptProcess);
 
-        _window->getLogsWidget()->addTab(scriptProcess->getLogViewer(), "Scripted Assignment "
-                                        + QString::number(processID));
+        _logTimeline->addSource("Scripted " + scriptNumber, &scriptProcess->getLogStore());
+        _logMetrics->addSource("Scripted " + scriptNumber, &scriptProcess->getLogStore());
+
+        _window->addProcessLogTab(scriptProcess, "Scripted Assignment " + scriptNumber);
     } else {
-        scriptProcess->QProcess::start();
+        scriptProcess->start(scriptProcess->getLastArgList());
     }
-
-    return scriptProcess->processId();
 }
 
 void AppDelegate::stopScriptedAssignment(BackgroundProcess* backgroundProcess) {
-    _window->getLogsWidget()->removeTab(_window->getLogsWidget()->indexOf(backgroundProcess->getLogViewer()));
-    backgroundProcess->terminate();
-    backgroundProcess->waitForFinished(WAIT_FOR_CHILD_MSECS);
-    backgroundProcess->kill();
+    _logTimeline->removeSource(&backgroundProcess->getLogStore());
+    _logMetrics->removeSource(&backgroundProcess->getLogStore());
+    _window->removeProcessLogTab(backgroundProcess);
+    backgroundProcess->stop();
+    backgroundProcess->deleteLater();
 }
 
 void AppDelegate::stopScriptedAssignment(const QUuid& scriptID) {
@@ -275,6 +708,131 @@ void AppDelegate::stopScriptedAssignment(const QUuid& scriptID) {
     }
 }
 
+qint64 AppDelegate::getScriptedAssignmentProcessID(const QUuid& scriptID) const {
+    BackgroundProcess* scriptProcess = _scriptProcesses.value(scriptID);
+    if (!scriptProcess || scriptProcess->state() == QProcess::NotRunning) {
+        return 0;
+    }
+
+    return scriptProcess->processId();
+}
+
+bool AppDelegate::isScriptedAssignmentRunning(const QUuid& scriptID) const {
+    BackgroundProcess* scriptProcess = _scriptProcesses.value(scriptID);
+    return scriptProcess && scriptProcess->state() != QProcess::NotRunning;
+}
+
+bool AppDelegate::isStackRunning() const {
+    return getRunningStackCount() > 0;
+}
+
+int AppDelegate::getRunningStackCount() const {
+    int runningCount = 0;
+
+    if (_stackLauncher->isRunning()) {
+        ++runningCount;
+    }
+
+    foreach(StackInstance* stack, _extraStacks) {
+        if (stack->isRunning()) {
+            ++runningCount;
+        }
+    }
+
+    return runningCount;
+}
+
+QString AppDelegate::describeStacks() const {
+    QStringList descriptions;
+
+    bool isRunning = _stackLauncher->isRunning();
+    descriptions << QString("Stack 1: %1, %2, %3").arg(GlobalData::getInstance().getDomainServerBaseUrl(),
+                                                       StackInstance::describeCpuSet(_domainServerProcess->getCpuSet()),
+                                                       isRunning ? "running" : "stopped");
+
+    foreach(StackInstance* stack, _extraStacks) {
+        descriptions << stack->describe();
+    }
+
+    return descriptions.join("\n");
+}
+
+void AppDelegate::restartRunningProcesses() {
+    // restart one process at a time, domain-server first, so downtime is limited to each restart
+    QList<BackgroundProcess*> rollingOrder;
+    rollingOrder << _stackLauncher->getProcesses() << _scriptProcesses.values();
+
+    foreach(StackInstance* stack, _extraStacks) {
+        rollingOrder << stack->getDomainServerProcess() << stack->getAssignmentClientMonitorProcess();
+    }
+
+    foreach(BackgroundProcess* process, rollingOrder) {
+        if (process->state() != QProcess::NotRunning) {
+            process->restart();
+        }
+    }
+
+    if (_warmAssignmentPool) {
+        _warmAssignmentPool->replaceIdleProcesses();
+    }
+}
+
+BackgroundProcess* AppDelegate::processForLogStore(const LogStore* store) const {
+    foreach(BackgroundProcess* process, _stackLauncher->getProcesses()) {
+        if (&process->getLogStore() == store) {
+            return process;
+        }
+    }
+
+    foreach(BackgroundProcess* scriptProcess, _scriptProcesses) {
+        if (&scriptProcess->getLogStore() == store) {
+            return scriptProcess;
+        }
+    }
+
+    foreach(StackInstance* stack, _extraStacks) {
+        if (&stack->getDomainServerProcess()->getLogStore() == store) {
+            return stack->getDomainServerProcess();
+        } else if (&stack->getAssignmentClientMonitorProcess()->getLogStore() == store) {
+            return stack->getAssignmentClientMonitorProcess();
+        }
+    }
+
+    return NULL;
+}
+
+void AppDelegate::handleLogAlertStateChanged(const LogStore* store, bool isAlerting) {
+    BackgroundProcess* process = processForLogStore(store);
+    if (!process) {
+        return;
+    }
+
+    QString description;
+    for (int source = 0; source < _logMetrics->getSourceCount(); ++source) {
+        if (_logMetrics->getSourceStore(source) == store) {
+            description = _logMetrics->describeAlerts(source);
+        }
+    }
+
+    _window->setLogTabAlert(process, isAlerting, description);
+}
+
+void AppDelegate::handleUpdateStaged() {
+    if (!isStackRunning()) {
+        applyStagedUpdate();
+    } else if (!_scheduledUpdateTime.isValid()) {
+        // wait for the operator to pick a moment
+        _window->setStagedUpdateAvailable(true);
+    }
+}
+
+void AppDelegate::applyStagedUpdate() {
+    if (_updateService && _updateService->activateStagedUpdate()) {
+        qDebug() << "Restarting stack processes onto updated binaries.";
+        restartRunningProcesses();
+        _window->setStagedUpdateAvailable(false);
+    }
+}
 
 void AppDelegate::requestDomainServerID() {
     // ask the domain-server for its ID so we can update the accessible name
@@ -283,9 +841,33 @@ void AppDelegate::requestDomainServerID() {
 
     qDebug() << "Requesting domain server ID from" << domainIDURL.toString();
 
-    QNetworkReply* idReply = _manager->get(QNetworkRequest(domainIDURL));
+    HttpRequest* idRequest = _httpClient->get(QNetworkRequest(domainIDURL), DOMAIN_SERVER_REQUEST_POLICY);
+    connect(idRequest, &HttpRequest::finished, this, &AppDelegate::handleDomainIDReply);
+}
+
+void AppDelegate::handleStackProcessStateChanged(QProcess::ProcessState state) {
+    BackgroundProcess* process = static_cast<BackgroundProcess*>(sender());
+    QString binary = _stackLauncher->getBinary(process);
 
-    connect(idReply, &QNetworkReply::finished, this, &AppDelegate::handleDomainIDReply);
+    if (state == QProcess::Running) {
+        QMetaObject::invokeMethod(_localServiceDiscovery, "processStarted", Q_ARG(QString, binary));
+    } else if (state == QProcess::NotRunning) {
+        QMetaObject::invokeMethod(_localServiceDiscovery, "processStopped", Q_ARG(QString, binary));
+    }
+}
+
+void AppDelegate::handleLocalServicePortChanged(const QString& key, quint16 port) {
+    if (port == 0) {
+        _localServicePorts.remove(key);
+    } else {
+        _localServicePorts[key] = port;
+
+        if (key == DOMAIN_SERVER_LOCAL_HTTP_PORT_KEY) {
+            GlobalData::getInstance().setDomainServerBaseUrl(QString("http://localhost:") + QString::number(port));
+        }
+    }
+
+    emit localServicesChanged();
 }
 
 const QString AppDelegate::getServerAddress() const {
@@ -293,101 +875,113 @@ const QString AppDelegate::getServerAddress() const {
 }
 
 void AppDelegate::handleDomainIDReply() {
-    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    HttpRequest* request = qobject_cast<HttpRequest*>(sender());
 
-    if (reply->error() == QNetworkReply::NoError
-        && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200) {
-        _domainServerID = QString(reply->readAll());
+    if (request->isSuccess()) {
+        _domainServerID = QString(request->getBody());
 
         if (!_domainServerID.isEmpty()) {
 
             if (!QUuid(_domainServerID).isNull()) {
                 qDebug() << "The domain server ID is" << _domainServerID;
-                qDebug() << "Asking High Fidelity API for associated domain name.";
+                _domainNameCache->setLastDomainID(_domainServerID);
+
+                // a cached name is shown right away, even a stale one beats "localhost" while we ask again
+                QString cachedName;
+                DomainNameCache::Freshness freshness = _domainNameCache->lookup(_domainServerID, cachedName);
+                QString shownName = freshness == DomainNameCache::Missing ? "localhost" : cachedName;
+                if (shownName != _domainServerName) {
+                    _domainServerName = shownName;
+                    emit domainAddressChanged();
+                }
+
+                if (freshness != DomainNameCache::Fresh) {
+                    qDebug() << "Asking High Fidelity API for associated domain name.";
 
-                // fire off a request to high fidelity API to see if this domain exists with them
-                QUrl domainGetURL = HIGH_FIDELITY_API_URL + "/domains/" + _domainServerID;
-                QNetworkReply* domainGetReply = _manager->get(QNetworkRequest(domainGetURL));
-                connect(domainGetReply, &QNetworkReply::finished, this, &AppDelegate::handleDomainGetReply);
+                    // fire off a request to high fidelity API to see if this domain exists with them
+                    QUrl domainGetURL = HIGH_FIDELITY_API_URL + "/domains/" + _domainServerID;
+                    HttpRequest* domainGetRequest = _httpClient->get(QNetworkRequest(domainGetURL), REMOTE_REQUEST_POLICY);
+                    connect(domainGetRequest, &HttpRequest::finished, this, &AppDelegate::handleDomainGetReply);
+                }
             } else {
                 emit domainServerIDMissing();
             }
         }
     } else {
-        qDebug() << "Error getting domain ID from domain-server - "
-            << reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt()
-            << reply->errorString();
+        qDebug() << "Error getting domain ID from domain-server - " << request->getStatusCode() << request->getErrorString();
     }
 }
 
 void AppDelegate::handleDomainGetReply() {
-    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    HttpRequest* request = qobject_cast<HttpRequest*>(sender());
 
-    if (reply->error() == QNetworkReply::NoError
-        && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200) {
-        QJsonDocument responseDocument = QJsonDocument::fromJson(reply->readAll());
+    if (request->isSuccess()) {
+        QJsonDocument responseDocument = QJsonDocument::fromJson(request->getBody());
 
         QJsonObject domainObject = responseDocument.object()["domain"].toObject();
 
         const QString DOMAIN_NAME_KEY = "name";
         const QString DOMAIN_OWNER_PLACES_KEY = "owner_places";
 
+        QString domainName;
         if (domainObject.contains(DOMAIN_NAME_KEY)) {
-            _domainServerName = domainObject[DOMAIN_NAME_KEY].toString();
+            domainName = domainObject[DOMAIN_NAME_KEY].toString();
         } else if (domainObject.contains(DOMAIN_OWNER_PLACES_KEY)) {
             QJsonArray ownerPlaces = domainObject[DOMAIN_OWNER_PLACES_KEY].toArray();
             if (ownerPlaces.size() > 0) {
-                _domainServerName = ownerPlaces[0].toObject()[DOMAIN_NAME_KEY].toString();
+                domainName = ownerPlaces[0].toObject()[DOMAIN_NAME_KEY].toString();
             }
         }
 
+        if (!domainName.isEmpty()) {
+            _domainServerName = domainName;
+            _domainNameCache->store(_domainServerID, _domainServerName);
+        }
+
         qDebug() << "This domain server's name is" << _domainServerName << "- updating address link.";
 
         emit domainAddressChanged();
+    } else {
+        qDebug() << "Could not resolve the domain name -" << request->getErrorString() << "- keeping" << _domainServerName;
     }
 }
 
 void AppDelegate::changeDomainServerIndexPath(const QString& newPath) {
     if (!newPath.isEmpty()) {
-        QString pathsJSON = "{\"paths\": { \"/\": { \"viewpoint\": \"%1\" }}}";
-
-        QNetworkRequest settingsRequest(GlobalData::getInstance().getDomainServerBaseUrl() + "/settings.json");
-        settingsRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-
-        QNetworkReply* settingsReply = _manager->post(settingsRequest, pathsJSON.arg(newPath).toLocal8Bit());
-        connect(settingsReply, &QNetworkReply::finished, this, &AppDelegate::handleChangeIndexPathResponse);
+        _domainSettingsSync->setValue(INDEX_PATH_KEY_PATH, newPath);
     }
 }
 
-void AppDelegate::handleChangeIndexPathResponse() {
-    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
-
-    if (reply->error() == QNetworkReply::NoError
-        && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200) {
+void AppDelegate::handleSettingSynced(const QStringList& keyPath, bool success) {
+    if (keyPath != INDEX_PATH_KEY_PATH) {
+        return;
+    }
 
+    if (success) {
         qDebug() << "Successfully changed index path in domain-server.";
-        emit indexPathChangeResponse(true);
     } else {
-        qDebug() << "Error changing domain-server index path-" << reply->errorString();
-        emit indexPathChangeResponse(false);
+        qDebug() << "Error changing domain-server index path.";
     }
+    emit indexPathChangeResponse(success);
 }
 
 void AppDelegate::downloadContentSet(const QUrl& contentSetURL) {
     // make sure this link was an svo
     if (contentSetURL.path().endsWith(".svo")) {
         // setup a request for this content set
-        QNetworkRequest contentRequest(contentSetURL);
-        QNetworkReply* contentReply = _manager->get(contentRequest);
-        connect(contentReply, &QNetworkReply::finished, this, &AppDelegate::handleContentSetDownloadFinished);
+        // content sets are big, so only give up on one that stops moving
+        HttpRequestPolicy contentPolicy(0, 2);
+        contentPolicy.stallTimeoutMSecs = CONTENT_SET_STALL_TIMEOUT_MS;
+
+        HttpRequest* contentRequest = _httpClient->get(QNetworkRequest(contentSetURL), contentPolicy);
+        connect(contentRequest, &HttpRequest::finished, this, &AppDelegate::handleContentSetDownloadFinished);
     }
 }
 
 void AppDelegate::handleContentSetDownloadFinished() {
-    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    HttpRequest* request = qobject_cast<HttpRequest*>(sender());
 
-    if (reply->error() == QNetworkReply::NoError
-        && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200) {
+    if (request->isSuccess()) {
 
         QString modelFilename = GlobalData::getInstance().getClientsResourcesPath() + "models.svo";
 
@@ -398,7 +992,7 @@ void AppDelegate::handleContentSetDownloadFinished() {
         // stop the base assignment clients before we try to write the new content
         toggleAssignmentClientMonitor(false);
 
-        if (modelFile.write(reply->readAll()) == -1) {
+        if (modelFile.write(request->getBody()) == -1) {
             qDebug() << "Error writing content set to" << modelFilename;
             modelFile.close();
             toggleAssignmentClientMonitor(true);
@@ -413,7 +1007,7 @@ void AppDelegate::handleContentSetDownloadFinished() {
 
             // did we have a path in the query?
             // if so when we need to set the DS index path to that path
-            QUrlQuery svoQuery(reply->url().query());
+            QUrlQuery svoQuery(request->getUrl().query());
             changeDomainServerIndexPath(svoQuery.queryItemValue("path"));
 
             emit domainAddressChanged();
@@ -440,11 +1034,15 @@ void AppDelegate::onFileSuccessfullyInstalled(const QUrl& url) {
 
     if (_qtReady && _acReady && _dsReady && _dsResourcesReady) {
         _window->setRequirementsLastChecked(QDateTime::currentDateTime().toString());
+
+        TraceSpan showSpan("startup", "MainWindow::show");
         _window->show();
     }
 }
 
 void AppDelegate::createExecutablePath() {
+    TraceSpan span("startup", "createExecutablePath");
+
     QDir launchDir(GlobalData::getInstance().getClientsLaunchPath());
     QDir resourcesDir(GlobalData::getInstance().getClientsResourcesPath());
     QDir logsDir(GlobalData::getInstance().getLogsPath());
@@ -478,6 +1076,8 @@ void AppDelegate::createExecutablePath() {
 }
 
 void AppDelegate::downloadLatestExecutablesAndRequirements() {
+    TraceSpan span("startup", "downloadLatestExecutablesAndRequirements");
+
     // Check if Qt is already installed
     if (GlobalData::getInstance().getPlatform() == "mac") {
         if (QDir(GlobalData::getInstance().getClientsLaunchPath() + "QtCore.framework").exists()) {
@@ -530,23 +1130,14 @@ void AppDelegate::downloadLatestExecutablesAndRequirements() {
             acFile.close();
         }
 
-        QNetworkRequest acReq(QUrl(GlobalData::getInstance().getAssignmentClientMD5URL()));
-        QNetworkReply* acReply = _manager->get(acReq);
-        QEventLoop acLoop;
-        connect(acReply, SIGNAL(finished()), &acLoop, SLOT(quit()));
-        acLoop.exec();
-        QByteArray acMd5Data = acReply->readAll().trimmed();
-        if (GlobalData::getInstance().getPlatform() == "win") {
-            // fix for reading the MD5 hash from Windows-generated
-            // binary data of the MD5 hash
-            QTextStream stream(acMd5Data);
-            stream >> acMd5Data;
-        }
+        QByteArray acMd5Data = fetchMD5(GlobalData::getInstance().getAssignmentClientMD5URL());
 
         // fix for Mac and Linux network accessibility
         if (acMd5Data.size() == 0) {
             // network is not accessible
             qDebug() << "Could not connect to the internet.";
+
+            TraceSpan showSpan("startup", "MainWindow::show");
             _window->show();
             return;
         }
@@ -557,18 +1148,7 @@ void AppDelegate::downloadLatestExecutablesAndRequirements() {
         }
 
 
-        QNetworkRequest dsReq(QUrl(GlobalData::getInstance().getDomainServerMD5URL()));
-        QNetworkReply* dsReply = _manager->get(dsReq);
-        QEventLoop dsLoop;
-        connect(dsReply, SIGNAL(finished()), &dsLoop, SLOT(quit()));
-        dsLoop.exec();
-        QByteArray dsMd5Data = dsReply->readAll().trimmed();
-        if (GlobalData::getInstance().getPlatform() == "win") {
-            // fix for reading the MD5 hash from Windows generated
-            // binary data of the MD5 hash
-            QTextStream stream(dsMd5Data);
-            stream >> dsMd5Data;
-        }
+        QByteArray dsMd5Data = fetchMD5(GlobalData::getInstance().getDomainServerMD5URL());
         qDebug() << "DS MD5: " << dsMd5Data;
         if (dsMd5Data.toLower() == QCryptographicHash::hash(dsData, QCryptographicHash::Md5).toHex()) {
             _dsReady = true;
@@ -577,18 +1157,7 @@ void AppDelegate::downloadLatestExecutablesAndRequirements() {
 
     if (_qtReady) {
         // check MD5 of requirements.zip only if Qt is found
-        QNetworkRequest reqZipReq(QUrl(GlobalData::getInstance().getRequirementsMD5URL()));
-        QNetworkReply* reqZipReply = _manager->get(reqZipReq);
-        QEventLoop reqZipLoop;
-        connect(reqZipReply, SIGNAL(finished()), &reqZipLoop, SLOT(quit()));
-        reqZipLoop.exec();
-        QByteArray reqZipMd5Data = reqZipReply->readAll().trimmed();
-        if (GlobalData::getInstance().getPlatform() == "win") {
-            // fix for reading the MD5 hash from Windows generated
-            // binary data of the MD5 hash
-            QTextStream stream(reqZipMd5Data);
-            stream >> reqZipMd5Data;
-        }
+        QByteArray reqZipMd5Data = fetchMD5(GlobalData::getInstance().getRequirementsMD5URL());
         qDebug() << "Requirements ZIP MD5: " << reqZipMd5Data;
         if (reqZipMd5Data.toLower() != QCryptographicHash::hash(reqZipData, QCryptographicHash::Md5).toHex()) {
             _qtReady = false;
@@ -598,18 +1167,7 @@ void AppDelegate::downloadLatestExecutablesAndRequirements() {
     if (_dsResourcesReady) {
         // check MD5 of resources.zip only if Domain Server
         // resources are installed
-        QNetworkRequest resZipReq(QUrl(GlobalData::getInstance().getDomainServerResourcesMD5URL()));
-        QNetworkReply* resZipReply = _manager->get(resZipReq);
-        QEventLoop resZipLoop;
-        connect(resZipReply, SIGNAL(finished()), &resZipLoop, SLOT(quit()));
-        resZipLoop.exec();
-        QByteArray resZipMd5Data = resZipReply->readAll().trimmed();
-        if (GlobalData::getInstance().getPlatform() == "win") {
-            // fix for reading the MD5 hash from Windows generated
-            // binary data of the MD5 hash
-            QTextStream stream(resZipMd5Data);
-            stream >> resZipMd5Data;
-        }
+        QByteArray resZipMd5Data = fetchMD5(GlobalData::getInstance().getDomainServerResourcesMD5URL());
         qDebug() << "Domain Server Resources ZIP MD5: " << resZipMd5Data;
         if (resZipMd5Data.toLower() != QCryptographicHash::hash(resZipData, QCryptographicHash::Md5).toHex()) {
             _dsResourcesReady = false;
@@ -619,13 +1177,16 @@ void AppDelegate::downloadLatestExecutablesAndRequirements() {
     DownloadManager* downloadManager = 0;
     if (!_qtReady || !_acReady || !_dsReady || !_dsResourcesReady) {
         // initialise DownloadManager
-        downloadManager = new DownloadManager(_manager);
+        TraceSpan downloadManagerSpan("startup", "DownloadManager");
+        downloadManager = new DownloadManager(_httpClient);
         downloadManager->setWindowModality(Qt::ApplicationModal);
         connect(downloadManager, SIGNAL(fileSuccessfullyInstalled(QUrl)),
                 SLOT(onFileSuccessfullyInstalled(QUrl)));
         downloadManager->show();
     } else {
         _window->setRequirementsLastChecked(QDateTime::currentDateTime().toString());
+
+        TraceSpan showSpan("startup", "MainWindow::show");
         _window->show();
     }
 
@@ -646,12 +1207,35 @@ void AppDelegate::downloadLatestExecutablesAndRequirements() {
     }
 }
 
+QByteArray AppDelegate::fetchMD5(const QUrl& url) {
+    TraceSpan span("startup", "fetchMD5", QFileInfo(url.path()).fileName());
+
+    HttpRequest* request = _httpClient->get(QNetworkRequest(url), STARTUP_MD5_REQUEST_POLICY);
+    request->setAutoDelete(false);
+
+    QEventLoop loop;
+    connect(request, &HttpRequest::finished, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    QByteArray md5Data = request->isSuccess() ? request->getBody().trimmed() : QByteArray();
+    delete request;
+
+    if (GlobalData::getInstance().getPlatform() == "win") {
+        // fix for reading the MD5 hash from Windows generated
+        // binary data of the MD5 hash
+        QTextStream stream(md5Data);
+        stream >> md5Data;
+    }
+
+    return md5Data;
+}
+
 void AppDelegate::checkVersion() {
     QNetworkRequest latestVersionRequest((QUrl(CHECK_BUILDS_URL)));
     latestVersionRequest.setHeader(QNetworkRequest::UserAgentHeader, HIGH_FIDELITY_USER_AGENT);
     latestVersionRequest.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
-    QNetworkReply* reply = _manager->get(latestVersionRequest);
-    connect(reply, &QNetworkReply::finished, this, &AppDelegate::parseVersionXml);
+    HttpRequest* request = _httpClient->get(latestVersionRequest, REMOTE_REQUEST_POLICY);
+    connect(request, &HttpRequest::finished, this, &AppDelegate::parseVersionXml);
 
     _checkVersionTimer.setInterval(VERSION_CHECK_INTERVAL_MS);
     _checkVersionTimer.start();
@@ -678,8 +1262,8 @@ void AppDelegate::parseVersionXml() {
     QString operatingSystem("ubuntu");
 #endif
 
-    QNetworkReply* sender = qobject_cast<QNetworkReply*>(QObject::sender());
-    QXmlStreamReader xml(sender);
+    HttpRequest* request = qobject_cast<HttpRequest*>(sender());
+    QXmlStreamReader xml(request->getBody());
 
     QHash<QString, VersionInformation> projectVersions;
 
@@ -770,5 +1354,4 @@ void AppDelegate::parseVersionXml() {
         }
     }
 
-    sender->deleteLater();
 }
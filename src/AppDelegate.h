@@ -13,76 +13,177 @@
 #include <QApplication>
 #include <QCoreApplication>
 #include <QList>
+#include <QProcess>
+#include <QStringList>
 #include <QNetworkAccessManager>
 #include <QUrl>
 #include <QUuid>
 #include <QHash>
+#include <QThread>
+#include <QTime>
 #include <QTimer>
+#include <QVector>
 
+#include "LogLifecycleManager.h"
 #include "MainWindow.h"
 
 class BackgroundProcess;
+class DomainNameCache;
+class DomainSettingsSync;
+class DomainStatsPoller;
+class HttpClient;
+class LocalServiceDiscovery;
+class LogIndexService;
+class LogMetrics;
+class LogStore;
+class LogTimeline;
+class LogUpdateScheduler;
+class MetricsCollector;
+class MetricsExporter;
+class ProcessSpawner;
+class StackInstance;
+class StackLauncher;
+struct LaunchPlan;
+class UpdateService;
+class WarmAssignmentPool;
 
 class AppDelegate : public QApplication
 {
     Q_OBJECT
 public:
-    static AppDelegate* getInstance() { return static_cast<AppDelegate*>(QCoreApplication::instance()); }
+    // NULL when the application is something else, like the benchmarks
+    static AppDelegate* getInstance() { return qobject_cast<AppDelegate*>(QCoreApplication::instance()); }
 
     AppDelegate(int argc, char* argv[]);
     ~AppDelegate();
 
     void toggleStack(bool start);
-    void toggleDomainServer(bool start);
     void toggleAssignmentClientMonitor(bool start);
     void toggleScriptedAssignmentClients(bool start);
 
-    int startScriptedAssignment(const QUuid& scriptID, const QString& pool = QString());
+    void startScriptedAssignment(const QUuid& scriptID, const QString& pool = QString());
     void stopScriptedAssignment(BackgroundProcess* backgroundProcess);
     void stopScriptedAssignment(const QUuid& scriptID);
+    qint64 getScriptedAssignmentProcessID(const QUuid& scriptID) const;
+    bool isScriptedAssignmentRunning(const QUuid& scriptID) const;
 
     void stopStack() { toggleStack(false); }
 
     const QString getServerAddress() const;
+
+    int getStackCount() const { return _extraStacks.size() + 1; }
+    int getRunningStackCount() const;
+    QString describeStacks() const;
+
+    LogIndexService* getLogIndexService() { return _logIndexService; }
+    LogLifecycleManager* getLogLifecycleManager() { return _logLifecycleManager; }
+    LogTimeline* getLogTimeline() { return _logTimeline; }
+    LogMetrics* getLogMetrics() { return _logMetrics; }
+    LogUpdateScheduler* getLogUpdateScheduler() { return _logUpdateScheduler; }
+    ProcessSpawner* getProcessSpawner() { return _processSpawner; }
+    DomainStatsPoller* getDomainStatsPoller() { return _domainStatsPoller; }
+    HttpClient* getHttpClient() { return _httpClient; }
+    DomainSettingsSync* getDomainSettingsSync() { return _domainSettingsSync; }
+
+    // live map of the ports stack processes have published, by shared-memory key
+    const QHash<QString, quint16>& getLocalServicePorts() const { return _localServicePorts; }
+    quint16 getLocalServicePort(const QString& key) const { return _localServicePorts.value(key); }
 public slots:
     void downloadContentSet(const QUrl& contentSetURL);
+    void applyStagedUpdate();
 signals:
     void domainServerIDMissing();
     void domainAddressChanged();
     void contentSetDownloadResponse(bool wasSuccessful);
     void indexPathChangeResponse(bool wasSuccessful);
     void stackStateChanged(bool isOn);
+    void processAlert(const QString& process, const QString& metric, double perSecond, double maxPerSecond);
+    void stacksChanged();
+    void localServicesChanged();
 private slots:
     void onFileSuccessfullyInstalled(const QUrl& url);
     void requestDomainServerID();
     void handleDomainIDReply();
     void handleDomainGetReply();
-    void handleChangeIndexPathResponse();
+    void handleSettingSynced(const QStringList& keyPath, bool success);
+    void handleStackProcessStateChanged(QProcess::ProcessState state);
+    void handleLocalServicePortChanged(const QString& key, quint16 port);
     void handleContentSetDownloadFinished();
     void checkVersion();
     void parseVersionXml();
+    void handleUpdateStaged();
+    void handleLogAlertStateChanged(const LogStore* store, bool isAlerting);
 
 private:
     void parseCommandLine();
     void createExecutablePath();
     void downloadLatestExecutablesAndRequirements();
+    QByteArray fetchMD5(const QUrl& url);
 
     void changeDomainServerIndexPath(const QString& newPath);
+    bool loadLaunchPlan(const QString& profilePath, LaunchPlan& plan);
+
+    bool isStackRunning() const;
+    void restartRunningProcesses();
+    BackgroundProcess* processForLogStore(const LogStore* store) const;
 
     QNetworkAccessManager* _manager;
+    HttpClient* _httpClient;
     bool _qtReady;
     bool _dsReady;
     bool _dsResourcesReady;
     bool _acReady;
+    QString _profilePath;
+    QString _tracePath;
+    bool _automaticPlacement;
+    StackLauncher* _stackLauncher;
     BackgroundProcess* _domainServerProcess;
-    BackgroundProcess* _acMonitorProcess;
     QHash<QUuid, BackgroundProcess*> _scriptProcesses;
+    int _nextScriptNumber; // names scripted processes, their PID isn't known yet when they are started
+    WarmAssignmentPool* _warmAssignmentPool;
+    QVector<int> _scriptedCpuSet;
+
+    int _stackCount;
+    QList<StackInstance*> _extraStacks;
 
     QString _domainServerID;
     QString _domainServerName;
+    DomainNameCache* _domainNameCache;
+
+    QtMsgType _minimumLogLevel;
 
     QTimer _checkVersionTimer;
 
+    UpdateService* _updateService;
+    QTime _scheduledUpdateTime;
+
+    LogLifecyclePolicy _logLifecyclePolicy;
+    LogLifecycleManager* _logLifecycleManager;
+
+    LogTimeline* _logTimeline;
+    LogUpdateScheduler* _logUpdateScheduler;
+    bool _useProcessSpawner;
+    ProcessSpawner* _processSpawner;
+    DomainSettingsSync* _domainSettingsSync;
+    DomainStatsPoller* _domainStatsPoller;
+    QString _statsBaseUrl;
+    int _statsIntervalSecs;
+
+    QString _metricsConfigPath;
+    LogMetrics* _logMetrics;
+
+    QThread* _logIndexThread;
+    LogIndexService* _logIndexService;
+
+    QThread* _serviceDiscoveryThread;
+    LocalServiceDiscovery* _localServiceDiscovery;
+    QHash<QString, quint16> _localServicePorts;
+
+    quint16 _metricsPort;
+    MetricsCollector* _metricsCollector;
+    QThread* _metricsThread;
+    MetricsExporter* _metricsExporter;
+
     MainWindow* _window;
 };
 
@@ -0,0 +1,257 @@
+//
+//  AsyncLogWriter.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "AsyncLogWriter.h"
+#include "Tracer.h"
+
+#include <QDateTime>
+
+#include <cstdio>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+const int FLUSH_INTERVAL_MS = 250;
+const int WAKE_AT_PENDING_RECORDS = 256;
+const int MAX_BATCH_BYTES = 64 * 1024;
+
+// a fatal message can come while the writer thread holds the drain lock, don't wait on it forever
+const int FATAL_FLUSH_LOCK_TIMEOUT_MS = 500;
+
+const QString TIMESTAMP_FORMAT = "dd/MM/yyyy hh:mm:ss";
+
+AsyncLogWriter::AsyncLogWriter(const QString& path, QObject* parent) :
+    QThread(parent),
+    _tail(new Record),
+    _pendingCount(0),
+    _minimumLevel(levelRank(QtDebugMsg)),
+    _isStopping(0),
+    _file(path),
+    _fileDescriptor(-1),
+    _cachedSecond(-1)
+{
+    // the queue always holds one stub record, so push and pop never touch the same pointer
+    _tail->next.store(NULL);
+    _head.store(_tail);
+
+    TraceSpan span("startup", "openLogFile");
+    if (_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        _fileDescriptor = _file.handle();
+    }
+}
+
+AsyncLogWriter::~AsyncLogWriter() {
+    stop();
+
+    delete _tail;
+}
+
+int AsyncLogWriter::levelRank(QtMsgType type) {
+    switch (type) {
+        case QtDebugMsg:
+            return 0;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 5, 0)
+        case QtInfoMsg:
+            return 1;
+#endif
+        case QtWarningMsg:
+            return 2;
+        case QtCriticalMsg:
+            return 3;
+        case QtFatalMsg:
+        default:
+            return 4;
+    }
+}
+
+bool AsyncLogWriter::levelFromName(const QString& name, QtMsgType& level) {
+    QString lowerName = name.toLower();
+
+    if (lowerName == "debug") {
+        level = QtDebugMsg;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 5, 0)
+    } else if (lowerName == "info") {
+        level = QtInfoMsg;
+#endif
+    } else if (lowerName == "warning") {
+        level = QtWarningMsg;
+    } else if (lowerName == "critical") {
+        level = QtCriticalMsg;
+    } else if (lowerName == "fatal") {
+        level = QtFatalMsg;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+void AsyncLogWriter::enqueue(QtMsgType type, const QString& message) {
+    Record* record = new Record;
+    record->next.store(NULL);
+    record->type = type;
+    record->msecsSinceEpoch = QDateTime::currentMSecsSinceEpoch();
+    // converted here rather than on the writer thread, so a crash handler finds bytes it can write as-is
+    record->message = message.toLocal8Bit();
+
+    Record* previous = _head.fetchAndStoreOrdered(record);
+    previous->next.storeRelease(record);
+
+    // only the producer that crosses the threshold wakes the writer early
+    if (_pendingCount.fetchAndAddOrdered(1) + 1 == WAKE_AT_PENDING_RECORDS) {
+        _wakeup.release();
+    }
+}
+
+bool AsyncLogWriter::dequeue(QtMsgType& type, qint64& msecsSinceEpoch, QByteArray& message) {
+    Record* tail = _tail;
+    Record* next = tail->next.loadAcquire();
+
+    if (!next) {
+        return false;
+    }
+
+    // next becomes the new stub, so take its payload and free the old one
+    type = next->type;
+    msecsSinceEpoch = next->msecsSinceEpoch;
+    message.swap(next->message);
+
+    _tail = next;
+    delete tail;
+    return true;
+}
+
+const QByteArray& AsyncLogWriter::timestampPrefix(qint64 msecsSinceEpoch) {
+    qint64 second = msecsSinceEpoch / 1000;
+
+    if (second != _cachedSecond) {
+        _cachedSecond = second;
+        _cachedPrefix = "[" + QDateTime::fromMSecsSinceEpoch(msecsSinceEpoch).toString(TIMESTAMP_FORMAT).toUtf8() + "] ";
+    }
+
+    return _cachedPrefix;
+}
+
+void AsyncLogWriter::drain(bool force) {
+    if (force) {
+        if (!_drainMutex.tryLock(FATAL_FLUSH_LOCK_TIMEOUT_MS)) {
+            return;
+        }
+    } else {
+        _drainMutex.lock();
+    }
+
+    TraceSpan span("log", "drain");
+
+    QByteArray fileBatch;
+    QByteArray stdoutBatch;
+    QtMsgType type;
+    qint64 msecsSinceEpoch;
+    QByteArray messageBytes;
+    int drainedCount = 0;
+
+    while (dequeue(type, msecsSinceEpoch, messageBytes)) {
+        switch (type) {
+            case QtDebugMsg:
+                stdoutBatch += "Debug: ";
+                break;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 5, 0)
+            case QtInfoMsg:
+                stdoutBatch += "Info: ";
+                break;
+#endif
+            case QtWarningMsg:
+                stdoutBatch += "Warning: ";
+                break;
+            case QtCriticalMsg:
+                stdoutBatch += "Critical: ";
+                break;
+            case QtFatalMsg:
+            default:
+                stdoutBatch += "Fatal: ";
+                break;
+        }
+        stdoutBatch += messageBytes;
+        stdoutBatch += '\n';
+
+        fileBatch += timestampPrefix(msecsSinceEpoch);
+        fileBatch += messageBytes;
+        fileBatch += '\n';
+
+        ++drainedCount;
+
+        if (fileBatch.size() >= MAX_BATCH_BYTES) {
+            fwrite(stdoutBatch.constData(), 1, stdoutBatch.size(), stdout);
+            if (_file.isOpen()) {
+                _file.write(fileBatch);
+            }
+            stdoutBatch.clear();
+            fileBatch.clear();
+        }
+    }
+
+    if (drainedCount > 0) {
+        fwrite(stdoutBatch.constData(), 1, stdoutBatch.size(), stdout);
+        fflush(stdout);
+
+        if (_file.isOpen()) {
+            _file.write(fileBatch);
+            _file.flush();
+        }
+
+        _pendingCount.fetchAndAddOrdered(-drainedCount);
+    } else {
+        span.cancel();
+    }
+
+    _drainMutex.unlock();
+}
+
+void AsyncLogWriter::writeForCrash(int descriptor, const char* data, qint64 length) {
+#ifdef Q_OS_WIN
+    _write(descriptor, data, unsigned(length));
+#else
+    if (write(descriptor, data, size_t(length)) < 0) {
+        // nowhere left to report it
+    }
+#endif
+}
+
+void AsyncLogWriter::writePendingForCrash(int descriptor) const {
+    // the stub at _tail is already written, everything after it is still pending
+    Record* record = _tail->next.loadAcquire();
+    while (record) {
+        writeForCrash(descriptor, record->message.constData(), record->message.size());
+        writeForCrash(descriptor, "\n", 1);
+        record = record->next.loadAcquire();
+    }
+}
+
+void AsyncLogWriter::flush() {
+    drain(true);
+}
+
+void AsyncLogWriter::stop() {
+    if (isRunning()) {
+        _isStopping.store(1);
+        _wakeup.release();
+        wait();
+    }
+
+    // pick up anything queued after the writer's last pass
+    drain(false);
+}
+
+void AsyncLogWriter::run() {
+    while (!_isStopping.load()) {
+        _wakeup.tryAcquire(1, FLUSH_INTERVAL_MS);
+        drain(false);
+    }
+}
@@ -0,0 +1,86 @@
+//
+//  AsyncLogWriter.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_AsyncLogWriter_h
+#define hifi_AsyncLogWriter_h
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QSemaphore>
+#include <QString>
+#include <QThread>
+
+// Writes the Stack Manager's own log off the calling thread.
+//
+// Messages go onto a lock-free multi-producer queue (an intrusive linked list whose head is
+// swapped atomically) and a writer thread drains it in batches, formatting timestamps there
+// with a per-second cache. Batches are written when the queue builds up or every flush
+// interval, whichever is first. flush() drains synchronously for fatal messages; it locks and
+// allocates, so it must not be called from a signal handler. Messages are converted to bytes as
+// they are queued, so a crash handler can still write(2) whatever is pending with
+// writePendingForCrash().
+class AsyncLogWriter : public QThread
+{
+    Q_OBJECT
+public:
+    AsyncLogWriter(const QString& path, QObject* parent = 0);
+    ~AsyncLogWriter();
+
+    bool isFileOpen() const { return _file.isOpen(); }
+    int getFileDescriptor() const { return _fileDescriptor; }
+
+    void setMinimumLevel(QtMsgType level) { _minimumLevel.store(levelRank(level)); }
+    bool accepts(QtMsgType type) const { return levelRank(type) >= _minimumLevel.load(); }
+
+    void enqueue(QtMsgType type, const QString& message);
+    void flush();
+    void stop();
+
+    // no locks and no allocation, only write(2); best effort, as the writer thread may be
+    // freeing records while they are walked
+    void writePendingForCrash(int descriptor) const;
+    static void writeForCrash(int descriptor, const char* data, qint64 length);
+
+    static bool levelFromName(const QString& name, QtMsgType& level);
+
+protected:
+    void run();
+
+private:
+    struct Record {
+        QAtomicPointer<Record> next;
+        QtMsgType type;
+        qint64 msecsSinceEpoch;
+        QByteArray message;
+    };
+
+    static int levelRank(QtMsgType type);
+
+    bool dequeue(QtMsgType& type, qint64& msecsSinceEpoch, QByteArray& message);
+    void drain(bool force);
+    const QByteArray& timestampPrefix(qint64 msecsSinceEpoch);
+
+    // producers swap _head, only the draining thread touches _tail
+    QAtomicPointer<Record> _head;
+    Record* _tail;
+
+    QAtomicInt _pendingCount;
+    QAtomicInt _minimumLevel;
+    QAtomicInt _isStopping;
+    QSemaphore _wakeup;
+
+    QMutex _drainMutex;
+    QFile _file;
+    int _fileDescriptor;
+    qint64 _cachedSecond;
+    QByteArray _cachedPrefix;
+};
+
+#endif
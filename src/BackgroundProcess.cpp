@@ -6,40 +6,45 @@
 //  Copyright (c) 2014 High Fidelity. All rights reserved.
 //
 
+#include "AppDelegate.h"
 #include "BackgroundProcess.h"
 #include "GlobalData.h"
+#include "LogLifecycleManager.h"
+#include "LogUpdateScheduler.h"
+#include "ProcessSpawner.h"
+#include "Tracer.h"
 
 #include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
-#include <QStandardPaths>
 #include <QWidget>
 
 const int LOG_CHECK_INTERVAL_MS = 500;
 
+const int WAIT_FOR_CHILD_MSECS = 5000;
+
 const QString DATETIME_FORMAT = "yyyy-MM-dd_hh.mm.ss";
-const QString LOGS_DIRECTORY = "/Logs/";
+
+static int instanceCounter = 0;
 
 BackgroundProcess::BackgroundProcess(const QString& program, QObject *parent) :
     QProcess(parent),
     _program(program),
+    _spawnID(0),
+    _spawnedPID(0),
+    _startTraceMicros(0),
     _stdoutFilePos(0),
-    _stderrFilePos(0)
+    _stderrFilePos(0),
+    _startCount(0)
 {
-    _logViewer = new LogViewer;
-
     connect(this, SIGNAL(started()), SLOT(processStarted()));
-    connect(this, SIGNAL(error(QProcess::ProcessError)), SLOT(processError()));
+    connect(this, SIGNAL(error(QProcess::ProcessError)), SLOT(processError(QProcess::ProcessError)));
+    connect(this, SIGNAL(finished(int, QProcess::ExitStatus)), SLOT(processFinished()));
+
+    setLogDirectory(GlobalData::getInstance().getProcessLogsPath());
 
-    _logFilePath = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
-    _logFilePath.append(LOGS_DIRECTORY);
-    QDir logDir(_logFilePath);
-    if (!logDir.exists(_logFilePath)) {
-        logDir.mkpath(_logFilePath);
-    }
-    
     _logTimer.setInterval(LOG_CHECK_INTERVAL_MS);
     _logTimer.setSingleShot(false);
     connect(&_logTimer, SIGNAL(timeout()), this, SLOT(receivedStandardError()));
@@ -47,13 +52,57 @@ BackgroundProcess::BackgroundProcess(const QString& program, QObject *parent) :
     connect(this, SIGNAL(started()), &_logTimer, SLOT(start()));
 
     setWorkingDirectory(GlobalData::getInstance().getClientsLaunchPath());
+
+    // names this process's cgroup and log files, kept across restarts, since replicas of one
+    // program are often started in the same second
+    _instanceName = QString("%1-%2").arg(QFileInfo(_program).completeBaseName()).arg(++instanceCounter);
+}
+
+BackgroundProcess::~BackgroundProcess() {
+    if (_spawnID) {
+        stop();
+
+        // QProcess would otherwise wait on a child it never had
+        setProcessState(QProcess::NotRunning);
+    }
+}
+
+void BackgroundProcess::setLogDirectory(const QString& logDirectory) {
+    _logFilePath = logDirectory;
+
+    QDir logDir(_logFilePath);
+    if (!logDir.exists(_logFilePath)) {
+        logDir.mkpath(_logFilePath);
+    }
+}
+
+void BackgroundProcess::setupChildProcess() {
+    ProcessPlacement::applyInChild(_preparedPlacement);
+}
+
+LogViewer* BackgroundProcess::createLogViewer() {
+    if (!_logViewer) {
+        // everything captured so far is in the store, so a late viewer starts with the full history
+        _logViewer = new LogViewer;
+        _logViewer->setLogStore(&_logStore);
+        _logViewer->reload();
+    }
+
+    return _logViewer;
 }
 
 void BackgroundProcess::start(const QStringList& arguments) {
+    TraceSpan span("process", "start", QFileInfo(_program).completeBaseName());
+    _startTraceMicros = Tracer::now();
+
+    AppDelegate* app = AppDelegate::getInstance();
+    LogLifecycleManager* logLifecycleManager = app ? app->getLogLifecycleManager() : NULL;
+    releaseLogFiles();
+
+    // the start count keeps a quick restart from appending to the previous run's files
     QDateTime now = QDateTime::currentDateTime();
-    QString nowString = now.toString(DATETIME_FORMAT);
-    QFileInfo programFile(_program);
-    QString baseFilename = _logFilePath + programFile.completeBaseName();
+    QString nowString = QString("%1_%2").arg(now.toString(DATETIME_FORMAT)).arg(++_startCount);
+    QString baseFilename = _logFilePath + _instanceName;
     _stdoutFilename = QString("%1_stdout_%2.txt").arg(baseFilename, nowString);
     _stderrFilename = QString("%1_stderr_%2.txt").arg(baseFilename, nowString);
     
@@ -64,28 +113,158 @@ void BackgroundProcess::start(const QStringList& arguments) {
     _stdoutFilePos = 0;
     _stderrFilePos = 0;
     
-    // clear our LogViewer
-    _logViewer->clear();
+    // clear our captured output and LogViewer
+    _logStore.clear();
+
+    if (_logViewer) {
+        _logViewer->clear();
+
+        LogUpdateScheduler* logUpdateScheduler = app ? app->getLogUpdateScheduler() : NULL;
+        if (logUpdateScheduler) {
+            logUpdateScheduler->discard(_logViewer);
+        }
+    }
     
-    // reset our output and error files
-    setStandardOutputFile(_stdoutFilename);
-    setStandardErrorFile(_stderrFilename);
+    // append mode so the files can be truncated under the child when they are rotated
+    setStandardOutputFile(_stdoutFilename, QIODevice::Append);
+    setStandardErrorFile(_stderrFilename, QIODevice::Append);
+
+    if (logLifecycleManager) {
+        logLifecycleManager->registerActiveLog(_stdoutFilename);
+        logLifecycleManager->registerActiveLog(_stderrFilename);
+    }
     
     _lastArgList = arguments;
+
+    _preparedPlacement = ProcessPlacement::prepare(_instanceName, _limits);
+
+    ProcessSpawner* processSpawner = app ? app->getProcessSpawner() : NULL;
+    if (processSpawner && processSpawner->isAvailable() && ProcessPlacement::canApplyToProcess(_preparedPlacement)) {
+        setProcessState(QProcess::Starting);
+        _spawnID = processSpawner->spawn(this, _program, arguments, workingDirectory(),
+                                         processEnvironment().toStringList(), _stdoutFilename, _stderrFilename);
+        return;
+    }
     
     QProcess::start(_program, arguments);
 }
 
+void BackgroundProcess::stop() {
+    AppDelegate* app = AppDelegate::getInstance();
+    ProcessSpawner* processSpawner = app ? app->getProcessSpawner() : NULL;
+    if (_spawnID && processSpawner) {
+        processSpawner->terminate(_spawnID);
+        if (!processSpawner->waitForExit(_spawnID, WAIT_FOR_CHILD_MSECS)) {
+            processSpawner->kill(_spawnID);
+            processSpawner->waitForExit(_spawnID, WAIT_FOR_CHILD_MSECS);
+        }
+        return;
+    }
+
+    terminate();
+    waitForFinished(WAIT_FOR_CHILD_MSECS);
+    kill();
+}
+
+void BackgroundProcess::requestStop() {
+    AppDelegate* app = AppDelegate::getInstance();
+    ProcessSpawner* processSpawner = app ? app->getProcessSpawner() : NULL;
+    if (_spawnID && processSpawner) {
+        processSpawner->terminate(_spawnID);
+    } else {
+        terminate();
+    }
+
+    QTimer::singleShot(WAIT_FOR_CHILD_MSECS, this, SLOT(killIfRunning()));
+}
+
+void BackgroundProcess::killIfRunning() {
+    if (state() == QProcess::NotRunning) {
+        return;
+    }
+
+    AppDelegate* app = AppDelegate::getInstance();
+    ProcessSpawner* processSpawner = app ? app->getProcessSpawner() : NULL;
+    if (_spawnID && processSpawner) {
+        processSpawner->kill(_spawnID);
+    } else {
+        kill();
+    }
+}
+
+void BackgroundProcess::restart() {
+    stop();
+    start(_lastArgList);
+}
+
+qint64 BackgroundProcess::processId() const {
+    return _spawnID ? _spawnedPID : QProcess::processId();
+}
+
+void BackgroundProcess::spawnerStarted(qint64 pid) {
+    _spawnedPID = pid;
+    ProcessPlacement::applyToProcess(pid, _preparedPlacement);
+
+    setProcessState(QProcess::Running);
+
+    // started() is private to QProcess, but still reachable through the meta-object
+    QMetaObject::invokeMethod(this, "started");
+}
+
+void BackgroundProcess::spawnerFailed(const QString& reason) {
+    _spawnID = 0;
+
+    setErrorString(reason);
+    setProcessState(QProcess::NotRunning);
+    emit error(QProcess::FailedToStart);
+}
+
+void BackgroundProcess::spawnerFinished(int exitCode, bool wasCrash) {
+    _spawnID = 0;
+    _spawnedPID = 0;
+
+    // the same order QProcess reports its own children in
+    if (wasCrash) {
+        emit error(QProcess::Crashed);
+    }
+    setProcessState(QProcess::NotRunning);
+    emit finished(exitCode, wasCrash ? QProcess::CrashExit : QProcess::NormalExit);
+}
+
 void BackgroundProcess::processStarted() {
     qDebug() << "process " << _program << " started.";
+
+    // from asking for the child to it running, through the spawner or QProcess alike
+    if (Tracer::isEnabled()) {
+        Tracer::record("process", "spawn", _startTraceMicros, QFileInfo(_program).completeBaseName());
+    }
 }
 
-void BackgroundProcess::processError() {
+void BackgroundProcess::processError(QProcess::ProcessError errorType) {
     qDebug() << "process error for" << _program << "-" << errorString();
+
+    if (errorType == QProcess::FailedToStart) {
+        releaseLogFiles();
+    }
+}
+
+void BackgroundProcess::processFinished() {
+    // nothing writes to the files any more, so they can be expired like any other
+    releaseLogFiles();
+}
+
+void BackgroundProcess::releaseLogFiles() {
+    AppDelegate* app = AppDelegate::getInstance();
+    LogLifecycleManager* logLifecycleManager = app ? app->getLogLifecycleManager() : NULL;
+    if (logLifecycleManager && !_stdoutFilename.isEmpty()) {
+        logLifecycleManager->releaseActiveLog(_stdoutFilename);
+        logLifecycleManager->releaseActiveLog(_stderrFilename);
+    }
 }
 
 void BackgroundProcess::receivedStandardOutput() {
-    QString output;
+    AppDelegate* app = AppDelegate::getInstance();
+    QByteArray output;
 
     QFile file(_stdoutFilename);
 
@@ -99,13 +278,27 @@ void BackgroundProcess::receivedStandardOutput() {
 
     file.close();
 
-    if (!output.isEmpty() && !output.isNull()) {
-        _logViewer->appendStandardOutput(output);
+    if (!output.isEmpty()) {
+        _logStore.append(LogStreamStandardOutput, output.constData(), output.size());
+
+        // until someone opens these logs the store is the only copy
+        LogUpdateScheduler* logUpdateScheduler = app ? app->getLogUpdateScheduler() : NULL;
+        if (_logViewer && logUpdateScheduler) {
+            logUpdateScheduler->queue(_logViewer, LogStreamStandardOutput, QString::fromUtf8(output));
+        } else if (_logViewer) {
+            _logViewer->appendStandardOutput(QString::fromUtf8(output));
+        }
+    }
+
+    LogLifecycleManager* logLifecycleManager = app ? app->getLogLifecycleManager() : NULL;
+    if (logLifecycleManager && logLifecycleManager->rotateIfNeeded(_stdoutFilename)) {
+        _stdoutFilePos = 0;
     }
 }
 
 void BackgroundProcess::receivedStandardError() {
-    QString output;
+    AppDelegate* app = AppDelegate::getInstance();
+    QByteArray output;
 
     QFile file(_stderrFilename);
 
@@ -119,7 +312,20 @@ void BackgroundProcess::receivedStandardError() {
 
     file.close();
 
-    if (!output.isEmpty() && !output.isNull()) {
-        _logViewer->appendStandardError(output);
+    if (!output.isEmpty()) {
+        _logStore.append(LogStreamStandardError, output.constData(), output.size());
+
+        // until someone opens these logs the store is the only copy
+        LogUpdateScheduler* logUpdateScheduler = app ? app->getLogUpdateScheduler() : NULL;
+        if (_logViewer && logUpdateScheduler) {
+            logUpdateScheduler->queue(_logViewer, LogStreamStandardError, QString::fromUtf8(output));
+        } else if (_logViewer) {
+            _logViewer->appendStandardError(QString::fromUtf8(output));
+        }
+    }
+
+    LogLifecycleManager* logLifecycleManager = app ? app->getLogLifecycleManager() : NULL;
+    if (logLifecycleManager && logLifecycleManager->rotateIfNeeded(_stderrFilename)) {
+        _stderrFilePos = 0;
     }
 }
@@ -9,40 +9,84 @@
 #ifndef hifi_BackgroundProcess_h
 #define hifi_BackgroundProcess_h
 
+#include "LogStore.h"
 #include "LogViewer.h"
+#include "ProcessPlacement.h"
 
+#include <QPointer>
 #include <QProcess>
 #include <QString>
 #include <QTimer>
+#include <QVector>
 
 class BackgroundProcess : public QProcess
 {
     Q_OBJECT
 public:
     BackgroundProcess(const QString& program, QObject* parent = 0);
+    ~BackgroundProcess();
 
+    // NULL until someone opens this process's logs
     LogViewer* getLogViewer() { return _logViewer; }
+    LogViewer* createLogViewer();
+    const LogStore& getLogStore() const { return _logStore; }
     
     const QStringList& getLastArgList() const { return _lastArgList; }
+
+    void setLogDirectory(const QString& logDirectory);
+
+    // applied to the child when it starts
+    void setLimits(const ProcessLimits& limits) { _limits = limits; }
+    const ProcessLimits& getLimits() const { return _limits; }
+    void setCpuSet(const QVector<int>& cpuSet) { _limits.cpuSet = cpuSet; }
+    const QVector<int>& getCpuSet() const { return _limits.cpuSet; }
     
     void start(const QStringList& arguments);
+    void stop();
+    void restart();
+
+    // asks the child to exit without waiting for it, and kills it if it is still around after a
+    // grace period; finished() says when it is gone
+    void requestStop();
+
+    // hides QProcess::processId, which knows nothing of children the spawner helper started
+    qint64 processId() const;
+
+protected:
+    void setupChildProcess();
 
 private slots:
     void processStarted();
-    void processError();
+    void processError(QProcess::ProcessError errorType);
+    void processFinished();
+    void killIfRunning();
     void receivedStandardOutput();
     void receivedStandardError();
 
 private:
+    friend class ProcessSpawner;
+    void spawnerStarted(qint64 pid);
+    void spawnerFailed(const QString& reason);
+    void spawnerFinished(int exitCode, bool wasCrash);
+    void releaseLogFiles();
+
     QString _program;
     QStringList _lastArgList;
     QString _logFilePath;
-    LogViewer* _logViewer;
+    ProcessLimits _limits;
+    QString _instanceName;
+    PreparedPlacement _preparedPlacement;
+    quint32 _spawnID; // non-zero while the spawner helper has a child for us
+    qint64 _spawnedPID;
+    qint64 _startTraceMicros;
+    LogStore _logStore;
+    QPointer<LogViewer> _logViewer;
     QTimer _logTimer;
     QString _stdoutFilename;
     QString _stderrFilename;
     qint64 _stdoutFilePos;
     qint64 _stderrFilePos;
+    int _startCount;
 };
 
 #endif
@@ -0,0 +1,106 @@
+//
+//  DomainNameCache.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "DomainNameCache.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+const qint64 NAME_TTL_MSECS = 24 * 60 * 60 * 1000;
+
+// names nobody asked about in this long are dropped when the cache is saved
+const qint64 MAX_ENTRY_AGE_MSECS = 30 * NAME_TTL_MSECS;
+
+const QString LAST_DOMAIN_ID_KEY = "lastDomainID";
+const QString DOMAINS_KEY = "domains";
+const QString ENTRY_NAME_KEY = "name";
+const QString ENTRY_RESOLVED_AT_KEY = "resolvedAt";
+
+DomainNameCache::DomainNameCache(const QString& path) :
+    _path(path)
+{
+    QFile cacheFile(_path);
+    if (!cacheFile.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QJsonObject cache = QJsonDocument::fromJson(cacheFile.readAll()).object();
+    _lastDomainID = cache[LAST_DOMAIN_ID_KEY].toString();
+
+    QJsonObject domains = cache[DOMAINS_KEY].toObject();
+    for (QJsonObject::const_iterator it = domains.constBegin(); it != domains.constEnd(); ++it) {
+        QJsonObject entryObject = it.value().toObject();
+
+        Entry entry;
+        entry.name = entryObject[ENTRY_NAME_KEY].toString();
+        entry.resolvedAt = qint64(entryObject[ENTRY_RESOLVED_AT_KEY].toDouble());
+
+        if (!entry.name.isEmpty()) {
+            _entries.insert(it.key(), entry);
+        }
+    }
+}
+
+DomainNameCache::Freshness DomainNameCache::lookup(const QString& domainID, QString& name) const {
+    QHash<QString, Entry>::const_iterator it = _entries.constFind(domainID);
+    if (it == _entries.constEnd()) {
+        return Missing;
+    }
+
+    name = it.value().name;
+    return QDateTime::currentMSecsSinceEpoch() - it.value().resolvedAt < NAME_TTL_MSECS ? Fresh : Stale;
+}
+
+void DomainNameCache::store(const QString& domainID, const QString& name) {
+    Entry entry;
+    entry.name = name;
+    entry.resolvedAt = QDateTime::currentMSecsSinceEpoch();
+    _entries.insert(domainID, entry);
+
+    save();
+}
+
+void DomainNameCache::setLastDomainID(const QString& domainID) {
+    if (domainID != _lastDomainID) {
+        _lastDomainID = domainID;
+        save();
+    }
+}
+
+void DomainNameCache::save() const {
+    qint64 oldestKept = QDateTime::currentMSecsSinceEpoch() - MAX_ENTRY_AGE_MSECS;
+
+    QJsonObject domains;
+    for (QHash<QString, Entry>::const_iterator it = _entries.constBegin(); it != _entries.constEnd(); ++it) {
+        if (it.value().resolvedAt < oldestKept && it.key() != _lastDomainID) {
+            continue;
+        }
+
+        QJsonObject entryObject;
+        entryObject[ENTRY_NAME_KEY] = it.value().name;
+        entryObject[ENTRY_RESOLVED_AT_KEY] = double(it.value().resolvedAt);
+        domains[it.key()] = entryObject;
+    }
+
+    QJsonObject cache;
+    cache[LAST_DOMAIN_ID_KEY] = _lastDomainID;
+    cache[DOMAINS_KEY] = domains;
+
+    QDir().mkpath(QFileInfo(_path).absolutePath());
+
+    // written aside and renamed over, so a crash mid-save keeps the old cache
+    QSaveFile cacheFile(_path);
+    if (cacheFile.open(QIODevice::WriteOnly)) {
+        cacheFile.write(QJsonDocument(cache).toJson(QJsonDocument::Compact));
+        cacheFile.commit();
+    }
+}
@@ -0,0 +1,49 @@
+//
+//  DomainNameCache.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_DomainNameCache_h
+#define hifi_DomainNameCache_h
+
+#include <QHash>
+#include <QString>
+
+// What the metaverse API last said each domain ID is called, kept on disk so the address is
+// right as soon as the Stack Manager starts. A name older than the TTL is still handed out
+// but reported stale, so the caller shows it while it asks again, and keeps showing it if
+// asking fails.
+class DomainNameCache
+{
+public:
+    enum Freshness {
+        Missing = 0,
+        Stale,
+        Fresh
+    };
+
+    explicit DomainNameCache(const QString& path);
+
+    Freshness lookup(const QString& domainID, QString& name) const;
+    void store(const QString& domainID, const QString& name);
+
+    // this host's domain-server, remembered so its name can be shown before it answers /id
+    const QString& getLastDomainID() const { return _lastDomainID; }
+    void setLastDomainID(const QString& domainID);
+
+private:
+    struct Entry {
+        QString name;
+        qint64 resolvedAt; // msecs since epoch
+    };
+
+    void save() const;
+
+    QString _path;
+    QString _lastDomainID;
+    QHash<QString, Entry> _entries;
+};
+
+#endif
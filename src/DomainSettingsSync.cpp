@@ -0,0 +1,241 @@
+//
+//  DomainSettingsSync.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "DomainSettingsSync.h"
+
+#include <QDebug>
+#include <QJsonDocument>
+#include <QNetworkRequest>
+
+#include "GlobalData.h"
+#include "HttpClient.h"
+
+const QString SETTINGS_PATH = "/settings.json";
+const QString SETTINGS_VALUES_KEY = "values";
+
+const HttpRequestPolicy FETCH_REQUEST_POLICY(5 * 1000, 3);
+const HttpRequestPolicy POST_REQUEST_POLICY(10 * 1000);
+
+static QJsonValue valueAt(const QJsonObject& object, const QStringList& keyPath) {
+    QJsonValue value = object;
+    foreach(const QString& key, keyPath) {
+        value = value.toObject().value(key);
+    }
+    return value;
+}
+
+static void setValueAt(QJsonObject& object, const QStringList& keyPath, int depth, const QJsonValue& value) {
+    const QString& key = keyPath[depth];
+
+    if (depth == keyPath.size() - 1) {
+        object[key] = value;
+        return;
+    }
+
+    QJsonObject child = object[key].toObject();
+    setValueAt(child, keyPath, depth + 1, value);
+    object[key] = child;
+}
+
+DomainSettingsSync::DomainSettingsSync(HttpClient* httpClient, QObject* parent) :
+    QObject(parent),
+    _httpClient(httpClient),
+    _hasSettings(false),
+    _version(0),
+    _isFetching(false),
+    _isPosting(false),
+    _isReconciling(false)
+{
+    _coalesceTimer.setSingleShot(true);
+    _coalesceTimer.setInterval(COALESCE_WINDOW_MS);
+    connect(&_coalesceTimer, &QTimer::timeout, this, &DomainSettingsSync::flush);
+}
+
+QJsonValue DomainSettingsSync::getValue(const QStringList& keyPath) const {
+    return valueAt(_settings, keyPath);
+}
+
+void DomainSettingsSync::setValue(const QStringList& keyPath, const QJsonValue& value) {
+    Q_ASSERT(!keyPath.isEmpty());
+
+    Change change;
+    change.keyPath = keyPath;
+    change.value = value;
+    queueChange(change, true);
+
+    scheduleFlush();
+}
+
+void DomainSettingsSync::queueChange(const Change& change, bool replacesQueued) {
+    for (int i = 0; i < _pendingChanges.size(); ++i) {
+        if (_pendingChanges[i].keyPath == change.keyPath) {
+            if (replacesQueued) {
+                _pendingChanges[i].value = change.value;
+            }
+            return;
+        }
+    }
+
+    _pendingChanges << change;
+}
+
+void DomainSettingsSync::scheduleFlush() {
+    // not restarted by later changes, so a steady stream still goes out once per window
+    if (!_pendingChanges.isEmpty() && !_coalesceTimer.isActive()) {
+        _coalesceTimer.start();
+    }
+}
+
+void DomainSettingsSync::refresh() {
+    if (!_isFetching) {
+        fetch();
+    }
+}
+
+void DomainSettingsSync::invalidate() {
+    _hasSettings = false;
+}
+
+void DomainSettingsSync::flush() {
+    if (_pendingChanges.isEmpty() || _isFetching || _isPosting) {
+        // whatever is in flight picks the changes up when it finishes
+        return;
+    }
+
+    // a diff against the cache can only be trusted to send too much, never too little
+    bool isUnchangedInCache = false;
+    foreach(const Change& change, _pendingChanges) {
+        if (valueAt(_settings, change.keyPath) == change.value) {
+            isUnchangedInCache = true;
+            break;
+        }
+    }
+
+    if (!_hasSettings || _settingsAge.elapsed() > MAX_SETTINGS_AGE_MS || isUnchangedInCache) {
+        fetch();
+    } else {
+        postPendingChanges();
+    }
+}
+
+void DomainSettingsSync::fetch() {
+    _isFetching = true;
+
+    QNetworkRequest request(QUrl(GlobalData::getInstance().getDomainServerBaseUrl() + SETTINGS_PATH));
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+
+    HttpRequest* fetchRequest = _httpClient->get(request, FETCH_REQUEST_POLICY);
+    connect(fetchRequest, &HttpRequest::finished, this, &DomainSettingsSync::handleFetchReply);
+}
+
+void DomainSettingsSync::handleFetchReply() {
+    HttpRequest* request = qobject_cast<HttpRequest*>(sender());
+    _isFetching = false;
+
+    QJsonObject root = QJsonDocument::fromJson(request->getBody()).object();
+
+    if (!request->isSuccess() || root.isEmpty()) {
+        qDebug() << "Could not fetch domain-server settings -" << request->getErrorString();
+
+        finishChanges(_pendingChanges, false);
+        _pendingChanges.clear();
+        _isReconciling = false;
+        return;
+    }
+
+    // newer domain-servers wrap the values next to their descriptions
+    QJsonObject settings = root.contains(SETTINGS_VALUES_KEY) ? root[SETTINGS_VALUES_KEY].toObject() : root;
+
+    if (!_hasSettings || settings != _settings) {
+        _settings = settings;
+        ++_version;
+        emit settingsChanged(_version);
+    }
+
+    _hasSettings = true;
+    _settingsAge.start();
+
+    if (!_pendingChanges.isEmpty()) {
+        postPendingChanges();
+    }
+}
+
+void DomainSettingsSync::postPendingChanges() {
+    QJsonObject diff;
+    QList<Change> unchanged;
+
+    foreach(const Change& change, _pendingChanges) {
+        if (valueAt(_settings, change.keyPath) == change.value) {
+            unchanged << change;
+        } else {
+            setValueAt(diff, change.keyPath, 0, change.value);
+            _postedChanges << change;
+        }
+    }
+    _pendingChanges.clear();
+
+    finishChanges(unchanged, true);
+
+    if (_postedChanges.isEmpty()) {
+        _isReconciling = false;
+        return;
+    }
+
+    qDebug() << "Sending" << _postedChanges.size() << "domain-server setting changes.";
+
+    QNetworkRequest request(QUrl(GlobalData::getInstance().getDomainServerBaseUrl() + SETTINGS_PATH));
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+
+    _isPosting = true;
+    HttpRequest* postRequest = _httpClient->post(request, QJsonDocument(diff).toJson(QJsonDocument::Compact),
+                                                 POST_REQUEST_POLICY);
+    connect(postRequest, &HttpRequest::finished, this, &DomainSettingsSync::handlePostReply);
+}
+
+void DomainSettingsSync::handlePostReply() {
+    HttpRequest* request = qobject_cast<HttpRequest*>(sender());
+    _isPosting = false;
+
+    QList<Change> postedChanges = _postedChanges;
+    _postedChanges.clear();
+
+    if (request->isSuccess()) {
+        foreach(const Change& change, postedChanges) {
+            setValueAt(_settings, change.keyPath, 0, change.value);
+        }
+        ++_version;
+        emit settingsChanged(_version);
+
+        _isReconciling = false;
+        finishChanges(postedChanges, true);
+    } else if (!_isReconciling) {
+        // our copy may be out of date, get the current settings and diff against those instead
+        qDebug() << "Domain-server rejected setting changes -" << request->getErrorString() << "- reconciling.";
+        _isReconciling = true;
+
+        // anything set since then is newer than what we posted
+        foreach(const Change& change, postedChanges) {
+            queueChange(change, false);
+        }
+
+        fetch();
+        return;
+    } else {
+        qDebug() << "Could not change domain-server settings -" << request->getErrorString();
+
+        _isReconciling = false;
+        finishChanges(postedChanges, false);
+    }
+
+    scheduleFlush();
+}
+
+void DomainSettingsSync::finishChanges(const QList<Change>& changes, bool success) {
+    foreach(const Change& change, changes) {
+        emit valueSynced(change.keyPath, success);
+    }
+}
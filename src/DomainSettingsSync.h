@@ -0,0 +1,87 @@
+//
+//  DomainSettingsSync.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_DomainSettingsSync_h
+#define hifi_DomainSettingsSync_h
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+class HttpClient;
+
+// Keeps a cached copy of the domain-server's settings.json and writes changes back as minimal
+// diffs. Changes requested within COALESCE_WINDOW_MS of each other go out as one POST holding
+// only the keys that differ from the settings, which the domain-server merges into its own, so
+// nothing else is clobbered.
+//
+// The cache carries a version that moves whenever its contents do. It is refetched before a
+// write once it is older than MAX_SETTINGS_AGE_MS, and before any key is taken to already hold
+// the requested value, since the domain-server's web UI may have changed it since the cache was
+// filled. A write the domain-server rejects is reconciled by refetching and diffing again once
+// before it is reported as failed.
+class DomainSettingsSync : public QObject
+{
+    Q_OBJECT
+public:
+    static const int COALESCE_WINDOW_MS = 250;
+    static const int MAX_SETTINGS_AGE_MS = 30 * 1000;
+
+    DomainSettingsSync(HttpClient* httpClient, QObject* parent = 0);
+
+    void setValue(const QStringList& keyPath, const QJsonValue& value);
+
+    bool hasSettings() const { return _hasSettings; }
+    const QJsonObject& getSettings() const { return _settings; }
+    QJsonValue getValue(const QStringList& keyPath) const;
+    int getVersion() const { return _version; }
+
+public slots:
+    void refresh();
+    void invalidate();
+    void flush();
+
+signals:
+    void settingsChanged(int version);
+    void valueSynced(const QStringList& keyPath, bool success);
+
+private slots:
+    void handleFetchReply();
+    void handlePostReply();
+
+private:
+    struct Change {
+        QStringList keyPath;
+        QJsonValue value;
+    };
+
+    void fetch();
+    void postPendingChanges();
+    void queueChange(const Change& change, bool replacesQueued);
+    void finishChanges(const QList<Change>& changes, bool success);
+    void scheduleFlush();
+
+    HttpClient* _httpClient;
+
+    QJsonObject _settings;
+    bool _hasSettings;
+    int _version;
+    QElapsedTimer _settingsAge;
+
+    QList<Change> _pendingChanges;
+    QList<Change> _postedChanges;
+    QTimer _coalesceTimer;
+    bool _isFetching;
+    bool _isPosting;
+    bool _isReconciling;
+};
+
+#endif
@@ -0,0 +1,159 @@
+//
+//  DomainStatsPoller.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "DomainStatsPoller.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkRequest>
+
+#include "GlobalData.h"
+#include "HttpClient.h"
+
+const int DEFAULT_POLL_INTERVAL_MS = 5000;
+const int POLL_REQUEST_TIMEOUT_MS = 4000;
+
+const QString NODES_PATH = "/nodes.json";
+const QString ASSIGNMENTS_PATH = "/assignments.json";
+
+const QString NODES_KEY = "nodes";
+const QString NODE_TYPE_KEY = "type";
+const QString NODE_INBOUND_KBPS_KEY = "inbound_kbps";
+const QString NODE_OUTBOUND_KBPS_KEY = "outbound_kbps";
+const QString QUEUED_ASSIGNMENTS_KEY = "queued";
+const QString FULFILLED_ASSIGNMENTS_KEY = "fulfilled";
+
+DomainStatsPoller::DomainStatsPoller(HttpClient* httpClient, QObject* parent) :
+    QObject(parent),
+    _httpClient(httpClient),
+    _isPolling(false),
+    _lastPollFailed(false),
+    _samples(HISTORY_SAMPLES),
+    _firstSample(0),
+    _sampleCount(0)
+{
+    _pollTimer.setInterval(DEFAULT_POLL_INTERVAL_MS);
+    connect(&_pollTimer, &QTimer::timeout, this, &DomainStatsPoller::poll);
+}
+
+const DomainStatsSample& DomainStatsPoller::getSample(int index) const {
+    return _samples[(_firstSample + index) % HISTORY_SAMPLES];
+}
+
+void DomainStatsPoller::start() {
+    _pollTimer.start();
+    poll();
+}
+
+void DomainStatsPoller::stop() {
+    _pollTimer.stop();
+}
+
+HttpRequest* DomainStatsPoller::get(const QString& path) {
+    QString baseUrl = _baseUrl.isEmpty() ? GlobalData::getInstance().getDomainServerBaseUrl() : _baseUrl;
+
+    QNetworkRequest request(QUrl(baseUrl + path));
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+
+    return _httpClient->get(request, HttpRequestPolicy(qMin(POLL_REQUEST_TIMEOUT_MS, getInterval())));
+}
+
+void DomainStatsPoller::poll() {
+    if (_isPolling) {
+        return;
+    }
+    _isPolling = true;
+    _pollDuration.start();
+
+    HttpRequest* request = get(NODES_PATH);
+    connect(request, &HttpRequest::finished, this, &DomainStatsPoller::handleNodesReply);
+}
+
+void DomainStatsPoller::pollFailed(HttpRequest* request) {
+    // the domain-server is often still starting up, only say so when it changes
+    if (!_lastPollFailed) {
+        qDebug() << "Domain-server stats unavailable from" << request->getUrl().toString() << "-" << request->getErrorString();
+        _lastPollFailed = true;
+    }
+    _isPolling = false;
+}
+
+int DomainStatsPoller::nodeTypeIndex(const QString& type) {
+    int index = _nodeTypes.indexOf(type);
+    if (index < 0) {
+        index = _nodeTypes.size();
+        _nodeTypes << type;
+    }
+    return index;
+}
+
+void DomainStatsPoller::handleNodesReply() {
+    HttpRequest* request = static_cast<HttpRequest*>(sender());
+
+    if (!request->isSuccess()) {
+        pollFailed(request);
+        return;
+    }
+
+    QJsonArray nodes = QJsonDocument::fromJson(request->getBody()).object()[NODES_KEY].toArray();
+
+    _pendingSample = DomainStatsSample();
+    _pendingSample.nodeCount = nodes.size();
+
+    foreach(const QJsonValue& value, nodes) {
+        QJsonObject node = value.toObject();
+        int type = nodeTypeIndex(node[NODE_TYPE_KEY].toString("unknown"));
+
+        if (_pendingSample.nodesByType.size() <= type) {
+            _pendingSample.nodesByType.resize(_nodeTypes.size());
+            _pendingSample.inboundKbpsByType.resize(_nodeTypes.size());
+            _pendingSample.outboundKbpsByType.resize(_nodeTypes.size());
+        }
+
+        ++_pendingSample.nodesByType[type];
+        _pendingSample.hasBandwidth |= node.contains(NODE_INBOUND_KBPS_KEY) || node.contains(NODE_OUTBOUND_KBPS_KEY);
+        _pendingSample.inboundKbpsByType[type] += node[NODE_INBOUND_KBPS_KEY].toDouble();
+        _pendingSample.outboundKbpsByType[type] += node[NODE_OUTBOUND_KBPS_KEY].toDouble();
+    }
+
+    HttpRequest* assignmentsRequest = get(ASSIGNMENTS_PATH);
+    connect(assignmentsRequest, &HttpRequest::finished, this, &DomainStatsPoller::handleAssignmentsReply);
+}
+
+void DomainStatsPoller::handleAssignmentsReply() {
+    HttpRequest* request = static_cast<HttpRequest*>(sender());
+
+    if (!request->isSuccess()) {
+        pollFailed(request);
+        return;
+    }
+
+    QJsonObject assignments = QJsonDocument::fromJson(request->getBody()).object();
+    _pendingSample.pendingAssignments = assignments[QUEUED_ASSIGNMENTS_KEY].toObject().size();
+    _pendingSample.fulfilledAssignments = assignments[FULFILLED_ASSIGNMENTS_KEY].toObject().size();
+    _pendingSample.timestamp = QDateTime::currentMSecsSinceEpoch();
+
+    if (_sampleCount < HISTORY_SAMPLES) {
+        _samples[(_firstSample + _sampleCount) % HISTORY_SAMPLES] = _pendingSample;
+        ++_sampleCount;
+    } else {
+        // full, so the oldest slot takes the new sample
+        _samples[_firstSample] = _pendingSample;
+        _firstSample = (_firstSample + 1) % HISTORY_SAMPLES;
+    }
+
+    if (_lastPollFailed) {
+        qDebug() << "Domain-server stats available again, polls take" << _pollDuration.elapsed() << "ms";
+        _lastPollFailed = false;
+    }
+    _isPolling = false;
+
+    emit sampled();
+}
@@ -0,0 +1,91 @@
+//
+//  DomainStatsPoller.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_DomainStatsPoller_h
+#define hifi_DomainStatsPoller_h
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+class HttpClient;
+class HttpRequest;
+
+struct DomainStatsSample {
+    DomainStatsSample() : timestamp(0), nodeCount(0), pendingAssignments(0), fulfilledAssignments(0),
+        hasBandwidth(false) {}
+
+    qint64 timestamp;
+    int nodeCount;
+    int pendingAssignments;
+    int fulfilledAssignments;
+    bool hasBandwidth; // whether any node reported its kbps, domain-servers that don't leave these at 0
+
+    // indexed like DomainStatsPoller::getNodeTypes(), older samples can be shorter
+    QVector<int> nodesByType;
+    QVector<double> inboundKbpsByType;
+    QVector<double> outboundKbpsByType;
+};
+
+// Polls the domain-server's local HTTP API for /nodes.json and /assignments.json and keeps the
+// last HISTORY_SAMPLES results in a ring. The two requests go one after the other over the
+// shared HttpClient, so a poll reuses one keep-alive connection, and a tick is skipped while the
+// previous poll is still out. A request that misses its deadline fails the poll, the next tick
+// is the retry. Bandwidth comes from the inbound_kbps and outbound_kbps a node entry carries,
+// which not every domain-server sends; hasBandwidth tells a quiet domain from one that doesn't say.
+class DomainStatsPoller : public QObject
+{
+    Q_OBJECT
+public:
+    static const int HISTORY_SAMPLES = 300;
+
+    DomainStatsPoller(HttpClient* httpClient, QObject* parent = 0);
+
+    // empty follows GlobalData's domain-server address, set it to poll a stand-in instead
+    void setBaseUrl(const QString& baseUrl) { _baseUrl = baseUrl; }
+    void setInterval(int msecs) { _pollTimer.setInterval(msecs); }
+    int getInterval() const { return _pollTimer.interval(); }
+
+    const QStringList& getNodeTypes() const { return _nodeTypes; }
+    int getSampleCount() const { return _sampleCount; }
+    const DomainStatsSample& getSample(int index) const; // 0 is the oldest
+    const DomainStatsSample& getLatestSample() const { return getSample(_sampleCount - 1); }
+
+public slots:
+    void start();
+    void stop();
+    void poll();
+
+signals:
+    void sampled();
+
+private slots:
+    void handleNodesReply();
+    void handleAssignmentsReply();
+
+private:
+    HttpRequest* get(const QString& path);
+    void pollFailed(HttpRequest* request);
+    int nodeTypeIndex(const QString& type);
+
+    HttpClient* _httpClient;
+    QString _baseUrl;
+    QTimer _pollTimer;
+    QElapsedTimer _pollDuration;
+    bool _isPolling;
+    bool _lastPollFailed;
+
+    QStringList _nodeTypes;
+    DomainStatsSample _pendingSample;
+    QVector<DomainStatsSample> _samples;
+    int _firstSample;
+    int _sampleCount;
+};
+
+#endif
@@ -22,9 +22,9 @@
 #include <QMessageBox>
 #include <QApplication>
 
-DownloadManager::DownloadManager(QNetworkAccessManager* manager, QWidget* parent) :
+DownloadManager::DownloadManager(HttpClient* httpClient, QWidget* parent) :
     QWidget(parent),
-    _manager(manager)
+    _httpClient(httpClient)
 {
     setBaseSize(500, 250);
 
@@ -69,7 +69,7 @@ void DownloadManager::downloadFile(const QUrl& url) {
     connect(downloader, SIGNAL(installingFiles(QUrl)), SLOT(onInstallingFiles(QUrl)));
     connect(downloader, SIGNAL(filesSuccessfullyInstalled(QUrl)), SLOT(onFilesSuccessfullyInstalled(QUrl)));
     connect(downloader, SIGNAL(filesInstallationFailed(QUrl)), SLOT(onFilesInstallationFailed(QUrl)));
-    downloader->start(_manager);
+    downloader->start(_httpClient);
 }
 
 void DownloadManager::onDownloadStarted(Downloader* downloader, const QUrl& url) {
@@ -13,14 +13,15 @@
 #include <QTableWidget>
 #include <QHash>
 #include <QEvent>
-#include <QNetworkAccessManager>
 
 #include "Downloader.h"
 
+class HttpClient;
+
 class DownloadManager : public QWidget {
     Q_OBJECT
 public:
-    DownloadManager(QNetworkAccessManager* manager, QWidget* parent = 0);
+    DownloadManager(HttpClient* httpClient, QWidget* parent = 0);
     ~DownloadManager();
 
     void downloadFile(const QUrl& url);
@@ -42,7 +43,7 @@ signals:
 
 private:
     QTableWidget* _table;
-    QNetworkAccessManager* _manager;
+    HttpClient* _httpClient;
     QHash<Downloader*, int> _downloaderHash;
 
     int downloaderRowIndexForUrl(const QUrl& url);
@@ -8,6 +8,9 @@
 
 #include "Downloader.h"
 #include "GlobalData.h"
+#include "HttpClient.h"
+#include "MetricsRegistry.h"
+#include "Tracer.h"
 
 #include <quazip.h>
 #include <quazipfile.h>
@@ -18,44 +21,54 @@
 #include <QDir>
 #include <QDebug>
 
+const int DOWNLOAD_ATTEMPTS = 3;
+const int DOWNLOAD_STALL_TIMEOUT_MS = 60 * 1000;
+
 Downloader::Downloader(const QUrl& url, QObject* parent) :
     QObject(parent)
 {
     _url = url;
 }
 
-void Downloader::start(QNetworkAccessManager* manager) {
+void Downloader::start(HttpClient* httpClient) {
     qDebug() << "Downloader::start() for URL - " << _url;
-    QNetworkRequest req(_url);
-    QNetworkReply* reply = manager->get(req);
-    emit downloadStarted(this, _url);
-    connect(reply, SIGNAL(error(QNetworkReply::NetworkError)), SLOT(error(QNetworkReply::NetworkError)));
-    connect(reply, SIGNAL(downloadProgress(qint64,qint64)), SLOT(downloadProgress(qint64,qint64)));
-    connect(reply, SIGNAL(finished()), SLOT(downloadFinished()));
-}
 
-void Downloader::error(QNetworkReply::NetworkError error) {
-    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
-    qDebug() << reply->errorString();
-    reply->deleteLater();
+    // big archives can take a while, only give up on a download that stops moving
+    HttpRequestPolicy policy(0, DOWNLOAD_ATTEMPTS);
+    policy.stallTimeoutMSecs = DOWNLOAD_STALL_TIMEOUT_MS;
+
+    _downloadTimer.start();
+    HttpRequest* request = httpClient->get(QNetworkRequest(_url), policy);
+    emit downloadStarted(this, _url);
+    connect(request, SIGNAL(downloadProgress(qint64,qint64)), SLOT(downloadProgress(qint64,qint64)));
+    connect(request, SIGNAL(finished()), SLOT(downloadFinished()));
 }
 
 void Downloader::downloadProgress(qint64 bytesReceived, qint64 bytesTotal) {
-    int percentage = bytesReceived*100/bytesTotal;
-    emit downloadProgress(_url, percentage);
+    if (bytesTotal > 0) {
+        int percentage = bytesReceived*100/bytesTotal;
+        emit downloadProgress(_url, percentage);
+    }
 }
 
 void Downloader::downloadFinished() {
     qDebug() << "Downloader::downloadFinished() for URL - " << _url;
-    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
-    if (reply->error() != QNetworkReply::NoError) {
-        qDebug() << reply->errorString();
+    HttpRequest* request = qobject_cast<HttpRequest*>(sender());
+    recordDownload(request->isSuccess(), request->getBody().size());
+
+    if (!request->isSuccess()) {
+        qDebug() << request->getErrorString();
         emit downloadFailed(_url);
         return;
     }
     emit downloadCompleted(_url);
 
     QString fileName = QFileInfo(_url.toString()).fileName();
+    TraceSpan span("download", "install", fileName);
+
+    QElapsedTimer installTimer;
+    installTimer.start();
+
     QString fileDir = GlobalData::getInstance().getClientsLaunchPath();
     QString filePath = fileDir + fileName;
 
@@ -74,7 +87,7 @@ void Downloader::downloadFinished() {
             file.setPermissions(QFile::ReadOwner | QFile::WriteOwner);
         }
         emit installingFiles(_url);
-        file.write(reply->readAll());
+        file.write(request->getBody());
         bool error = false;
         file.close();
 
@@ -121,13 +134,38 @@ void Downloader::downloadFinished() {
                 qDebug() << "Could not open zip file for extraction.";
             }
         }
+        recordInstall(!error, installTimer.elapsed());
         if (!error)
             emit filesSuccessfullyInstalled(_url);
     } else {
+        recordInstall(false, installTimer.elapsed());
         emit filesInstallationFailed(_url);
         qDebug() << "Could not open file: " << filePath;
     }
-    reply->deleteLater();
+}
+
+void Downloader::recordDownload(bool success, qint64 bytes) {
+    MetricsRegistry& registry = MetricsRegistry::getInstance();
+
+    registry.add(registry.registerSeries(MetricsRegistry::Counter, "stack_manager_downloads",
+                                         "Downloads of binaries and archives.",
+                                         QStringList() << "result" << (success ? "completed" : "failed")));
+    registry.add(registry.registerSeries(MetricsRegistry::Counter, "stack_manager_download_seconds",
+                                         "Time spent downloading binaries and archives.", QStringList(),
+                                         MetricsRegistry::MSECS_SCALE, "seconds"), _downloadTimer.elapsed());
+    registry.add(registry.registerSeries(MetricsRegistry::Counter, "stack_manager_download_bytes",
+                                         "Bytes of binaries and archives downloaded.", QStringList(), 1, "bytes"), bytes);
+}
+
+void Downloader::recordInstall(bool success, qint64 msecs) {
+    MetricsRegistry& registry = MetricsRegistry::getInstance();
+
+    registry.add(registry.registerSeries(MetricsRegistry::Counter, "stack_manager_installs",
+                                         "Downloads written out and, for archives, extracted.",
+                                         QStringList() << "result" << (success ? "installed" : "failed")));
+    registry.add(registry.registerSeries(MetricsRegistry::Counter, "stack_manager_install_seconds",
+                                         "Time spent writing out and extracting downloads.", QStringList(),
+                                         MetricsRegistry::MSECS_SCALE, "seconds"), msecs);
 }
 
 
@@ -9,10 +9,11 @@
 #ifndef hifi_Downloader_h
 #define hifi_Downloader_h
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QUrl>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
+
+class HttpClient;
 
 class Downloader : public QObject
 {
@@ -22,10 +23,9 @@ public:
 
     const QUrl& getUrl() { return _url; }
 
-    void start(QNetworkAccessManager* manager);
+    void start(HttpClient* httpClient);
 
 private slots:
-    void error(QNetworkReply::NetworkError error);
     void downloadProgress(qint64 bytesReceived, qint64 bytesTotal);
     void downloadFinished();
 
@@ -39,7 +39,11 @@ signals:
     void filesInstallationFailed(const QUrl& url);
 
 private:
+    void recordDownload(bool success, qint64 bytes);
+    void recordInstall(bool success, qint64 msecs);
+
     QUrl _url;
+    QElapsedTimer _downloadTimer;
 };
 
 #endif
@@ -33,6 +33,12 @@ GlobalData::GlobalData() {
     _assignmentClientExecutable = "assignment-client";
     _domainServerExecutable = "domain-server";
     QString applicationSupportDirectory = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
+
+    // child process output goes to the same place for release and PR builds
+    _processLogsPath = applicationSupportDirectory + "/Logs/";
+    _stacksPath = applicationSupportDirectory + "/stacks/";
+    _domainNameCachePath = applicationSupportDirectory + "/domain-names.json";
+
     if (PR_BUILD) {
         applicationSupportDirectory += "/pr-binaries";
     }
@@ -63,8 +69,10 @@ GlobalData::GlobalData() {
 
     _defaultDomain = "localhost";
     _logsPath = QDir::toNativeSeparators(_clientsLaunchPath + "logs/");
+    _stagedUpdatesPath = QDir::toNativeSeparators(_clientsLaunchPath + "staged/");
     _availableAssignmentTypes.insert("audio-mixer", 0);
     _availableAssignmentTypes.insert("avatar-mixer", 1);
+    _availableAssignmentTypes.insert("agent", 2);
     _availableAssignmentTypes.insert("entity-server", 6);
 
     // allow user to override path to binaries so that they can run their own builds
@@ -33,6 +33,10 @@ public:
     QString getDomainServerMD5URL() { return _domainServerMD5URL; }
     QString getDefaultDomain() { return _defaultDomain; }
     QString getLogsPath() { return _logsPath; }
+    QString getProcessLogsPath() { return _processLogsPath; }
+    QString getStagedUpdatesPath() { return _stagedUpdatesPath; }
+    QString getStacksPath() { return _stacksPath; }
+    QString getDomainNameCachePath() { return _domainNameCachePath; }
     QHash<QString, int> getAvailableAssignmentTypes() { return _availableAssignmentTypes; }
 
     void setHifiBuildDirectory(const QString hifiBuildDirectory);
@@ -61,6 +65,10 @@ private:
     QString _domainServerMD5URL;
     QString _defaultDomain;
     QString _logsPath;
+    QString _processLogsPath;
+    QString _stagedUpdatesPath;
+    QString _stacksPath;
+    QString _domainNameCachePath;
     QString _hifiBuildDirectory;
 
     QString _resourcePath;
@@ -0,0 +1,253 @@
+//
+//  HttpClient.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "HttpClient.h"
+#include "Tracer.h"
+
+#include <QDebug>
+#include <QStringList>
+
+const int MAX_RETRY_DELAY_MS = 30 * 1000;
+const int STATS_REPORT_INTERVAL_MS = 60 * 1000;
+
+static QString hostForUrl(const QUrl& url) {
+    return url.port() < 0 ? url.host() : url.host() + ":" + QString::number(url.port());
+}
+
+HttpRequest::HttpRequest(HttpClient* client, QNetworkAccessManager::Operation operation, const QNetworkRequest& request,
+                         const QByteArray& outgoingData, const HttpRequestPolicy& policy) :
+    QObject(client),
+    _client(client),
+    _operation(operation),
+    _request(request),
+    _outgoingData(outgoingData),
+    _policy(policy),
+    _url(request.url()),
+    _reply(NULL),
+    _traceStartMicros(Tracer::now()),
+    _attempts(0),
+    _timedOut(false),
+    _autoDelete(true),
+    _error(QNetworkReply::NoError),
+    _statusCode(0)
+{
+    _deadlineTimer.setSingleShot(true);
+    connect(&_deadlineTimer, &QTimer::timeout, this, &HttpRequest::handleTimeout);
+
+    _stallTimer.setSingleShot(true);
+    connect(&_stallTimer, &QTimer::timeout, this, &HttpRequest::handleTimeout);
+
+    _elapsed.start();
+}
+
+HttpRequest::~HttpRequest() {
+    if (_reply) {
+        // aborting emits finished, which must not reach a half destroyed request
+        _reply->disconnect(this);
+        _reply->abort();
+        _reply->deleteLater();
+    }
+}
+
+void HttpRequest::sendAttempt() {
+    ++_attempts;
+    _timedOut = false;
+
+    QNetworkAccessManager* manager = _client->getManager();
+
+    if (_operation == QNetworkAccessManager::PostOperation) {
+        _reply = manager->post(_request, _outgoingData);
+    } else {
+        _reply = manager->get(_request);
+    }
+
+    connect(_reply, &QNetworkReply::downloadProgress, this, &HttpRequest::downloadProgress);
+    connect(_reply, &QNetworkReply::downloadProgress, this, &HttpRequest::handleReplyProgress);
+    connect(_reply, &QNetworkReply::uploadProgress, this, &HttpRequest::handleReplyProgress);
+    connect(_reply, &QNetworkReply::finished, this, &HttpRequest::handleReplyFinished);
+
+    if (_policy.timeoutMSecs > 0) {
+        _deadlineTimer.start(_policy.timeoutMSecs);
+    }
+    if (_policy.stallTimeoutMSecs > 0) {
+        _stallTimer.start(_policy.stallTimeoutMSecs);
+    }
+}
+
+void HttpRequest::handleReplyProgress() {
+    // anything moving either way means the attempt isn't stalled
+    if (_stallTimer.isActive()) {
+        _stallTimer.start();
+    }
+}
+
+void HttpRequest::handleTimeout() {
+    if (_reply) {
+        _timedOut = true;
+        _reply->abort();
+    }
+}
+
+void HttpRequest::handleReplyFinished() {
+    QNetworkReply* reply = _reply;
+    _reply = NULL;
+
+    _deadlineTimer.stop();
+    _stallTimer.stop();
+
+    _statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    _body = reply->readAll();
+
+    if (_timedOut) {
+        _error = QNetworkReply::TimeoutError;
+        _errorString = "Request timed out";
+    } else {
+        _error = reply->error();
+        _errorString = reply->errorString();
+    }
+
+    reply->deleteLater();
+
+    _client->recordAttempt(this, _outgoingData.size(), _body.size());
+
+    if (shouldRetry()) {
+        int delay = qMin(_policy.retryDelayMSecs << qMin(_attempts - 1, 16), MAX_RETRY_DELAY_MS);
+        qDebug() << "Retrying" << _url.toString() << "in" << delay << "ms -" << _errorString;
+
+        QTimer::singleShot(delay, this, SLOT(sendAttempt()));
+        return;
+    }
+
+    _client->recordCompletion(this, _elapsed.elapsed());
+
+    if (Tracer::isEnabled()) {
+        Tracer::record("http", "request", _traceStartMicros, _url.path());
+    }
+
+    emit finished();
+
+    if (_autoDelete) {
+        deleteLater();
+    }
+}
+
+bool HttpRequest::shouldRetry() const {
+    if (_attempts >= _policy.maxAttempts) {
+        return false;
+    }
+
+    if (_statusCode >= 500 || _statusCode == 408 || _statusCode == 429) {
+        return true;
+    }
+
+    switch (_error) {
+        case QNetworkReply::ConnectionRefusedError:
+        case QNetworkReply::RemoteHostClosedError:
+        case QNetworkReply::HostNotFoundError:
+        case QNetworkReply::TimeoutError:
+        case QNetworkReply::TemporaryNetworkFailureError:
+        case QNetworkReply::NetworkSessionFailedError:
+        case QNetworkReply::ProxyConnectionClosedError:
+        case QNetworkReply::ProxyTimeoutError:
+        case QNetworkReply::UnknownNetworkError:
+            return true;
+        default:
+            return false;
+    }
+}
+
+HttpClient::HttpClient(QNetworkAccessManager* manager, QObject* parent) :
+    QObject(parent),
+    _manager(manager),
+    _completedRequests(0),
+    _reportedRequests(0)
+{
+    _statsTimer.setInterval(STATS_REPORT_INTERVAL_MS);
+    connect(&_statsTimer, &QTimer::timeout, this, &HttpClient::reportStats);
+    _statsTimer.start();
+}
+
+HttpRequest* HttpClient::get(const QNetworkRequest& request, const HttpRequestPolicy& policy) {
+    return send(QNetworkAccessManager::GetOperation, request, QByteArray(), policy);
+}
+
+HttpRequest* HttpClient::post(const QNetworkRequest& request, const QByteArray& data, const HttpRequestPolicy& policy) {
+    return send(QNetworkAccessManager::PostOperation, request, data, policy);
+}
+
+HttpRequest* HttpClient::send(QNetworkAccessManager::Operation operation, const QNetworkRequest& request,
+                              const QByteArray& data, const HttpRequestPolicy& policy) {
+    QNetworkRequest keepAliveRequest(request);
+    keepAliveRequest.setRawHeader("Connection", "keep-alive");
+
+    HttpRequest* httpRequest = new HttpRequest(this, operation, keepAliveRequest, data, policy);
+    httpRequest->sendAttempt();
+    return httpRequest;
+}
+
+void HttpClient::recordAttempt(const HttpRequest* request, qint64 bytesSent, qint64 bytesReceived) {
+    HttpHostMetrics& metrics = _metrics[hostForUrl(request->getUrl())];
+
+    ++metrics.attempts;
+    metrics.bytesSent += bytesSent;
+    metrics.bytesReceived += bytesReceived;
+
+    if (request->getError() == QNetworkReply::TimeoutError) {
+        ++metrics.timeouts;
+    }
+}
+
+void HttpClient::recordCompletion(const HttpRequest* request, qint64 latencyMSecs) {
+    HttpHostMetrics& metrics = _metrics[hostForUrl(request->getUrl())];
+
+    ++metrics.requests;
+    if (!request->isSuccess()) {
+        ++metrics.failures;
+    }
+    metrics.totalLatencyMSecs += latencyMSecs;
+    metrics.maxLatencyMSecs = qMax(metrics.maxLatencyMSecs, latencyMSecs);
+
+    ++_completedRequests;
+}
+
+QString HttpClient::describeMetrics() const {
+    QStringList lines;
+
+    QHash<QString, HttpHostMetrics>::const_iterator it = _metrics.constBegin();
+    for (; it != _metrics.constEnd(); ++it) {
+        const HttpHostMetrics& metrics = it.value();
+        if (metrics.requests == 0) {
+            continue;
+        }
+
+        lines << QString("%1: %2 requests, %3 failed, %4 retries, %5 timeouts, %6 KB in, %7 KB out, "
+                         "average %8 ms, max %9 ms")
+            .arg(it.key())
+            .arg(metrics.requests)
+            .arg(metrics.failures)
+            .arg(metrics.attempts - metrics.requests)
+            .arg(metrics.timeouts)
+            .arg(metrics.bytesReceived / 1024)
+            .arg(metrics.bytesSent / 1024)
+            .arg(metrics.totalLatencyMSecs / metrics.requests)
+            .arg(metrics.maxLatencyMSecs);
+    }
+
+    lines.sort();
+    return lines.join("\n");
+}
+
+void HttpClient::reportStats() {
+    if (_completedRequests == _reportedRequests) {
+        return;
+    }
+    _reportedRequests = _completedRequests;
+
+    foreach(const QString& line, describeMetrics().split("\n")) {
+        qDebug() << "HTTP" << qPrintable(line);
+    }
+}
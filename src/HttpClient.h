@@ -0,0 +1,150 @@
+//
+//  HttpClient.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_HttpClient_h
+#define hifi_HttpClient_h
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QObject>
+#include <QTimer>
+
+const int DEFAULT_HTTP_TIMEOUT_MS = 30 * 1000;
+const int DEFAULT_HTTP_RETRY_DELAY_MS = 1000;
+
+struct HttpRequestPolicy {
+    HttpRequestPolicy(int timeoutMSecs = DEFAULT_HTTP_TIMEOUT_MS, int maxAttempts = 1) :
+        timeoutMSecs(timeoutMSecs), stallTimeoutMSecs(0), maxAttempts(maxAttempts),
+        retryDelayMSecs(DEFAULT_HTTP_RETRY_DELAY_MS) {}
+
+    int timeoutMSecs; // whole attempt, 0 for none
+    int stallTimeoutMSecs; // no bytes moving for this long, 0 for none
+    int maxAttempts; // keep non-idempotent requests at one
+    int retryDelayMSecs; // doubles with each retry
+};
+
+struct HttpHostMetrics {
+    HttpHostMetrics() : requests(0), attempts(0), failures(0), timeouts(0), bytesSent(0), bytesReceived(0),
+        totalLatencyMSecs(0), maxLatencyMSecs(0) {}
+
+    quint64 requests;
+    quint64 attempts;
+    quint64 failures;
+    quint64 timeouts;
+    quint64 bytesSent;
+    quint64 bytesReceived;
+    quint64 totalLatencyMSecs;
+    qint64 maxLatencyMSecs;
+};
+
+class HttpClient;
+
+// One request through HttpClient, across all of its attempts. It owns the QNetworkReply of the
+// current attempt and reads the body out of it before disposing of it, so handlers only ever
+// see the final result and never have to delete anything. Unless auto delete is turned off
+// the request deletes itself once finished() has been handled.
+class HttpRequest : public QObject
+{
+    Q_OBJECT
+public:
+    ~HttpRequest();
+
+    const QUrl& getUrl() const { return _url; }
+
+    bool isSuccess() const { return _error == QNetworkReply::NoError && _statusCode >= 200 && _statusCode < 300; }
+    QNetworkReply::NetworkError getError() const { return _error; }
+    int getStatusCode() const { return _statusCode; }
+    const QString& getErrorString() const { return _errorString; }
+    const QByteArray& getBody() const { return _body; }
+    int getAttempts() const { return _attempts; }
+
+    // for callers that wait in a local event loop and read the result after it returns
+    void setAutoDelete(bool autoDelete) { _autoDelete = autoDelete; }
+
+signals:
+    void finished();
+    void downloadProgress(qint64 bytesReceived, qint64 bytesTotal);
+
+private slots:
+    void sendAttempt();
+    void handleReplyProgress();
+    void handleReplyFinished();
+    void handleTimeout();
+
+private:
+    friend class HttpClient;
+
+    HttpRequest(HttpClient* client, QNetworkAccessManager::Operation operation, const QNetworkRequest& request,
+                const QByteArray& outgoingData, const HttpRequestPolicy& policy);
+
+    bool shouldRetry() const;
+
+    HttpClient* _client;
+    QNetworkAccessManager::Operation _operation;
+    QNetworkRequest _request;
+    QByteArray _outgoingData;
+    HttpRequestPolicy _policy;
+    QUrl _url;
+
+    QNetworkReply* _reply;
+    QTimer _deadlineTimer;
+    QTimer _stallTimer;
+    QElapsedTimer _elapsed;
+    qint64 _traceStartMicros;
+    int _attempts;
+    bool _timedOut;
+    bool _autoDelete;
+
+    QNetworkReply::NetworkError _error;
+    int _statusCode;
+    QString _errorString;
+    QByteArray _body;
+};
+
+// The request engine every part of the stack manager talks HTTP through. All requests share the
+// one QNetworkAccessManager, whose per host:port pool keeps connections alive between requests,
+// so the domain-server polls and API lookups reuse sockets instead of reconnecting. Each request
+// gets a deadline and an optional retry policy with exponential backoff on connection failures,
+// timeouts and 5xx, 408 and 429 responses. Latency, bytes and failures are kept per host for
+// diagnostics and summarised in the log every minute they change.
+class HttpClient : public QObject
+{
+    Q_OBJECT
+public:
+    HttpClient(QNetworkAccessManager* manager, QObject* parent = 0);
+
+    HttpRequest* get(const QNetworkRequest& request, const HttpRequestPolicy& policy = HttpRequestPolicy());
+    HttpRequest* post(const QNetworkRequest& request, const QByteArray& data,
+                      const HttpRequestPolicy& policy = HttpRequestPolicy());
+
+    QNetworkAccessManager* getManager() { return _manager; }
+    const QHash<QString, HttpHostMetrics>& getMetrics() const { return _metrics; }
+    QString describeMetrics() const;
+
+private slots:
+    void reportStats();
+
+private:
+    friend class HttpRequest;
+
+    HttpRequest* send(QNetworkAccessManager::Operation operation, const QNetworkRequest& request,
+                      const QByteArray& data, const HttpRequestPolicy& policy);
+    void recordAttempt(const HttpRequest* request, qint64 bytesSent, qint64 bytesReceived);
+    void recordCompletion(const HttpRequest* request, qint64 latencyMSecs);
+
+    QNetworkAccessManager* _manager;
+    QHash<QString, HttpHostMetrics> _metrics;
+    QTimer _statsTimer;
+    quint64 _completedRequests;
+    quint64 _reportedRequests;
+};
+
+#endif
@@ -0,0 +1,111 @@
+//
+//  LocalServiceDiscovery.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "LocalServiceDiscovery.h"
+
+#include <QDebug>
+
+#include <cstring>
+
+const int FIRST_ATTACH_RETRY_MS = 250;
+const int MAX_ATTACH_RETRY_MS = 8 * 1000;
+
+// a process that hasn't published its ports by now isn't going to
+const int MAX_ATTACH_WINDOW_MS = 2 * 60 * 1000;
+
+LocalServiceDiscovery::LocalServiceDiscovery(QObject* parent) :
+    QObject(parent),
+    _attachTimer(this),
+    _attachRetryMSecs(FIRST_ATTACH_RETRY_MS)
+{
+    _attachTimer.setSingleShot(true);
+    connect(&_attachTimer, &QTimer::timeout, this, &LocalServiceDiscovery::refresh);
+}
+
+void LocalServiceDiscovery::addService(const QString& key, const QString& owner) {
+    Service service;
+    service.key = key;
+    service.owner = owner;
+    service.memory = NULL;
+    service.port = 0;
+
+    _services << service;
+}
+
+void LocalServiceDiscovery::start() {
+    // picks up a domain-server that was already running before we were
+    refresh();
+}
+
+void LocalServiceDiscovery::processStarted(const QString& owner) {
+    bool ownsService = false;
+    foreach(const Service& service, _services) {
+        ownsService = ownsService || service.owner == owner;
+    }
+
+    if (ownsService) {
+        // the ports are published a little after the process starts
+        _attachRetryMSecs = FIRST_ATTACH_RETRY_MS;
+        _attachWindow.start();
+        refresh();
+    }
+}
+
+void LocalServiceDiscovery::processStopped(const QString& owner) {
+    for (int i = 0; i < _services.size(); ++i) {
+        Service& service = _services[i];
+        if (service.owner != owner || !service.memory) {
+            continue;
+        }
+
+        // holding on would keep the old segment alive and stop the next run creating its own
+        delete service.memory;
+        service.memory = NULL;
+
+        if (service.port != 0) {
+            service.port = 0;
+            emit portChanged(service.key, 0);
+        }
+    }
+}
+
+bool LocalServiceDiscovery::readPort(Service& service) {
+    if (!service.memory) {
+        service.memory = new QSharedMemory(service.key, this);
+    }
+
+    if (!service.memory->isAttached() && !service.memory->attach(QSharedMemory::ReadOnly)) {
+        return false;
+    }
+
+    quint16 port = 0;
+    if (service.memory->lock()) {
+        memcpy(&port, service.memory->constData(), sizeof(port));
+        service.memory->unlock();
+    }
+
+    if (port != service.port) {
+        qDebug() << "Local service" << service.key << "is on port" << port;
+        service.port = port;
+        emit portChanged(service.key, port);
+    }
+
+    return port != 0;
+}
+
+void LocalServiceDiscovery::refresh() {
+    bool isMissing = false;
+
+    for (int i = 0; i < _services.size(); ++i) {
+        isMissing = !readPort(_services[i]) || isMissing;
+    }
+
+    if (isMissing && _attachWindow.isValid() && _attachWindow.elapsed() < MAX_ATTACH_WINDOW_MS) {
+        _attachTimer.start(_attachRetryMSecs);
+        _attachRetryMSecs = qMin(_attachRetryMSecs * 2, MAX_ATTACH_RETRY_MS);
+    }
+}
@@ -0,0 +1,64 @@
+//
+//  LocalServiceDiscovery.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_LocalServiceDiscovery_h
+#define hifi_LocalServiceDiscovery_h
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QSharedMemory>
+#include <QTimer>
+
+const QString DOMAIN_SERVER_LOCAL_PORT_KEY = "domain-server.local-port";
+const QString DOMAIN_SERVER_LOCAL_HTTP_PORT_KEY = "domain-server.local-http-port";
+const QString DOMAIN_SERVER_LOCAL_HTTPS_PORT_KEY = "domain-server.local-https-port";
+const QString ASSIGNMENT_CLIENT_MONITOR_LOCAL_PORT_KEY = "assignment-client-monitor.local-port";
+
+// Tracks the local ports stack processes publish in shared memory, the way LimitedNodeList
+// finds them. Each key is owned by a process name and is only looked at when that process
+// starts or stops: a start attaches with backoff until the process has created its segment,
+// a stop detaches so the segment goes away and the next run can create a fresh one. Nothing
+// is polled while the stack is steady. Lives on its own thread so a held segment lock never
+// stalls the GUI; talk to it through queued signals and slots.
+class LocalServiceDiscovery : public QObject
+{
+    Q_OBJECT
+public:
+    LocalServiceDiscovery(QObject* parent = 0);
+
+    // call before moving to the discovery thread
+    void addService(const QString& key, const QString& owner);
+
+public slots:
+    void start();
+    void processStarted(const QString& owner);
+    void processStopped(const QString& owner);
+
+signals:
+    void portChanged(const QString& key, quint16 port); // 0 once the port is gone
+
+private slots:
+    void refresh();
+
+private:
+    struct Service {
+        QString key;
+        QString owner;
+        QSharedMemory* memory;
+        quint16 port;
+    };
+
+    bool readPort(Service& service);
+
+    QList<Service> _services;
+    QTimer _attachTimer;
+    QElapsedTimer _attachWindow;
+    int _attachRetryMSecs;
+};
+
+#endif
@@ -0,0 +1,39 @@
+//
+//  LogCounterMatcher.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "LogCounterMatcher.h"
+
+#include <QString>
+
+LogCounterMatcher::LogCounterMatcher(const QVector<QRegularExpression>& patterns) :
+    QObject(),
+    _patterns(patterns)
+{
+    qRegisterMetaType<const LogStore*>("const LogStore*");
+    qRegisterMetaType<QVector<quint32> >("QVector<quint32>");
+}
+
+void LogCounterMatcher::match(const LogStore* store, const QByteArray& lines) {
+    QVector<quint32> counts(_patterns.size(), 0);
+
+    int lineStart = 0;
+    while (lineStart <= lines.size()) {
+        int newline = lines.indexOf('\n', lineStart);
+        int lineEnd = newline < 0 ? lines.size() : newline;
+        QString message = QString::fromUtf8(lines.constData() + lineStart, lineEnd - lineStart);
+
+        for (int counter = 0; counter < _patterns.size(); ++counter) {
+            if (_patterns[counter].match(message).hasMatch()) {
+                ++counts[counter];
+            }
+        }
+
+        lineStart = lineEnd + 1;
+    }
+
+    emit matched(store, counts);
+}
@@ -0,0 +1,37 @@
+//
+//  LogCounterMatcher.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_LogCounterMatcher_h
+#define hifi_LogCounterMatcher_h
+
+#include <QByteArray>
+#include <QObject>
+#include <QRegularExpression>
+#include <QVector>
+
+class LogStore;
+
+// Runs LogMetrics' configured regex counters away from the GUI thread. Each batch is a copy of
+// one source's new lines joined by newlines, and the counts come back tagged with the store
+// they were taken from. Talk to it through queued signals and slots.
+class LogCounterMatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogCounterMatcher(const QVector<QRegularExpression>& patterns);
+
+public slots:
+    void match(const LogStore* store, const QByteArray& lines);
+
+signals:
+    void matched(const LogStore* store, const QVector<quint32>& counts);
+
+private:
+    QVector<QRegularExpression> _patterns;
+};
+
+#endif
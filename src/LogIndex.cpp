@@ -0,0 +1,281 @@
+//
+//  LogIndex.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "LogIndex.h"
+#include "LogLifecycleManager.h"
+
+#include <QByteArrayMatcher>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+
+#include <cstring>
+
+const qint64 MAP_CHUNK_BYTES = 16 * 1024 * 1024;
+const qint64 BLOCK_MAX_BYTES = 256 * 1024;
+const int BLOCK_MAX_LINES = 4096;
+
+// only the prefix of a line is needed to find its timestamp and level
+const int MAX_PREFIX_PARSE_BYTES = 128;
+
+LogIndex::LogIndex(const QString& path) :
+    _path(path),
+    _isCompressed(LogLifecycleManager::isCompressedSegment(path)),
+    _isLive(LogLifecycleManager::isLiveLog(path)),
+    _parser(LogLineParser::yearFromLogFilename(QFileInfo(path).fileName()))
+{
+    reset();
+}
+
+void LogIndex::reset() {
+    _blocks.clear();
+    _isComplete = false;
+    _indexedBytes = 0;
+    _lineCount = 0;
+    _lastTimestamp = 0;
+}
+
+bool LogIndex::update() {
+    if (_isCompressed) {
+        // compressed segments never change, index them once from the decompressed bytes
+        if (_isComplete) {
+            return false;
+        }
+
+        QByteArray data = LogLifecycleManager::readCompressedSegment(_path);
+        _indexedBytes = indexLines(data.constData(), data.size(), 0, true);
+        _isComplete = true;
+        return _lineCount > 0;
+    }
+
+    QFile file(_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    qint64 fileSize = file.size();
+    if (fileSize < _indexedBytes) {
+        // the file was truncated underneath us (usually a rotation), start over
+        reset();
+    }
+
+    bool addedLines = false;
+
+    while (_indexedBytes < fileSize) {
+        qint64 chunkLength = qMin(fileSize - _indexedBytes, MAP_CHUNK_BYTES);
+        uchar* chunk = NULL;
+        QByteArray readChunk;
+        const char* data;
+
+        if (_isLive) {
+            // a short read is all a truncation can do to us here, a mapping would fault
+            if (!file.seek(_indexedBytes)) {
+                break;
+            }
+            readChunk = file.read(chunkLength);
+            chunkLength = readChunk.size();
+            if (chunkLength == 0) {
+                break;
+            }
+            data = readChunk.constData();
+        } else {
+            chunk = file.map(_indexedBytes, chunkLength);
+            if (!chunk) {
+                break;
+            }
+            data = reinterpret_cast<const char*>(chunk);
+        }
+
+        qint64 indexedLength = indexLines(data, chunkLength, _indexedBytes, false);
+
+        if (indexedLength == 0 && chunkLength == MAP_CHUNK_BYTES) {
+            // a single line longer than a chunk, index it as-is rather than stalling on it
+            indexedLength = indexLines(data, chunkLength, _indexedBytes, true);
+        }
+
+        if (chunk) {
+            file.unmap(chunk);
+        }
+
+        if (indexedLength == 0) {
+            // only an unterminated tail is left, wait for the child to finish the line
+            break;
+        }
+
+        _indexedBytes += indexedLength;
+        addedLines = true;
+    }
+
+    return addedLines;
+}
+
+qint64 LogIndex::indexLines(const char* data, qint64 length, qint64 baseOffset, bool includeUnterminated) {
+    qint64 lineStart = 0;
+
+    while (lineStart < length) {
+        const char* newline = static_cast<const char*>(memchr(data + lineStart, '\n', length - lineStart));
+        if (!newline && !includeUnterminated) {
+            break;
+        }
+
+        qint64 lineLength = newline ? newline - (data + lineStart) : length - lineStart;
+        ParsedLogLine parsed;
+        _parser.parse(data + lineStart, qMin<qint64>(lineLength, MAX_PREFIX_PARSE_BYTES), parsed);
+
+        qint64 consumedLength = newline ? lineLength + 1 : lineLength;
+        appendLine(baseOffset + lineStart, consumedLength, parsed);
+        lineStart += consumedLength;
+    }
+
+    return lineStart;
+}
+
+void LogIndex::appendLine(qint64 offset, qint64 length, const ParsedLogLine& parsed) {
+    // continuation lines (stack traces, multi-line messages) inherit the last timestamp
+    if (parsed.timestamp > 0) {
+        _lastTimestamp = parsed.timestamp;
+    }
+
+    if (_blocks.isEmpty() || _blocks.last().lineCount >= BLOCK_MAX_LINES
+        || _blocks.last().length >= BLOCK_MAX_BYTES) {
+        Block block;
+        block.offset = offset;
+        block.length = 0;
+        block.firstTimestamp = _lastTimestamp;
+        block.lastTimestamp = _lastTimestamp;
+        block.firstLine = _lineCount;
+        block.lineCount = 0;
+        block.levelMask = 0;
+        _blocks.append(block);
+    }
+
+    Block& block = _blocks.last();
+    block.length += length;
+    block.lineCount++;
+    block.levelMask |= logLevelBit(parsed.level);
+
+    if (block.firstTimestamp == 0) {
+        block.firstTimestamp = _lastTimestamp;
+    }
+    block.lastTimestamp = _lastTimestamp;
+
+    _lineCount++;
+}
+
+bool LogIndex::search(const LogQuery& query, QList<LogSearchMatch>& matches, int maxMatches) const {
+    QFile file(_path);
+    QByteArray decompressed;
+
+    if (_isCompressed) {
+        decompressed = LogLifecycleManager::readCompressedSegment(_path);
+    } else if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QRegularExpression regex;
+    QByteArrayMatcher matcher;
+
+    if (query.isRegex) {
+        regex.setPattern(query.text);
+        regex.optimize();
+    } else {
+        matcher.setPattern(query.text.toUtf8());
+    }
+
+    bool hasTextFilter = !query.text.isEmpty();
+    LogLineParser parser(_parser.getDefaultYear());
+
+    foreach(const Block& block, _blocks) {
+        if (!(block.levelMask & query.levelMask)
+            || (query.fromTimestamp > 0 && block.lastTimestamp < query.fromTimestamp)
+            || (query.toTimestamp > 0 && block.firstTimestamp > query.toTimestamp)) {
+            continue;
+        }
+
+        const char* data;
+        uchar* mapped = NULL;
+        QByteArray blockData;
+        qint64 blockLength = block.length;
+
+        if (_isCompressed) {
+            if (block.offset + block.length > decompressed.size()) {
+                continue;
+            }
+            data = decompressed.constData() + block.offset;
+        } else if (_isLive) {
+            // the file may have been truncated since it was indexed, take whatever is still there
+            if (!file.seek(block.offset)) {
+                continue;
+            }
+            blockData = file.read(block.length);
+            blockLength = blockData.size();
+            data = blockData.constData();
+        } else {
+            mapped = file.map(block.offset, block.length);
+            if (!mapped) {
+                continue;
+            }
+            data = reinterpret_cast<const char*>(mapped);
+        }
+
+        qint64 lineStart = 0;
+        qint64 lineTimestamp = block.firstTimestamp;
+        bool reachedMaxMatches = false;
+
+        for (int i = 0; i < block.lineCount && lineStart < blockLength; ++i) {
+            const char* newline = static_cast<const char*>(memchr(data + lineStart, '\n', blockLength - lineStart));
+            qint64 lineLength = newline ? newline - (data + lineStart) : blockLength - lineStart;
+            const char* line = data + lineStart;
+            lineStart += lineLength + 1;
+
+            ParsedLogLine parsed;
+            parser.parse(line, qMin<qint64>(lineLength, MAX_PREFIX_PARSE_BYTES), parsed);
+            if (parsed.timestamp > 0) {
+                lineTimestamp = parsed.timestamp;
+            }
+
+            if (!(logLevelBit(parsed.level) & query.levelMask)
+                || (query.fromTimestamp > 0 && lineTimestamp < query.fromTimestamp)
+                || (query.toTimestamp > 0 && lineTimestamp > query.toTimestamp)) {
+                continue;
+            }
+
+            if (hasTextFilter) {
+                if (query.isRegex) {
+                    if (!regex.match(QString::fromUtf8(line, lineLength)).hasMatch()) {
+                        continue;
+                    }
+                } else if (matcher.indexIn(line, lineLength) == -1) {
+                    continue;
+                }
+            }
+
+            LogSearchMatch match;
+            match.path = _path;
+            match.lineNumber = block.firstLine + i + 1;
+            match.timestamp = lineTimestamp;
+            match.level = parsed.level;
+            match.text = QString::fromUtf8(line, lineLength).trimmed();
+            matches.append(match);
+
+            if (matches.size() >= maxMatches) {
+                reachedMaxMatches = true;
+                break;
+            }
+        }
+
+        if (mapped) {
+            file.unmap(mapped);
+        }
+
+        if (reachedMaxMatches) {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,81 @@
+//
+//  LogIndex.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_LogIndex_h
+#define hifi_LogIndex_h
+
+#include <QList>
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+
+#include "LogLineParser.h"
+
+struct LogQuery {
+    LogQuery() : isRegex(false), levelMask(ALL_LOG_LEVELS), fromTimestamp(0), toTimestamp(0) {}
+
+    QString text;
+    bool isRegex;
+    quint8 levelMask;
+    qint64 fromTimestamp; // 0 for no lower bound
+    qint64 toTimestamp; // 0 for no upper bound
+};
+
+struct LogSearchMatch {
+    QString path;
+    int lineNumber;
+    qint64 timestamp;
+    LogLevel level;
+    QString text;
+};
+
+Q_DECLARE_METATYPE(LogQuery)
+Q_DECLARE_METATYPE(QList<LogSearchMatch>)
+
+// Incremental index over one child output file or rotated segment. Lines are grouped into blocks
+// that record their byte range, line numbers, time span and the levels they contain, so a query
+// only maps and scans the blocks that can possibly match and the index itself stays a few KB per
+// GB of log. Live files are read rather than mapped, a rotation can truncate them at any time.
+class LogIndex
+{
+public:
+    explicit LogIndex(const QString& path);
+
+    const QString& getPath() const { return _path; }
+    int getLineCount() const { return _lineCount; }
+    qint64 getIndexedBytes() const { return _indexedBytes; }
+
+    bool update();
+    bool search(const LogQuery& query, QList<LogSearchMatch>& matches, int maxMatches) const;
+
+private:
+    struct Block {
+        qint64 offset;
+        qint64 length;
+        qint64 firstTimestamp;
+        qint64 lastTimestamp;
+        int firstLine;
+        int lineCount;
+        quint8 levelMask;
+    };
+
+    void reset();
+    qint64 indexLines(const char* data, qint64 length, qint64 baseOffset, bool includeUnterminated);
+    void appendLine(qint64 offset, qint64 length, const ParsedLogLine& parsed);
+
+    QString _path;
+    bool _isCompressed;
+    bool _isLive;
+    bool _isComplete;
+    QVector<Block> _blocks;
+    qint64 _indexedBytes;
+    int _lineCount;
+    qint64 _lastTimestamp;
+    LogLineParser _parser;
+};
+
+#endif
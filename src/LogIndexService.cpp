@@ -0,0 +1,113 @@
+//
+//  LogIndexService.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "LogIndexService.h"
+#include "LogLifecycleManager.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSet>
+#include <QStringList>
+
+const int INDEX_REFRESH_INTERVAL_MS = 2000;
+
+static bool matchIsEarlier(const LogSearchMatch& first, const LogSearchMatch& second) {
+    return first.timestamp < second.timestamp;
+}
+
+LogIndexService::LogIndexService(const QString& logsPath) :
+    QObject(),
+    _logsPath(logsPath),
+    _refreshTimer(NULL)
+{
+    qRegisterMetaType<LogQuery>("LogQuery");
+    qRegisterMetaType<QList<LogSearchMatch> >("QList<LogSearchMatch>");
+}
+
+LogIndexService::~LogIndexService() {
+    qDeleteAll(_indexes);
+}
+
+void LogIndexService::start() {
+    // created here so the timer belongs to the service's thread
+    _refreshTimer = new QTimer(this);
+    _refreshTimer->setInterval(INDEX_REFRESH_INTERVAL_MS);
+    connect(_refreshTimer, &QTimer::timeout, this, &LogIndexService::refresh);
+    _refreshTimer->start();
+
+    refresh();
+}
+
+void LogIndexService::refresh() {
+    // live files and the segments their manifests list, compressed ones are read through LogLifecycleManager
+    QFileInfoList logFiles;
+    foreach(const QFileInfoList& log, LogLifecycleManager::findChildLogs(_logsPath)) {
+        logFiles << log;
+    }
+
+    QSet<QString> currentPaths;
+    bool changed = false;
+
+    foreach(const QFileInfo& logFile, logFiles) {
+        QString path = logFile.absoluteFilePath();
+        currentPaths.insert(path);
+
+        LogIndex* index = _indexes.value(path);
+        if (!index) {
+            index = new LogIndex(path);
+            _indexes.insert(path, index);
+        }
+
+        // a stat is much cheaper than opening every file on every pass
+        if (logFile.size() != index->getIndexedBytes()) {
+            changed |= index->update();
+        }
+    }
+
+    QHash<QString, LogIndex*>::iterator it = _indexes.begin();
+    while (it != _indexes.end()) {
+        if (!currentPaths.contains(it.key())) {
+            delete it.value();
+            it = _indexes.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+
+    if (changed) {
+        int lineCount = 0;
+        foreach(LogIndex* index, _indexes) {
+            lineCount += index->getLineCount();
+        }
+        emit indexUpdated(_indexes.size(), lineCount);
+    }
+}
+
+void LogIndexService::search(const LogQuery& query, int maxMatches) {
+    // pick up whatever was written since the last pass so results are current
+    refresh();
+
+    QList<LogSearchMatch> matches;
+    bool wasTruncated = false;
+
+    // files in path order and each one front to back, so a truncated search keeps the same matches every time
+    QStringList paths = _indexes.keys();
+    paths.sort();
+
+    foreach(const QString& path, paths) {
+        if (_indexes.value(path)->search(query, matches, maxMatches)) {
+            wasTruncated = true;
+            break;
+        }
+    }
+
+    qStableSort(matches.begin(), matches.end(), matchIsEarlier);
+
+    emit searchFinished(matches, wasTruncated);
+}
@@ -0,0 +1,41 @@
+//
+//  LogIndexService.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_LogIndexService_h
+#define hifi_LogIndexService_h
+
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+
+#include "LogIndex.h"
+
+// Owns a LogIndex for every child output file in the logs directory and keeps them current.
+// Lives on its own thread; talk to it through queued signals and slots.
+class LogIndexService : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogIndexService(const QString& logsPath);
+    ~LogIndexService();
+
+public slots:
+    void start();
+    void refresh();
+    void search(const LogQuery& query, int maxMatches);
+
+signals:
+    void indexUpdated(int fileCount, int lineCount);
+    void searchFinished(const QList<LogSearchMatch>& matches, bool wasTruncated);
+
+private:
+    QString _logsPath;
+    QHash<QString, LogIndex*> _indexes;
+    QTimer* _refreshTimer;
+};
+
+#endif
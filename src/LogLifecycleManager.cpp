@@ -0,0 +1,556 @@
+//
+//  LogLifecycleManager.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "LogLifecycleManager.h"
+
+#include <algorithm>
+
+#include <quazip.h>
+#include <quazipfile.h>
+#include <quazipnewinfo.h>
+
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QRunnable>
+#include <QSaveFile>
+
+const qint64 DEFAULT_MAX_SEGMENT_BYTES = 32 * 1024 * 1024;
+const int DEFAULT_MAX_SEGMENT_AGE_SECS = 24 * 60 * 60;
+const int DEFAULT_RETENTION_DAYS = 14;
+const int DEFAULT_RETENTION_FILE_COUNT = 500;
+const qint64 DEFAULT_RETENTION_TOTAL_BYTES = 2048LL * 1024 * 1024;
+
+const int RETENTION_INTERVAL_MS = 10 * 60 * 1000;
+const qint64 COPY_CHUNK_BYTES = 1024 * 1024;
+
+const QString LOG_SUFFIX = ".txt";
+const QString COMPRESSED_SUFFIX = ".zip";
+const QString MANIFEST_SUFFIX = ".segments.json";
+const QString PARTIAL_SUFFIX = ".part";
+
+// <log>.<n>.txt, captures <log>
+const QRegularExpression SEGMENT_NAME_PATTERN("^(.*)\\.\\d+\\.txt$");
+
+const QString MANIFEST_NEXT_KEY = "next";
+const QString MANIFEST_SEGMENTS_KEY = "segments";
+const QString SEGMENT_FILE_KEY = "file";
+const QString SEGMENT_BYTES_KEY = "bytes";
+const QString SEGMENT_STARTED_KEY = "started";
+const QString SEGMENT_ENDED_KEY = "ended";
+const QString SEGMENT_COMPRESSED_KEY = "compressed";
+
+// PendingRotation::copiedBytes while the worker copies, and when it could not
+const qint64 COPY_IN_PROGRESS = -1;
+const qint64 COPY_FAILED = -2;
+
+static QJsonObject readManifest(const QString& manifestPath) {
+    QFile manifestFile(manifestPath);
+    if (!manifestFile.open(QIODevice::ReadOnly)) {
+        return QJsonObject();
+    }
+    return QJsonDocument::fromJson(manifestFile.readAll()).object();
+}
+
+static void writeManifest(const QString& manifestPath, const QJsonObject& manifest) {
+    QSaveFile manifestFile(manifestPath);
+    if (manifestFile.open(QIODevice::WriteOnly)) {
+        manifestFile.write(QJsonDocument(manifest).toJson(QJsonDocument::Compact));
+        manifestFile.commit();
+    }
+}
+
+LogLifecyclePolicy::LogLifecyclePolicy() :
+    maxSegmentBytes(DEFAULT_MAX_SEGMENT_BYTES),
+    maxSegmentAgeSecs(DEFAULT_MAX_SEGMENT_AGE_SECS),
+    retentionDays(DEFAULT_RETENTION_DAYS),
+    retentionFileCount(DEFAULT_RETENTION_FILE_COUNT),
+    retentionTotalBytes(DEFAULT_RETENTION_TOTAL_BYTES)
+{
+}
+
+// copies the first bytes of a live log into a partial segment, off the GUI thread
+class SegmentCopyJob : public QRunnable
+{
+public:
+    SegmentCopyJob(LogLifecycleManager* manager, const QString& path, const QString& partialPath, qint64 bytes) :
+        _manager(manager),
+        _path(path),
+        _partialPath(partialPath),
+        _bytes(bytes)
+    {
+    }
+
+    virtual void run() {
+        QFile logFile(_path);
+        QFile partialFile(_partialPath);
+        if (!logFile.open(QIODevice::ReadOnly) || !partialFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            _manager->segmentCopied(_path, _partialPath, COPY_FAILED);
+            return;
+        }
+
+        qint64 copiedBytes = 0;
+        while (copiedBytes < _bytes) {
+            QByteArray chunk = logFile.read(qMin(COPY_CHUNK_BYTES, _bytes - copiedBytes));
+            if (chunk.isEmpty() || partialFile.write(chunk) != chunk.size()) {
+                break;
+            }
+            copiedBytes += chunk.size();
+        }
+
+        partialFile.close();
+        _manager->segmentCopied(_path, _partialPath, copiedBytes == _bytes ? copiedBytes : COPY_FAILED);
+    }
+
+private:
+    LogLifecycleManager* _manager;
+    QString _path;
+    QString _partialPath;
+    qint64 _bytes;
+};
+
+class SegmentCompressionJob : public QRunnable
+{
+public:
+    SegmentCompressionJob(LogLifecycleManager* manager, const QString& manifestPath, const QString& segmentPath) :
+        _manager(manager),
+        _manifestPath(manifestPath),
+        _segmentPath(segmentPath)
+    {
+    }
+
+    virtual void run() {
+        QFileInfo segmentInfo(_segmentPath);
+        QString partialPath = segmentInfo.absolutePath() + "/" + segmentInfo.completeBaseName() + COMPRESSED_SUFFIX
+            + PARTIAL_SUFFIX;
+
+        QFile segmentFile(_segmentPath);
+        if (!segmentFile.open(QIODevice::ReadOnly)) {
+            _manager->segmentCompressed(_manifestPath, _segmentPath, QString());
+            return;
+        }
+
+        QuaZip zip(partialPath);
+        if (!zip.open(QuaZip::mdCreate)) {
+            qDebug() << "Could not create" << partialPath << "to compress log segment.";
+            _manager->segmentCompressed(_manifestPath, _segmentPath, QString());
+            return;
+        }
+
+        QuaZipFile zipFile(&zip);
+        bool success = zipFile.open(QIODevice::WriteOnly, QuaZipNewInfo(segmentInfo.fileName(), _segmentPath));
+
+        while (success && !segmentFile.atEnd()) {
+            QByteArray chunk = segmentFile.read(COPY_CHUNK_BYTES);
+            success = zipFile.write(chunk) == chunk.size();
+        }
+
+        zipFile.close();
+        success = success && zipFile.getZipError() == UNZ_OK;
+        zip.close();
+        segmentFile.close();
+
+        if (!success) {
+            qDebug() << "Failed to compress log segment" << _segmentPath;
+            QFile::remove(partialPath);
+            partialPath.clear();
+        }
+
+        _manager->segmentCompressed(_manifestPath, _segmentPath, partialPath);
+    }
+
+private:
+    LogLifecycleManager* _manager;
+    QString _manifestPath;
+    QString _segmentPath;
+};
+
+LogLifecycleManager::LogLifecycleManager(const QString& logsPath, const LogLifecyclePolicy& policy, QObject* parent) :
+    QObject(parent),
+    _logsPath(logsPath),
+    _policy(policy)
+{
+    // copies and compression are background chores, one worker is plenty and keeps them in order
+    _compressionPool.setMaxThreadCount(1);
+
+    _retentionTimer.setInterval(RETENTION_INTERVAL_MS);
+    connect(&_retentionTimer, &QTimer::timeout, this, &LogLifecycleManager::applyRetention);
+    _retentionTimer.start();
+}
+
+LogLifecycleManager::~LogLifecycleManager() {
+    _compressionPool.waitForDone();
+
+    foreach(const PendingRotation& rotation, _pendingRotations) {
+        QFile::remove(rotation.segmentPath + PARTIAL_SUFFIX);
+    }
+}
+
+void LogLifecycleManager::registerActiveLog(const QString& path) {
+    QMutexLocker locker(&_mutex);
+    _activeLogStarts.insert(path, QDateTime::currentDateTime());
+}
+
+void LogLifecycleManager::releaseActiveLog(const QString& path) {
+    QMutexLocker locker(&_mutex);
+    _activeLogStarts.remove(path);
+
+    // a copy still on the worker cleans up after itself once it finds it is no longer wanted
+    if (_pendingRotations.contains(path) && _pendingRotations[path].copiedBytes != COPY_IN_PROGRESS) {
+        QFile::remove(_pendingRotations[path].segmentPath + PARTIAL_SUFFIX);
+    }
+    _pendingRotations.remove(path);
+}
+
+bool LogLifecycleManager::rotateIfNeeded(const QString& path) {
+    QMutexLocker locker(&_mutex);
+
+    if (!_activeLogStarts.contains(path)) {
+        return false;
+    }
+
+    if (_pendingRotations.contains(path)) {
+        PendingRotation rotation = _pendingRotations.value(path);
+        if (rotation.copiedBytes == COPY_IN_PROGRESS) {
+            return false;
+        }
+
+        _pendingRotations.remove(path);
+        return finishRotation(path, rotation);
+    }
+
+    qint64 size = QFileInfo(path).size();
+    QDateTime started = _activeLogStarts.value(path);
+    QDateTime now = QDateTime::currentDateTime();
+
+    if (size == 0 || (size < _policy.maxSegmentBytes && started.secsTo(now) < _policy.maxSegmentAgeSecs)) {
+        return false;
+    }
+
+    int segmentNumber = qMax(1, readManifest(manifestPathForLog(path))[MANIFEST_NEXT_KEY].toInt());
+    QString basePath = path.left(path.size() - LOG_SUFFIX.size());
+
+    PendingRotation rotation;
+    rotation.segmentPath = QString("%1.%2%3").arg(basePath).arg(segmentNumber).arg(LOG_SUFFIX);
+    rotation.copiedBytes = COPY_IN_PROGRESS;
+    _pendingRotations.insert(path, rotation);
+
+    _compressionPool.start(new SegmentCopyJob(this, path, rotation.segmentPath + PARTIAL_SUFFIX, size));
+    return false;
+}
+
+void LogLifecycleManager::segmentCopied(const QString& path, const QString& partialPath, qint64 copiedBytes) {
+    QMutexLocker locker(&_mutex);
+
+    if (!_pendingRotations.contains(path)) {
+        // the process let go of the log while we were copying it
+        QFile::remove(partialPath);
+        return;
+    }
+
+    _pendingRotations[path].copiedBytes = copiedBytes;
+}
+
+bool LogLifecycleManager::finishRotation(const QString& path, const PendingRotation& rotation) {
+    QString partialPath = rotation.segmentPath + PARTIAL_SUFFIX;
+
+    if (rotation.copiedBytes == COPY_FAILED) {
+        // try again next time
+        qDebug() << "Could not copy" << path << "to rotate it.";
+        QFile::remove(partialPath);
+        return false;
+    }
+
+    // only what the child wrote while the worker was copying is left to copy here, so
+    // only output written between the last read and the truncate below can be lost
+    QFile logFile(path);
+    QFile partialFile(partialPath);
+    if (!logFile.open(QIODevice::ReadOnly) || !partialFile.open(QIODevice::Append)) {
+        qDebug() << "Could not rotate" << path;
+        QFile::remove(partialPath);
+        return false;
+    }
+
+    qint64 segmentBytes = rotation.copiedBytes;
+    if (logFile.seek(rotation.copiedBytes)) {
+        QByteArray tail = logFile.readAll();
+        if (partialFile.write(tail) == tail.size()) {
+            segmentBytes += tail.size();
+        }
+    }
+    partialFile.close();
+    logFile.close();
+
+    QFile::remove(rotation.segmentPath);
+    if (!QFile::rename(partialPath, rotation.segmentPath) || !QFile::resize(path, 0)) {
+        // drop the copy and leave the live file alone, we'll try again next time
+        qDebug() << "Could not truncate" << path << "after copying it to" << rotation.segmentPath;
+        QFile::remove(partialPath);
+        QFile::remove(rotation.segmentPath);
+        return false;
+    }
+
+    QDateTime started = _activeLogStarts.value(path);
+    QDateTime now = QDateTime::currentDateTime();
+    _activeLogStarts.insert(path, now);
+
+    QString manifestPath = manifestPathForLog(path);
+    QJsonObject manifest = readManifest(manifestPath);
+    int segmentNumber = qMax(1, manifest[MANIFEST_NEXT_KEY].toInt());
+
+    QJsonObject segment;
+    segment[SEGMENT_FILE_KEY] = QFileInfo(rotation.segmentPath).fileName();
+    segment[SEGMENT_BYTES_KEY] = double(segmentBytes);
+    segment[SEGMENT_STARTED_KEY] = double(started.toMSecsSinceEpoch());
+    segment[SEGMENT_ENDED_KEY] = double(now.toMSecsSinceEpoch());
+    segment[SEGMENT_COMPRESSED_KEY] = false;
+
+    QJsonArray segments = manifest[MANIFEST_SEGMENTS_KEY].toArray();
+    segments.append(segment);
+    manifest[MANIFEST_SEGMENTS_KEY] = segments;
+    manifest[MANIFEST_NEXT_KEY] = segmentNumber + 1;
+    writeManifest(manifestPath, manifest);
+
+    qDebug() << "Rotated" << path << "into" << rotation.segmentPath;
+
+    // retention leaves it alone until the zip has replaced it in the manifest
+    _compressingSegments.insert(QFileInfo(rotation.segmentPath).absoluteFilePath());
+    _compressionPool.start(new SegmentCompressionJob(this, manifestPath, rotation.segmentPath));
+    return true;
+}
+
+void LogLifecycleManager::segmentCompressed(const QString& manifestPath, const QString& segmentPath,
+                                            const QString& partialCompressedPath) {
+    QMutexLocker locker(&_mutex);
+    _compressingSegments.remove(QFileInfo(segmentPath).absoluteFilePath());
+
+    if (partialCompressedPath.isEmpty()) {
+        return;
+    }
+
+    // swapped under the lock, so retention never finds a zip the manifest doesn't list yet
+    QString compressedPath = partialCompressedPath.left(partialCompressedPath.size() - PARTIAL_SUFFIX.size());
+    if (!QFile::rename(partialCompressedPath, compressedPath)) {
+        qDebug() << "Failed to compress log segment" << segmentPath;
+        QFile::remove(partialCompressedPath);
+        return;
+    }
+    QFile::remove(segmentPath);
+
+    QString segmentName = QFileInfo(segmentPath).fileName();
+    QString compressedName = QFileInfo(compressedPath).fileName();
+
+    QJsonObject manifest = readManifest(manifestPath);
+    QJsonArray segments = manifest[MANIFEST_SEGMENTS_KEY].toArray();
+
+    for (int i = 0; i < segments.size(); ++i) {
+        QJsonObject segment = segments[i].toObject();
+        if (segment[SEGMENT_FILE_KEY].toString() == segmentName) {
+            segment[SEGMENT_FILE_KEY] = compressedName;
+            segment[SEGMENT_COMPRESSED_KEY] = true;
+            segments[i] = segment;
+            break;
+        }
+    }
+
+    manifest[MANIFEST_SEGMENTS_KEY] = segments;
+    writeManifest(manifestPath, manifest);
+}
+
+static bool isOlderFile(const QFileInfo& first, const QFileInfo& second) {
+    return first.lastModified() < second.lastModified();
+}
+
+QFileInfoList LogLifecycleManager::findLogFiles(const QString& logsPath, const QStringList& nameFilters) {
+    // stacks beyond the first keep their logs in subdirectories of the shared logs path
+    QFileInfoList logFiles;
+    QDirIterator it(logsPath, nameFilters, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        logFiles << it.fileInfo();
+    }
+
+    // oldest first
+    std::sort(logFiles.begin(), logFiles.end(), isOlderFile);
+    return logFiles;
+}
+
+void LogLifecycleManager::applyRetention() {
+    QMutexLocker locker(&_mutex);
+
+    QFileInfoList logFiles = findLogFiles(_logsPath, QStringList() << "*_stdout_*" << "*_stderr_*");
+
+    QDateTime oldestAllowed = QDateTime::currentDateTime().addDays(-_policy.retentionDays);
+    QFileInfoList candidates;
+    qint64 totalBytes = 0;
+
+    foreach(const QFileInfo& logFile, logFiles) {
+        if (logFile.fileName().endsWith(MANIFEST_SUFFIX) || logFile.fileName().endsWith(PARTIAL_SUFFIX)) {
+            continue;
+        }
+
+        totalBytes += logFile.size();
+
+        // anything a child is still writing to, or the worker is still zipping, is never expired
+        if (!_activeLogStarts.contains(logFile.absoluteFilePath())
+            && !_compressingSegments.contains(logFile.absoluteFilePath())) {
+            candidates << logFile;
+        }
+    }
+
+    int remainingCount = candidates.size();
+    int removedCount = 0;
+
+    // candidates are oldest first, so stop as soon as the oldest one is allowed to stay
+    foreach(const QFileInfo& candidate, candidates) {
+        if (candidate.lastModified() >= oldestAllowed && remainingCount <= _policy.retentionFileCount
+            && totalBytes <= _policy.retentionTotalBytes) {
+            break;
+        }
+
+        if (QFile::remove(candidate.absoluteFilePath())) {
+            --remainingCount;
+            ++removedCount;
+            totalBytes -= candidate.size();
+        }
+    }
+
+    if (removedCount > 0) {
+        qDebug() << "Log retention removed" << removedCount << "files.";
+
+        foreach(const QFileInfo& manifestFile, findLogFiles(_logsPath, QStringList() << "*" + MANIFEST_SUFFIX)) {
+            pruneManifest(manifestFile.absoluteFilePath());
+        }
+    }
+}
+
+void LogLifecycleManager::pruneManifest(const QString& manifestPath) {
+    QJsonObject manifest = readManifest(manifestPath);
+    QJsonArray segments = manifest[MANIFEST_SEGMENTS_KEY].toArray();
+    QJsonArray remainingSegments;
+    QString directory = QFileInfo(manifestPath).absolutePath() + "/";
+
+    foreach(const QJsonValue& segment, segments) {
+        if (QFile::exists(directory + segment.toObject()[SEGMENT_FILE_KEY].toString())) {
+            remainingSegments.append(segment);
+        }
+    }
+
+    QString logPath = manifestPath.left(manifestPath.size() - MANIFEST_SUFFIX.size()) + LOG_SUFFIX;
+
+    if (remainingSegments.isEmpty() && !QFile::exists(logPath)) {
+        QFile::remove(manifestPath);
+    } else if (remainingSegments.size() != segments.size()) {
+        manifest[MANIFEST_SEGMENTS_KEY] = remainingSegments;
+        writeManifest(manifestPath, manifest);
+    }
+}
+
+QString LogLifecycleManager::manifestPathForLog(const QString& path) {
+    return path.left(path.size() - LOG_SUFFIX.size()) + MANIFEST_SUFFIX;
+}
+
+QStringList LogLifecycleManager::segmentsForLog(const QString& path) {
+    QStringList segmentPaths;
+    QString directory = QFileInfo(path).absolutePath() + "/";
+
+    foreach(const QJsonValue& segment, readManifest(manifestPathForLog(path))[MANIFEST_SEGMENTS_KEY].toArray()) {
+        segmentPaths << directory + segment.toObject()[SEGMENT_FILE_KEY].toString();
+    }
+
+    return segmentPaths;
+}
+
+static bool isOlderLog(const QFileInfoList& first, const QFileInfoList& second) {
+    return first.last().lastModified() < second.last().lastModified();
+}
+
+QList<QFileInfoList> LogLifecycleManager::findChildLogs(const QString& logsPath) {
+    // segments are only known from their log's manifest, so nothing has to guess from file names
+    QHash<QString, QFileInfoList> segmentsByLog;
+    QSet<QString> segmentPaths;
+
+    foreach(const QFileInfo& manifestFile, findLogFiles(logsPath, QStringList() << "*" + MANIFEST_SUFFIX)) {
+        QString manifestPath = manifestFile.absoluteFilePath();
+        QString logPath = manifestPath.left(manifestPath.size() - MANIFEST_SUFFIX.size()) + LOG_SUFFIX;
+
+        foreach(const QString& segmentPath, segmentsForLog(logPath)) {
+            QFileInfo segmentFile(segmentPath);
+            if (segmentFile.exists()) {
+                segmentsByLog[logPath] << segmentFile;
+                segmentPaths.insert(segmentFile.absoluteFilePath());
+            }
+        }
+    }
+
+    QList<QFileInfoList> logs;
+    QStringList liveFilters = QStringList() << "*_stdout_*" + LOG_SUFFIX << "*_stderr_*" + LOG_SUFFIX;
+
+    foreach(const QFileInfo& logFile, findLogFiles(logsPath, liveFilters)) {
+        QString logPath = logFile.absoluteFilePath();
+        if (!segmentPaths.contains(logPath)) {
+            logs << (segmentsByLog.take(logPath) << logFile);
+        }
+    }
+
+    // logs whose live file was expired before their segments
+    foreach(const QFileInfoList& segments, segmentsByLog) {
+        if (!segments.isEmpty()) {
+            logs << segments;
+        }
+    }
+
+    std::sort(logs.begin(), logs.end(), isOlderLog);
+    return logs;
+}
+
+bool LogLifecycleManager::isCompressedSegment(const QString& path) {
+    return path.endsWith(COMPRESSED_SUFFIX);
+}
+
+bool LogLifecycleManager::isLiveLog(const QString& path) {
+    if (!path.endsWith(LOG_SUFFIX)) {
+        return false;
+    }
+
+    // segments are named <log>.<n>.txt, but only the log's manifest says whether this is one
+    QRegularExpressionMatch segmentMatch = SEGMENT_NAME_PATTERN.match(path);
+    if (segmentMatch.hasMatch()) {
+        QString absolutePath = QFileInfo(path).absoluteFilePath();
+        foreach(const QString& segmentPath, segmentsForLog(segmentMatch.captured(1) + LOG_SUFFIX)) {
+            if (QFileInfo(segmentPath).absoluteFilePath() == absolutePath) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+QByteArray LogLifecycleManager::readCompressedSegment(const QString& path) {
+    QuaZip zip(path);
+    if (!zip.open(QuaZip::mdUnzip) || !zip.goToFirstFile()) {
+        return QByteArray();
+    }
+
+    QuaZipFile zipFile(&zip);
+    if (!zipFile.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    QByteArray data = zipFile.readAll();
+    zipFile.close();
+    zip.close();
+    return data;
+}
@@ -0,0 +1,96 @@
+//
+//  LogLifecycleManager.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_LogLifecycleManager_h
+#define hifi_LogLifecycleManager_h
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFileInfoList>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+
+struct LogLifecyclePolicy {
+    LogLifecyclePolicy();
+
+    qint64 maxSegmentBytes;
+    int maxSegmentAgeSecs;
+    int retentionDays;
+    int retentionFileCount;
+    qint64 retentionTotalBytes;
+};
+
+// Rotates, compresses and expires the stdout/stderr files of child processes.
+//
+// Children write to their files directly and keep them open with O_APPEND, so a rename would not
+// move their output anywhere: rotation is copy-then-truncate. The bulk of the copy and the zip
+// run on a worker; the GUI thread only appends what was written during the copy and truncates.
+// Each live file has a <name>.segments.json manifest listing its segments in order so readers
+// can find them without scanning.
+class LogLifecycleManager : public QObject
+{
+    Q_OBJECT
+public:
+    LogLifecycleManager(const QString& logsPath, const LogLifecyclePolicy& policy, QObject* parent = 0);
+    ~LogLifecycleManager();
+
+    void registerActiveLog(const QString& path);
+    void releaseActiveLog(const QString& path);
+
+    // true once the live file has been truncated, so its reader has to start from the top
+    bool rotateIfNeeded(const QString& path);
+
+    static QFileInfoList findLogFiles(const QString& logsPath, const QStringList& nameFilters);
+    static QStringList segmentsForLog(const QString& path);
+
+    // every child log under logsPath, oldest first, each as its segments in order followed by
+    // the live file if it is still there
+    static QList<QFileInfoList> findChildLogs(const QString& logsPath);
+    static bool isCompressedSegment(const QString& path);
+
+    // a live file can be truncated by a rotation at any moment, so it must never be mapped
+    static bool isLiveLog(const QString& path);
+    static QByteArray readCompressedSegment(const QString& path);
+
+public slots:
+    void applyRetention();
+
+private:
+    friend class SegmentCopyJob;
+    friend class SegmentCompressionJob;
+
+    struct PendingRotation {
+        QString segmentPath;
+        qint64 copiedBytes; // -1 until the worker is done, -2 if it failed
+    };
+
+    static QString manifestPathForLog(const QString& path);
+
+    void segmentCopied(const QString& path, const QString& partialPath, qint64 copiedBytes);
+    bool finishRotation(const QString& path, const PendingRotation& rotation);
+    void segmentCompressed(const QString& manifestPath, const QString& segmentPath, const QString& partialCompressedPath);
+    void pruneManifest(const QString& manifestPath);
+
+    QString _logsPath;
+    LogLifecyclePolicy _policy;
+
+    QMutex _mutex;
+    QHash<QString, QDateTime> _activeLogStarts;
+    QHash<QString, PendingRotation> _pendingRotations;
+    QSet<QString> _compressingSegments;
+
+    QThreadPool _compressionPool;
+    QTimer _retentionTimer;
+};
+
+#endif
@@ -0,0 +1,233 @@
+//
+//  LogLineParser.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "LogLineParser.h"
+
+#include <QDate>
+#include <QDateTime>
+#include <QRegularExpression>
+
+#include <cstring>
+
+const int MSECS_PER_SECOND = 1000;
+const int MSECS_PER_MINUTE = 60 * MSECS_PER_SECOND;
+const int MSECS_PER_HOUR = 60 * MSECS_PER_MINUTE;
+
+static bool readNumber(const char* text, int digits, int& value) {
+    value = 0;
+    for (int i = 0; i < digits; ++i) {
+        if (text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (text[i] - '0');
+    }
+    return true;
+}
+
+LogLineParser::LogLineParser(int defaultYear) :
+    _defaultYear(defaultYear > 0 ? defaultYear : QDate::currentDate().year()),
+    _cachedYear(0),
+    _cachedMonth(0),
+    _cachedDay(0),
+    _cachedDayMSecs(0)
+{
+}
+
+bool LogLineParser::parse(const char* line, int length, ParsedLogLine& parsed) {
+    parsed.timestamp = 0;
+    parsed.level = LogLevelUnknown;
+    parsed.categoryStart = 0;
+    parsed.categoryLength = 0;
+    parsed.messageStart = 0;
+
+    int position = 0;
+
+    if (length > 0 && line[0] == '[') {
+        const char* close = static_cast<const char*>(memchr(line + 1, ']', length - 1));
+        if (close) {
+            parsed.timestamp = parseTimestamp(line + 1, close - line - 1);
+            if (parsed.timestamp > 0) {
+                position = close - line + 1;
+            }
+        }
+    }
+
+    // the level is the next bracketed token, if there is one
+    while (position < length && line[position] == ' ') {
+        ++position;
+    }
+
+    if (position < length && line[position] == '[') {
+        const char* close = static_cast<const char*>(memchr(line + position + 1, ']', length - position - 1));
+        if (close) {
+            LogLevel level = levelFromName(line + position + 1, close - line - position - 1);
+            if (level != LogLevelUnknown) {
+                parsed.level = level;
+                position = close - line + 1;
+            }
+        }
+    }
+
+    if (parsed.timestamp == 0 && parsed.level == LogLevelUnknown) {
+        return false;
+    }
+
+    // then an optional numeric pid and the target or category name
+    while (position < length) {
+        while (position < length && line[position] == ' ') {
+            ++position;
+        }
+
+        if (position >= length || line[position] != '[') {
+            break;
+        }
+
+        const char* close = static_cast<const char*>(memchr(line + position + 1, ']', length - position - 1));
+        int tokenLength = close ? close - line - position - 1 : 0;
+        if (tokenLength == 0) {
+            break;
+        }
+
+        int pid;
+        bool isPID = tokenLength <= 9 && readNumber(line + position + 1, tokenLength, pid);
+        if (!isPID) {
+            parsed.categoryStart = position + 1;
+            parsed.categoryLength = tokenLength;
+        }
+
+        position = close - line + 1;
+        if (!isPID) {
+            break;
+        }
+    }
+
+    if (position < length && line[position] == ' ') {
+        ++position;
+    }
+
+    parsed.messageStart = position;
+    return true;
+}
+
+qint64 LogLineParser::parseTimestamp(const char* text, int length) {
+    int year = _defaultYear;
+    int month, day, hour, minute, second;
+    int msecs = 0;
+    int timeStart;
+
+    if (length >= 14 && text[2] == '/' && text[5] == ' ') {
+        // hifi processes: MM/dd hh:mm:ss
+        if (!readNumber(text, 2, month) || !readNumber(text + 3, 2, day)) {
+            return 0;
+        }
+        timeStart = 6;
+    } else if (length >= 19 && text[2] == '/' && text[5] == '/') {
+        // the Stack Manager itself: dd/MM/yyyy hh:mm:ss
+        if (!readNumber(text, 2, day) || !readNumber(text + 3, 2, month) || !readNumber(text + 6, 4, year)) {
+            return 0;
+        }
+        timeStart = 11;
+    } else if (length >= 19 && text[4] == '-' && text[7] == '-') {
+        // ISO 8601: yyyy-MM-ddThh:mm:ss[.zzz]
+        if (!readNumber(text, 4, year) || !readNumber(text + 5, 2, month) || !readNumber(text + 8, 2, day)) {
+            return 0;
+        }
+        timeStart = 11;
+    } else {
+        return 0;
+    }
+
+    const char* time = text + timeStart;
+    if (!readNumber(time, 2, hour) || time[2] != ':' || !readNumber(time + 3, 2, minute)
+        || time[5] != ':' || !readNumber(time + 6, 2, second)) {
+        return 0;
+    }
+
+    if (length >= timeStart + 12 && time[8] == '.') {
+        readNumber(time + 9, 3, msecs);
+    }
+
+    qint64 dayMSecs = msecsAtStartOfDay(year, month, day);
+    if (dayMSecs == 0) {
+        return 0;
+    }
+
+    return dayMSecs + hour * MSECS_PER_HOUR + minute * MSECS_PER_MINUTE + second * MSECS_PER_SECOND + msecs;
+}
+
+qint64 LogLineParser::msecsAtStartOfDay(int year, int month, int day) {
+    // consecutive lines almost always share a day, so only go through QDateTime when it changes
+    if (year != _cachedYear || month != _cachedMonth || day != _cachedDay) {
+        QDate date(year, month, day);
+        if (!date.isValid()) {
+            return 0;
+        }
+
+        _cachedYear = year;
+        _cachedMonth = month;
+        _cachedDay = day;
+        _cachedDayMSecs = QDateTime(date).toMSecsSinceEpoch();
+    }
+
+    return _cachedDayMSecs;
+}
+
+int LogLineParser::yearFromLogFilename(const QString& filename) {
+    // BackgroundProcess names files <program>-<n>_<stream>_yyyy-MM-dd_hh.mm.ss_<start>.txt
+    static const QRegularExpression FILENAME_DATE_REGEX("_(\\d{4})-\\d{2}-\\d{2}_");
+
+    QRegularExpressionMatch match = FILENAME_DATE_REGEX.match(filename);
+    return match.hasMatch() ? match.captured(1).toInt() : 0;
+}
+
+LogLevel LogLineParser::levelFromName(const char* name, int length) {
+    switch (length) {
+        case 4:
+            if (memcmp(name, "INFO", 4) == 0) {
+                return LogLevelInfo;
+            }
+            break;
+        case 5:
+            if (memcmp(name, "DEBUG", 5) == 0) {
+                return LogLevelDebug;
+            } else if (memcmp(name, "ERROR", 5) == 0) {
+                return LogLevelCritical;
+            } else if (memcmp(name, "FATAL", 5) == 0) {
+                return LogLevelFatal;
+            }
+            break;
+        case 7:
+            if (memcmp(name, "WARNING", 7) == 0) {
+                return LogLevelWarning;
+            }
+            break;
+        case 8:
+            if (memcmp(name, "CRITICAL", 8) == 0) {
+                return LogLevelCritical;
+            }
+            break;
+    }
+
+    return LogLevelUnknown;
+}
+
+QString LogLineParser::nameForLevel(LogLevel level) {
+    switch (level) {
+        case LogLevelDebug:
+            return "DEBUG";
+        case LogLevelInfo:
+            return "INFO";
+        case LogLevelWarning:
+            return "WARNING";
+        case LogLevelCritical:
+            return "CRITICAL";
+        case LogLevelFatal:
+            return "FATAL";
+        default:
+            return QString();
+    }
+}
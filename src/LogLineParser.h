@@ -0,0 +1,61 @@
+//
+//  LogLineParser.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_LogLineParser_h
+#define hifi_LogLineParser_h
+
+#include <QString>
+
+enum LogLevel {
+    LogLevelUnknown = 0,
+    LogLevelDebug,
+    LogLevelInfo,
+    LogLevelWarning,
+    LogLevelCritical,
+    LogLevelFatal
+};
+
+inline quint8 logLevelBit(LogLevel level) { return 1 << level; }
+const quint8 ALL_LOG_LEVELS = 0x3F;
+
+struct ParsedLogLine {
+    qint64 timestamp; // msecs since epoch, 0 when the line has no timestamp prefix
+    LogLevel level;
+    int categoryStart;
+    int categoryLength; // 0 when the line names no category
+    int messageStart;
+};
+
+// Splits the "[timestamp] [LEVEL] [pid] [category] message" prefix hifi processes put on their
+// output, where everything after the level is optional.
+// Works on raw bytes so it can run straight over mapped files without a QString per line.
+class LogLineParser
+{
+public:
+    explicit LogLineParser(int defaultYear = 0);
+
+    void setDefaultYear(int year) { _defaultYear = year; }
+    int getDefaultYear() const { return _defaultYear; }
+
+    bool parse(const char* line, int length, ParsedLogLine& parsed);
+
+    static int yearFromLogFilename(const QString& filename);
+    static LogLevel levelFromName(const char* name, int length);
+    static QString nameForLevel(LogLevel level);
+
+private:
+    qint64 parseTimestamp(const char* text, int length);
+    qint64 msecsAtStartOfDay(int year, int month, int day);
+
+    int _defaultYear;
+    int _cachedYear;
+    int _cachedMonth;
+    int _cachedDay;
+    qint64 _cachedDayMSecs;
+};
+
+#endif
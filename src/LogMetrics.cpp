@@ -0,0 +1,296 @@
+//
+//  LogMetrics.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "LogMetrics.h"
+#include "LogCounterMatcher.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+#include <cstring>
+
+const int SAMPLE_INTERVAL_MS = 1000;
+const int WINDOW_SECONDS = 60;
+
+const int DEFAULT_THRESHOLD_WINDOW_SECS = 10;
+const double DEFAULT_MAX_ERRORS_PER_SECOND = 1.0;
+const double DEFAULT_MAX_WARNINGS_PER_SECOND = 50.0;
+
+const QString COUNTERS_KEY = "counters";
+const QString COUNTER_NAME_KEY = "name";
+const QString COUNTER_PATTERN_KEY = "pattern";
+const QString THRESHOLDS_KEY = "thresholds";
+const QString THRESHOLD_METRIC_KEY = "metric";
+const QString THRESHOLD_MAX_KEY = "maxPerSecond";
+const QString THRESHOLD_WINDOW_KEY = "window";
+
+LogMetrics::LogMetrics(QObject* parent) :
+    QObject(parent),
+    _counterMatcher(NULL),
+    _nextSourceID(0),
+    _currentBucket(WINDOW_SECONDS - 1),
+    _filledBuckets(0)
+{
+    _metricNames << "lines" << "bytes" << "warnings" << "errors";
+
+    LogThreshold errorThreshold = { ErrorsMetric, DEFAULT_MAX_ERRORS_PER_SECOND, DEFAULT_THRESHOLD_WINDOW_SECS };
+    LogThreshold warningThreshold = { WarningsMetric, DEFAULT_MAX_WARNINGS_PER_SECOND, DEFAULT_THRESHOLD_WINDOW_SECS };
+    _thresholds << errorThreshold << warningThreshold;
+
+    _sampleTimer.setInterval(SAMPLE_INTERVAL_MS);
+    connect(&_sampleTimer, &QTimer::timeout, this, &LogMetrics::sample);
+    _sampleTimer.start();
+}
+
+bool LogMetrics::loadConfiguration(const QString& path) {
+    Q_ASSERT(_sources.isEmpty());
+
+    QFile configFile(path);
+    if (!configFile.open(QIODevice::ReadOnly)) {
+        qDebug() << "Could not open metrics configuration" << path;
+        return false;
+    }
+
+    QJsonObject config = QJsonDocument::fromJson(configFile.readAll()).object();
+
+    foreach(const QJsonValue& value, config[COUNTERS_KEY].toArray()) {
+        QJsonObject counter = value.toObject();
+        QRegularExpression pattern(counter[COUNTER_PATTERN_KEY].toString());
+
+        if (counter[COUNTER_NAME_KEY].toString().isEmpty() || !pattern.isValid()) {
+            qDebug() << "Skipping invalid log counter" << counter;
+            continue;
+        }
+
+        pattern.optimize();
+        _counterPatterns << pattern;
+        _metricNames << counter[COUNTER_NAME_KEY].toString();
+    }
+
+    if (config.contains(THRESHOLDS_KEY)) {
+        _thresholds.clear();
+
+        foreach(const QJsonValue& value, config[THRESHOLDS_KEY].toArray()) {
+            QJsonObject thresholdObject = value.toObject();
+
+            LogThreshold threshold;
+            threshold.metric = _metricNames.indexOf(thresholdObject[THRESHOLD_METRIC_KEY].toString());
+            threshold.maxPerSecond = thresholdObject[THRESHOLD_MAX_KEY].toDouble();
+            threshold.windowSecs = qBound(1, thresholdObject[THRESHOLD_WINDOW_KEY].toInt(DEFAULT_THRESHOLD_WINDOW_SECS),
+                                          WINDOW_SECONDS);
+
+            if (threshold.metric < 0) {
+                qDebug() << "Skipping threshold on unknown metric" << thresholdObject[THRESHOLD_METRIC_KEY].toString();
+                continue;
+            }
+
+            _thresholds << threshold;
+        }
+    }
+
+    return true;
+}
+
+void LogMetrics::setCounterThread(QThread* thread) {
+    if (_counterPatterns.isEmpty() || _counterMatcher) {
+        return;
+    }
+
+    _counterMatcher = new LogCounterMatcher(_counterPatterns);
+    _counterMatcher->moveToThread(thread);
+    connect(thread, &QThread::finished, _counterMatcher, &QObject::deleteLater);
+
+    connect(this, &LogMetrics::countersRequested, _counterMatcher, &LogCounterMatcher::match);
+    connect(_counterMatcher, &LogCounterMatcher::matched, this, &LogMetrics::addCounterMatches);
+}
+
+void LogMetrics::addSource(const QString& name, const LogStore* store) {
+    Source source;
+    source.id = _nextSourceID++;
+    source.name = name;
+    source.store = store;
+    source.generation = store->getGeneration();
+    source.nextLine = store->getEndLine();
+    source.appendedBytes = store->getAppendedBytes();
+    source.buckets.fill(0, WINDOW_SECONDS * _metricNames.size());
+    source.totals.fill(0, _metricNames.size());
+    source.crossedThresholds.fill(false, _thresholds.size());
+
+    _sources.append(source);
+}
+
+void LogMetrics::removeSource(const LogStore* store) {
+    for (int i = 0; i < _sources.size(); ++i) {
+        if (_sources[i].store == store) {
+            if (isAlerting(i)) {
+                emit alertStateChanged(store, false);
+            }
+            _sources.remove(i);
+            return;
+        }
+    }
+}
+
+void LogMetrics::sample() {
+    _currentBucket = (_currentBucket + 1) % WINDOW_SECONDS;
+    _filledBuckets = qMin(_filledBuckets + 1, WINDOW_SECONDS);
+
+    int metricCount = _metricNames.size();
+
+    for (int i = 0; i < _sources.size(); ++i) {
+        quint32* bucket = _sources[i].buckets.data() + _currentBucket * metricCount;
+        memset(bucket, 0, metricCount * sizeof(quint32));
+
+        countNewLines(_sources[i], bucket);
+
+        for (int metric = 0; metric < metricCount; ++metric) {
+            _sources[i].totals[metric] += bucket[metric];
+        }
+
+        checkThresholds(i);
+    }
+
+    emit sampled();
+}
+
+void LogMetrics::countNewLines(Source& source, quint32* bucket) {
+    const LogStore* store = source.store;
+
+    if (store->getGeneration() != source.generation) {
+        source.generation = store->getGeneration();
+        source.nextLine = store->getFirstLine();
+    }
+
+    source.nextLine = qMax(source.nextLine, store->getFirstLine());
+    int endLine = store->getEndLine();
+
+    bucket[BytesMetric] = quint32(store->getAppendedBytes() - source.appendedBytes);
+    source.appendedBytes = store->getAppendedBytes();
+    bucket[LinesMetric] = endLine - source.nextLine;
+
+    for (int line = source.nextLine; line < endLine; ++line) {
+        // continuation lines carry their parent's level but aren't another warning or error
+        if (store->isContinuation(line)) {
+            continue;
+        }
+
+        LogLevel level = store->getLevel(line);
+        if (level == LogLevelWarning) {
+            ++bucket[WarningsMetric];
+        } else if (level == LogLevelCritical || level == LogLevelFatal) {
+            ++bucket[ErrorsMetric];
+        }
+    }
+
+    if (_counterMatcher && endLine > source.nextLine) {
+        // copied out, the store's arenas are only safe to read on this thread
+        QByteArray lines;
+        for (int line = source.nextLine; line < endLine; ++line) {
+            if (line > source.nextLine) {
+                lines += '\n';
+            }
+            lines += store->getMessage(line);
+        }
+        emit countersRequested(store, lines);
+    } else if (!_counterMatcher) {
+        for (int line = source.nextLine; line < endLine; ++line) {
+            QString message = QString::fromUtf8(store->getMessage(line));
+
+            for (int counter = 0; counter < _counterPatterns.size(); ++counter) {
+                if (_counterPatterns[counter].match(message).hasMatch()) {
+                    ++bucket[BuiltInMetricCount + counter];
+                }
+            }
+        }
+    }
+
+    source.nextLine = endLine;
+}
+
+void LogMetrics::addCounterMatches(const LogStore* store, const QVector<quint32>& counts) {
+    int metricCount = _metricNames.size();
+
+    for (int i = 0; i < _sources.size(); ++i) {
+        if (_sources[i].store != store) {
+            continue;
+        }
+
+        // the bucket that was current when the lines were sent may have moved on, this one is close enough
+        quint32* bucket = _sources[i].buckets.data() + _currentBucket * metricCount;
+        for (int counter = 0; counter < counts.size(); ++counter) {
+            bucket[BuiltInMetricCount + counter] += counts[counter];
+            _sources[i].totals[BuiltInMetricCount + counter] += counts[counter];
+        }
+        return;
+    }
+}
+
+double LogMetrics::getRate(int source, int metric, int windowSecs) const {
+    int bucketCount = qMin(qMin(windowSecs, WINDOW_SECONDS), _filledBuckets);
+    if (bucketCount == 0) {
+        return 0.0;
+    }
+
+    const QVector<quint32>& buckets = _sources[source].buckets;
+    int metricCount = _metricNames.size();
+    quint64 sum = 0;
+
+    for (int i = 0; i < bucketCount; ++i) {
+        int bucket = (_currentBucket - i + WINDOW_SECONDS) % WINDOW_SECONDS;
+        sum += buckets[bucket * metricCount + metric];
+    }
+
+    return double(sum) / bucketCount;
+}
+
+void LogMetrics::checkThresholds(int sourceIndex) {
+    Source& source = _sources[sourceIndex];
+    bool wasAlerting = isAlerting(sourceIndex);
+
+    for (int i = 0; i < _thresholds.size(); ++i) {
+        const LogThreshold& threshold = _thresholds[i];
+        double perSecond = getRate(sourceIndex, threshold.metric, threshold.windowSecs);
+        bool isCrossed = perSecond > threshold.maxPerSecond;
+
+        if (isCrossed != source.crossedThresholds[i]) {
+            source.crossedThresholds[i] = isCrossed;
+
+            if (isCrossed) {
+                qWarning() << source.name << _metricNames[threshold.metric] << "at" << perSecond
+                    << "per second, above the limit of" << threshold.maxPerSecond;
+                emit thresholdCrossed(source.name, _metricNames[threshold.metric], perSecond, threshold.maxPerSecond);
+            } else {
+                emit thresholdCleared(source.name, _metricNames[threshold.metric]);
+            }
+        }
+    }
+
+    if (isAlerting(sourceIndex) != wasAlerting) {
+        emit alertStateChanged(source.store, !wasAlerting);
+    }
+}
+
+QString LogMetrics::describeAlerts(int source) const {
+    QStringList alerts;
+
+    for (int i = 0; i < _thresholds.size(); ++i) {
+        if (_sources[source].crossedThresholds[i]) {
+            const LogThreshold& threshold = _thresholds[i];
+            alerts << QString("%1: %2/s over %3s (limit %4/s)")
+                .arg(_metricNames[threshold.metric])
+                .arg(getRate(source, threshold.metric, threshold.windowSecs), 0, 'f', 1)
+                .arg(threshold.windowSecs)
+                .arg(threshold.maxPerSecond);
+        }
+    }
+
+    return alerts.join("\n");
+}
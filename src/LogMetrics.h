@@ -0,0 +1,109 @@
+//
+//  LogMetrics.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_LogMetrics_h
+#define hifi_LogMetrics_h
+
+#include <QObject>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+#include "LogStore.h"
+
+class LogCounterMatcher;
+class QThread;
+
+struct LogThreshold {
+    int metric;
+    double maxPerSecond;
+    int windowSecs;
+};
+
+// Per-process rates derived from captured output: lines, bytes, warnings and errors per
+// second plus user-defined regex counters. Once a second the new lines in each LogStore are
+// counted into a 60-slot ring of one-second buckets, so memory is fixed per process no matter
+// how much it logs, and thresholds are checked against the average over their window. Given a
+// counter thread, the regex counters are matched there and land in the bucket that is current
+// when they come back.
+class LogMetrics : public QObject
+{
+    Q_OBJECT
+public:
+    enum BuiltInMetric {
+        LinesMetric = 0,
+        BytesMetric,
+        WarningsMetric,
+        ErrorsMetric,
+        BuiltInMetricCount
+    };
+
+    explicit LogMetrics(QObject* parent = 0);
+
+    bool loadConfiguration(const QString& path);
+
+    // after loadConfiguration, the matcher is deleted when the thread finishes
+    void setCounterThread(QThread* thread);
+
+    void addSource(const QString& name, const LogStore* store);
+    void removeSource(const LogStore* store);
+
+    const QStringList& getMetricNames() const { return _metricNames; }
+    int getSourceCount() const { return _sources.size(); }
+    const QString& getSourceName(int source) const { return _sources[source].name; }
+    // never reused, unlike the index or the store's address
+    int getSourceID(int source) const { return _sources[source].id; }
+    const LogStore* getSourceStore(int source) const { return _sources[source].store; }
+
+    double getRate(int source, int metric, int windowSecs) const;
+    quint64 getTotal(int source, int metric) const { return _sources[source].totals[metric]; }
+    bool isAlerting(int source) const { return _sources[source].crossedThresholds.count(true) > 0; }
+    QString describeAlerts(int source) const;
+
+public slots:
+    void sample();
+
+signals:
+    void sampled();
+    void countersRequested(const LogStore* store, const QByteArray& lines);
+    void thresholdCrossed(const QString& source, const QString& metric, double perSecond, double maxPerSecond);
+    void thresholdCleared(const QString& source, const QString& metric);
+    void alertStateChanged(const LogStore* store, bool isAlerting);
+
+private slots:
+    void addCounterMatches(const LogStore* store, const QVector<quint32>& counts);
+
+private:
+    struct Source {
+        int id;
+        QString name;
+        const LogStore* store;
+        int generation;
+        int nextLine;
+        qint64 appendedBytes;
+        QVector<quint32> buckets; // WINDOW_SECONDS rows of one value per metric
+        QVector<quint64> totals;
+        QVector<bool> crossedThresholds;
+    };
+
+    void countNewLines(Source& source, quint32* bucket);
+    void checkThresholds(int sourceIndex);
+
+    QStringList _metricNames;
+    QVector<QRegularExpression> _counterPatterns;
+    QVector<LogThreshold> _thresholds;
+    LogCounterMatcher* _counterMatcher;
+
+    QVector<Source> _sources;
+    int _nextSourceID;
+    int _currentBucket;
+    int _filledBuckets;
+    QTimer _sampleTimer;
+};
+
+#endif
@@ -0,0 +1,303 @@
+//
+//  LogStore.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "LogStore.h"
+
+#include <QByteArrayMatcher>
+#include <QDateTime>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+const int TIMESTAMP_CHUNK_LINES = 1024;
+const qint32 NO_TIMESTAMP_DELTA = INT_MIN;
+
+const int ARENA_BYTES = 1024 * 1024;
+const qint64 DEFAULT_MAX_MESSAGE_BYTES = 16 * 1024 * 1024;
+
+// a child that never writes a newline still gets its output stored
+const int MAX_PENDING_BYTES = 64 * 1024;
+
+const QString DISPLAY_TIMESTAMP_FORMAT = "MM/dd hh:mm:ss";
+
+LogStore::LogStore(qint64 maxMessageBytes) :
+    _maxMessageBytes(maxMessageBytes > 0 ? maxMessageBytes : DEFAULT_MAX_MESSAGE_BYTES),
+    _generation(0),
+    _appendedBytes(0)
+{
+    clear();
+}
+
+void LogStore::clear() {
+    _streamStates[LogStreamStandardOutput] = StreamState();
+    _streamStates[LogStreamStandardError] = StreamState();
+
+    ++_generation;
+    _firstLine = 0;
+    _levels.clear();
+    _flags.clear();
+    _categories.clear();
+    _timestampDeltas.clear();
+    _messageOffsets.clear();
+    _messageLengths.clear();
+
+    _firstTimestampChunk = 0;
+    _timestampBases.clear();
+
+    _firstArena = 0;
+    _arenas.clear();
+
+    // category 0 is for lines that don't name one
+    _categoryIDs.clear();
+    _categoryNames.clear();
+    _categoryNames << QString();
+}
+
+int LogStore::append(LogStream stream, const char* data, int length) {
+    StreamState& state = _streamStates[stream];
+    int endLineBefore = getEndLine();
+    _appendedBytes += length;
+    int position = 0;
+
+    while (position < length) {
+        const char* newline = static_cast<const char*>(memchr(data + position, '\n', length - position));
+        if (!newline) {
+            state.pending.append(data + position, length - position);
+            if (state.pending.size() >= MAX_PENDING_BYTES) {
+                appendLine(stream, state.pending.constData(), state.pending.size());
+                state.pending.clear();
+            }
+            break;
+        }
+
+        int lineLength = newline - (data + position);
+
+        if (state.pending.isEmpty()) {
+            appendLine(stream, data + position, lineLength);
+        } else {
+            state.pending.append(data + position, lineLength);
+            appendLine(stream, state.pending.constData(), state.pending.size());
+            state.pending.clear();
+        }
+
+        position += lineLength + 1;
+    }
+
+    return getEndLine() - endLineBefore;
+}
+
+void LogStore::appendLine(LogStream stream, const char* line, int length) {
+    if (length > 0 && line[length - 1] == '\r') {
+        --length;
+    }
+
+    StreamState& state = _streamStates[stream];
+    ParsedLogLine parsed;
+    quint8 flags = stream;
+
+    if (_parser.parse(line, length, parsed)) {
+        if (parsed.timestamp > 0) {
+            state.timestamp = parsed.timestamp;
+        }
+        state.level = parsed.level;
+        state.category = parsed.categoryLength > 0
+            ? internCategory(line + parsed.categoryStart, parsed.categoryLength) : 0;
+        line += parsed.messageStart;
+        length -= parsed.messageStart;
+    } else {
+        // stack traces and wrapped messages belong to the line above them
+        flags |= CONTINUATION_FLAG;
+    }
+
+    int lineNumber = getEndLine();
+    if (lineNumber % TIMESTAMP_CHUNK_LINES == 0) {
+        _timestampBases.append(state.timestamp);
+    }
+
+    qint64& base = _timestampBases.last();
+    qint32 delta = NO_TIMESTAMP_DELTA;
+    if (state.timestamp > 0) {
+        if (base == 0) {
+            // the chunk started before any timestamp was seen
+            base = state.timestamp;
+        }
+        delta = qint32(qBound<qint64>(INT_MIN + 1, state.timestamp - base, INT_MAX));
+    }
+
+    _levels.append(state.level);
+    _flags.append(flags);
+    _categories.append(state.category);
+    _timestampDeltas.append(delta);
+    _messageLengths.append(qMin(length, ARENA_BYTES));
+    _messageOffsets.append(storeMessage(line, length));
+
+    if (qint64(_arenas.size()) * ARENA_BYTES > _maxMessageBytes) {
+        dropOldestLines();
+    }
+}
+
+quint16 LogStore::internCategory(const char* name, int length) {
+    QByteArray key = QByteArray::fromRawData(name, length);
+    QHash<QByteArray, quint16>::const_iterator it = _categoryIDs.constFind(key);
+    if (it != _categoryIDs.constEnd()) {
+        return it.value();
+    }
+
+    if (_categoryNames.size() > USHRT_MAX) {
+        return 0;
+    }
+
+    quint16 category = _categoryNames.size();
+    _categoryIDs.insert(QByteArray(name, length), category);
+    _categoryNames << QString::fromUtf8(name, length);
+    return category;
+}
+
+qint64 LogStore::storeMessage(const char* message, int length) {
+    length = qMin(length, ARENA_BYTES);
+
+    // messages never straddle arenas, so an arena can be dropped without touching its neighbour;
+    // a full arena is never used again, not even for an empty line, whose offset would then
+    // belong to the next arena along
+    if (_arenas.isEmpty() || _arenas.last().size() >= ARENA_BYTES || _arenas.last().size() + length > ARENA_BYTES) {
+        _arenas.append(QByteArray());
+        _arenas.last().reserve(ARENA_BYTES);
+    }
+
+    QByteArray& arena = _arenas.last();
+    qint64 offset = qint64(_firstArena + _arenas.size() - 1) * ARENA_BYTES + arena.size();
+    Q_ASSERT(offset / ARENA_BYTES == _firstArena + _arenas.size() - 1);
+    arena.append(message, length);
+    return offset;
+}
+
+void LogStore::dropOldestLines() {
+    while (_arenas.size() > 1 && qint64(_arenas.size()) * ARENA_BYTES > _maxMessageBytes) {
+        qint64 nextArenaOffset = qint64(_firstArena + 1) * ARENA_BYTES;
+
+        // offsets only grow, so the lines still in the oldest arena are a prefix
+        const qint64* offsetsBegin = _messageOffsets.constData();
+        const qint64* offsetsEnd = offsetsBegin + _messageOffsets.size();
+        int keepFrom = std::lower_bound(offsetsBegin, offsetsEnd, nextArenaOffset) - offsetsBegin;
+
+        // drop whole timestamp chunks so the remaining lines keep their bases
+        int newFirstLine = _firstLine + keepFrom;
+        newFirstLine = qMin(getEndLine(),
+                            (newFirstLine + TIMESTAMP_CHUNK_LINES - 1) / TIMESTAMP_CHUNK_LINES * TIMESTAMP_CHUNK_LINES);
+        int droppedLines = newFirstLine - _firstLine;
+
+        _levels.remove(0, droppedLines);
+        _flags.remove(0, droppedLines);
+        _categories.remove(0, droppedLines);
+        _timestampDeltas.remove(0, droppedLines);
+        _messageOffsets.remove(0, droppedLines);
+        _messageLengths.remove(0, droppedLines);
+        _firstLine = newFirstLine;
+
+        int newFirstChunk = newFirstLine / TIMESTAMP_CHUNK_LINES;
+        _timestampBases.remove(0, newFirstChunk - _firstTimestampChunk);
+        _firstTimestampChunk = newFirstChunk;
+
+        int newFirstArena = _messageOffsets.isEmpty()
+            ? _firstArena + _arenas.size() - 1 : int(_messageOffsets.first() / ARENA_BYTES);
+        _arenas.remove(0, newFirstArena - _firstArena);
+        _firstArena = newFirstArena;
+    }
+}
+
+qint64 LogStore::getTimestamp(int line) const {
+    qint32 delta = _timestampDeltas[line - _firstLine];
+    if (delta == NO_TIMESTAMP_DELTA) {
+        return 0;
+    }
+    return _timestampBases[line / TIMESTAMP_CHUNK_LINES - _firstTimestampChunk] + delta;
+}
+
+QByteArray LogStore::getMessage(int line) const {
+    qint64 offset = _messageOffsets[line - _firstLine];
+    const QByteArray& arena = _arenas[offset / ARENA_BYTES - _firstArena];
+    return QByteArray::fromRawData(arena.constData() + offset % ARENA_BYTES, _messageLengths[line - _firstLine]);
+}
+
+QString LogStore::getLineText(int line) const {
+    QString message = QString::fromUtf8(getMessage(line));
+    if (isContinuation(line)) {
+        return message;
+    }
+
+    QString text;
+    qint64 timestamp = getTimestamp(line);
+    if (timestamp > 0) {
+        text += "[" + QDateTime::fromMSecsSinceEpoch(timestamp).toString(DISPLAY_TIMESTAMP_FORMAT) + "] ";
+    }
+
+    LogLevel level = getLevel(line);
+    if (level != LogLevelUnknown) {
+        text += "[" + LogLineParser::nameForLevel(level) + "] ";
+    }
+
+    quint16 category = getCategory(line);
+    if (category != 0) {
+        text += "[" + _categoryNames[category] + "] ";
+    }
+
+    return text + message;
+}
+
+void LogStore::filter(const LogStoreFilter& filter, QVector<int>& lines, int fromLine, int toLine) const {
+    int first = qMax(fromLine, _firstLine) - _firstLine;
+    int end = (toLine < 0 ? getEndLine() : qMin(toLine, getEndLine())) - _firstLine;
+
+    bool filterCategories = !filter.categories.isEmpty();
+    bool filterTime = filter.fromTimestamp > 0 || filter.toTimestamp > 0;
+    QByteArrayMatcher matcher(filter.text);
+
+    const quint8* levels = _levels.constData();
+    const quint8* flags = _flags.constData();
+    const quint16* categories = _categories.constData();
+
+    for (int i = first; i < end; ++i) {
+        if (!(logLevelBit(LogLevel(levels[i])) & filter.levelMask)
+            || !(logStreamBit(LogStream(flags[i] & STREAM_FLAG)) & filter.streamMask)) {
+            continue;
+        }
+
+        if (filterCategories && (categories[i] >= filter.categories.size() || !filter.categories.testBit(categories[i]))) {
+            continue;
+        }
+
+        if (filterTime) {
+            qint64 timestamp = getTimestamp(_firstLine + i);
+            if ((filter.fromTimestamp > 0 && timestamp < filter.fromTimestamp)
+                || (filter.toTimestamp > 0 && timestamp > filter.toTimestamp)) {
+                continue;
+            }
+        }
+
+        if (!filter.text.isEmpty()) {
+            QByteArray message = getMessage(_firstLine + i);
+            if (matcher.indexIn(message.constData(), message.size()) == -1) {
+                continue;
+            }
+        }
+
+        lines.append(_firstLine + i);
+    }
+}
+
+qint64 LogStore::getMemoryUsage() const {
+    qint64 columnBytes = qint64(_levels.capacity()) * sizeof(quint8)
+        + qint64(_flags.capacity()) * sizeof(quint8)
+        + qint64(_categories.capacity()) * sizeof(quint16)
+        + qint64(_timestampDeltas.capacity()) * sizeof(qint32)
+        + qint64(_messageOffsets.capacity()) * sizeof(qint64)
+        + qint64(_messageLengths.capacity()) * sizeof(quint32)
+        + qint64(_timestampBases.capacity()) * sizeof(qint64);
+
+    return columnBytes + qint64(_arenas.size()) * ARENA_BYTES;
+}
@@ -0,0 +1,122 @@
+//
+//  LogStore.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_LogStore_h
+#define hifi_LogStore_h
+
+#include <QBitArray>
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "LogLineParser.h"
+
+enum LogStream {
+    LogStreamStandardOutput = 0,
+    LogStreamStandardError
+};
+
+inline quint8 logStreamBit(LogStream stream) { return 1 << stream; }
+const quint8 ALL_LOG_STREAMS = 0x3;
+
+struct LogStoreFilter {
+    LogStoreFilter() : levelMask(ALL_LOG_LEVELS), streamMask(ALL_LOG_STREAMS), fromTimestamp(0), toTimestamp(0) {}
+
+    quint8 levelMask;
+    quint8 streamMask;
+    QBitArray categories; // empty for every category
+    qint64 fromTimestamp; // 0 for no lower bound
+    qint64 toTimestamp; // 0 for no upper bound
+    QByteArray text;
+};
+
+// Append-only, column-oriented store of one process's parsed output.
+//
+// Each line costs a level, a flags byte (stream, continuation), an interned category id, a
+// 32-bit timestamp delta against a base kept every 1024 lines, and an offset/length into
+// fixed-size message arenas. Filters scan the narrow columns and only touch message bytes for
+// text matches. Line numbers are absolute; once the arenas pass their byte budget the oldest
+// lines are dropped and getFirstLine() moves forward.
+class LogStore
+{
+public:
+    explicit LogStore(qint64 maxMessageBytes = 0);
+
+    void clear();
+
+    int append(LogStream stream, const char* data, int length);
+
+    // bumped by clear(), so readers holding line numbers know to start over
+    int getGeneration() const { return _generation; }
+
+    // every byte ever passed to append(), including partial lines and dropped output
+    qint64 getAppendedBytes() const { return _appendedBytes; }
+
+    int getFirstLine() const { return _firstLine; }
+    int getEndLine() const { return _firstLine + _levels.size(); }
+    int getLineCount() const { return _levels.size(); }
+
+    qint64 getTimestamp(int line) const;
+    LogLevel getLevel(int line) const { return LogLevel(_levels[line - _firstLine]); }
+    LogStream getStream(int line) const { return LogStream(_flags[line - _firstLine] & STREAM_FLAG); }
+    bool isContinuation(int line) const { return _flags[line - _firstLine] & CONTINUATION_FLAG; }
+    quint16 getCategory(int line) const { return _categories[line - _firstLine]; }
+    QByteArray getMessage(int line) const;
+    QString getLineText(int line) const;
+
+    int getCategoryCount() const { return _categoryNames.size(); }
+    const QString& getCategoryName(quint16 category) const { return _categoryNames[category]; }
+
+    void filter(const LogStoreFilter& filter, QVector<int>& lines, int fromLine = 0, int toLine = -1) const;
+
+    qint64 getMemoryUsage() const;
+
+private:
+    static const quint8 STREAM_FLAG = 0x1;
+    static const quint8 CONTINUATION_FLAG = 0x2;
+
+    struct StreamState {
+        StreamState() : timestamp(0), level(LogLevelUnknown), category(0) {}
+
+        QByteArray pending;
+        qint64 timestamp;
+        LogLevel level;
+        quint16 category;
+    };
+
+    void appendLine(LogStream stream, const char* line, int length);
+    quint16 internCategory(const char* name, int length);
+    qint64 storeMessage(const char* message, int length);
+    void dropOldestLines();
+
+    qint64 _maxMessageBytes;
+    LogLineParser _parser;
+    StreamState _streamStates[2];
+
+    int _generation;
+    qint64 _appendedBytes;
+    int _firstLine;
+    QVector<quint8> _levels;
+    QVector<quint8> _flags;
+    QVector<quint16> _categories;
+    QVector<qint32> _timestampDeltas;
+    QVector<qint64> _messageOffsets;
+    QVector<quint32> _messageLengths;
+
+    int _firstTimestampChunk;
+    QVector<qint64> _timestampBases;
+
+    int _firstArena;
+    QVector<QByteArray> _arenas;
+
+    QHash<QByteArray, quint16> _categoryIDs;
+    QStringList _categoryNames;
+};
+
+#endif
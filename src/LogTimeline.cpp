@@ -0,0 +1,317 @@
+//
+//  LogTimeline.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "LogTimeline.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+
+#include <algorithm>
+#include <climits>
+
+const int POLL_INTERVAL_MS = 100;
+const int TIMELINE_CAPACITY = 100000;
+
+// a source that has been silent this long no longer holds back the merge
+const int IDLE_SOURCE_GRACE_MS = 1000;
+
+// a source that floods faster than the others can keep up with is flushed regardless
+const int MAX_PENDING_PER_SOURCE = 20000;
+
+// starting the timeline only backfills the tail of each store, and a poll reads at most this
+// many lines per source, a busy source catches up over the next ticks
+const int MAX_BACKFILL_LINES_PER_SOURCE = 5000;
+const int MAX_LINES_PER_POLL = 5000;
+
+const QString EXPORT_TIMESTAMP_FORMAT = "yyyy-MM-dd hh:mm:ss.zzz";
+
+const QColor SOURCE_COLORS[] = {
+    QColor(3, 150, 126),
+    QColor(189, 54, 78),
+    QColor(52, 101, 164),
+    QColor(196, 128, 0),
+    QColor(117, 80, 123),
+    QColor(78, 154, 6),
+    QColor(204, 0, 153),
+    QColor(6, 152, 154)
+};
+const int SOURCE_COLOR_COUNT = sizeof(SOURCE_COLORS) / sizeof(SOURCE_COLORS[0]);
+
+struct MergeHead {
+    qint64 timestamp;
+    int source;
+};
+
+static bool laterHead(const MergeHead& first, const MergeHead& second) {
+    // ties go to the lower source index so equal timestamps keep a stable order
+    return first.timestamp > second.timestamp
+        || (first.timestamp == second.timestamp && first.source > second.source);
+}
+
+LogTimeline::LogTimeline(QObject* parent) :
+    QObject(parent),
+    _endSequence(0)
+{
+    _entries.reserve(TIMELINE_CAPACITY);
+
+    _pollTimer.setInterval(POLL_INTERVAL_MS);
+    connect(&_pollTimer, &QTimer::timeout, this, &LogTimeline::poll);
+}
+
+void LogTimeline::start() {
+    if (!_pollTimer.isActive()) {
+        // catch up on the recent part of whatever the stores hold from while nobody was looking
+        for (int i = 0; i < _sources.size(); ++i) {
+            Source& source = _sources[i];
+            if (!source.store) {
+                continue;
+            }
+
+            if (source.store->getGeneration() != source.generation) {
+                source.generation = source.store->getGeneration();
+                source.nextLine = source.store->getFirstLine();
+            }
+            source.nextLine = qMax(source.nextLine, source.store->getEndLine() - MAX_BACKFILL_LINES_PER_SOURCE);
+        }
+
+        poll();
+        _pollTimer.start();
+    }
+}
+
+void LogTimeline::stop() {
+    _pollTimer.stop();
+}
+
+int LogTimeline::addSource(const QString& name, const LogStore* store) {
+    Source source;
+    source.name = name;
+    source.color = SOURCE_COLORS[_sources.size() % SOURCE_COLOR_COUNT];
+    source.store = store;
+    source.generation = store->getGeneration();
+    source.nextLine = store->getFirstLine();
+    source.lastTimestamp = 0;
+    source.lastDataMSecs = 0;
+    source.lastSequence = -1;
+
+    _sources.append(source);
+    emit sourcesChanged();
+
+    return _sources.size() - 1;
+}
+
+void LogTimeline::removeSource(const LogStore* store) {
+    for (int i = 0; i < _sources.size(); ++i) {
+        if (_sources[i].store == store) {
+            if (_pollTimer.isActive()) {
+                // pick up its last lines, then let it stop holding back the merge
+                readNewLines(i, QDateTime::currentMSecsSinceEpoch());
+            } else {
+                // nobody is watching, its lines are in its log file
+                _sources[i].pending.clear();
+            }
+            _sources[i].store = NULL;
+            emit sourcesChanged();
+        }
+    }
+
+    pruneSources();
+}
+
+const TimelineEntry& LogTimeline::getEntry(qint64 sequence) const {
+    return _entries[sequence % TIMELINE_CAPACITY];
+}
+
+void LogTimeline::poll() {
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64 endSequenceBefore = _endSequence;
+
+    for (int i = 0; i < _sources.size(); ++i) {
+        if (_sources[i].store) {
+            readNewLines(i, now);
+        }
+    }
+
+    merge(now);
+
+    if (_endSequence != endSequenceBefore) {
+        emit entriesAppended();
+    }
+
+    pruneSources();
+}
+
+void LogTimeline::readNewLines(int sourceIndex, qint64 now) {
+    Source& source = _sources[sourceIndex];
+    const LogStore* store = source.store;
+
+    if (store->getGeneration() != source.generation) {
+        // the process restarted and its store was cleared
+        source.generation = store->getGeneration();
+        source.nextLine = store->getFirstLine();
+    }
+
+    // lines the store dropped before we got to them are gone
+    source.nextLine = qMax(source.nextLine, store->getFirstLine());
+
+    int endLine = qMin(store->getEndLine(), source.nextLine + MAX_LINES_PER_POLL);
+    if (source.nextLine >= endLine) {
+        return;
+    }
+
+    for (int line = source.nextLine; line < endLine; ++line) {
+        TimelineEntry entry;
+        entry.timestamp = store->getTimestamp(line);
+        entry.source = sourceIndex;
+        entry.level = store->getLevel(line);
+
+        if (entry.timestamp == 0) {
+            // output without timestamps is placed at the time it was captured
+            entry.timestamp = now;
+        }
+
+        // keep each source monotonic so its queue head is always its oldest line
+        entry.timestamp = qMax(entry.timestamp, source.lastTimestamp);
+        source.lastTimestamp = entry.timestamp;
+
+        quint16 category = store->getCategory(line);
+        QString message = QString::fromUtf8(store->getMessage(line));
+        entry.text = (category != 0 && !store->isContinuation(line))
+            ? "[" + store->getCategoryName(category) + "] " + message : message;
+
+        source.pending.enqueue(entry);
+    }
+
+    source.nextLine = endLine;
+    source.lastDataMSecs = now;
+}
+
+void LogTimeline::merge(qint64 now) {
+    qint64 watermark = LLONG_MAX;
+    qint64 floodWatermark = 0;
+    QVector<MergeHead> heads;
+
+    for (int i = 0; i < _sources.size(); ++i) {
+        const Source& source = _sources[i];
+
+        if (!source.pending.isEmpty()) {
+            MergeHead head = { source.pending.head().timestamp, i };
+            heads.append(head);
+
+            if (source.pending.size() > MAX_PENDING_PER_SOURCE) {
+                floodWatermark = qMax(floodWatermark,
+                                      source.pending.at(source.pending.size() - MAX_PENDING_PER_SOURCE).timestamp);
+            }
+        }
+
+        if (source.store && now - source.lastDataMSecs < IDLE_SOURCE_GRACE_MS) {
+            watermark = qMin(watermark, source.lastTimestamp);
+        }
+    }
+
+    watermark = qMax(watermark, floodWatermark);
+
+    std::make_heap(heads.begin(), heads.end(), laterHead);
+
+    while (!heads.isEmpty() && heads.first().timestamp <= watermark) {
+        MergeHead head = heads.first();
+        std::pop_heap(heads.begin(), heads.end(), laterHead);
+        heads.removeLast();
+
+        Source& source = _sources[head.source];
+        appendEntry(source.pending.dequeue());
+
+        if (!source.pending.isEmpty()) {
+            MergeHead next = { source.pending.head().timestamp, head.source };
+            heads.append(next);
+            std::push_heap(heads.begin(), heads.end(), laterHead);
+        }
+    }
+}
+
+void LogTimeline::appendEntry(const TimelineEntry& entry) {
+    if (_entries.size() < TIMELINE_CAPACITY) {
+        _entries.append(entry);
+    } else {
+        _entries[_endSequence % TIMELINE_CAPACITY] = entry;
+    }
+    _sources[entry.source].lastSequence = _endSequence;
+    ++_endSequence;
+}
+
+void LogTimeline::pruneSources() {
+    QVector<int> newIndexes(_sources.size());
+    QVector<int> removedSources;
+    qint64 firstSequence = getFirstSequence();
+
+    for (int i = 0; i < _sources.size(); ++i) {
+        const Source& source = _sources[i];
+
+        if (!source.store && source.pending.isEmpty() && source.lastSequence < firstSequence) {
+            newIndexes[i] = -1;
+            removedSources << i;
+        } else {
+            newIndexes[i] = i - removedSources.size();
+        }
+    }
+
+    if (removedSources.isEmpty()) {
+        return;
+    }
+
+    for (int i = removedSources.size() - 1; i >= 0; --i) {
+        _sources.remove(removedSources[i]);
+    }
+
+    // nothing left refers to a removed source, everything after one moves down
+    for (int i = 0; i < _entries.size(); ++i) {
+        _entries[i].source = newIndexes[_entries[i].source];
+    }
+    for (int i = 0; i < _sources.size(); ++i) {
+        QQueue<TimelineEntry>& pending = _sources[i].pending;
+        for (int j = 0; j < pending.size(); ++j) {
+            pending[j].source = i;
+        }
+    }
+
+    // highest first, so each index is still the one the listener knows
+    for (int i = removedSources.size() - 1; i >= 0; --i) {
+        emit sourceRemoved(removedSources[i]);
+    }
+    emit sourcesChanged();
+}
+
+bool LogTimeline::exportTo(const QString& path, const QBitArray& hiddenSources, quint8 levelMask) const {
+    QFile exportFile(path);
+    if (!exportFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qDebug() << "Could not open" << path << "to export the timeline.";
+        return false;
+    }
+
+    QTextStream stream(&exportFile);
+
+    for (qint64 sequence = getFirstSequence(); sequence < _endSequence; ++sequence) {
+        const TimelineEntry& entry = getEntry(sequence);
+        if ((entry.source < hiddenSources.size() && hiddenSources.testBit(entry.source))
+            || !(logLevelBit(entry.level) & levelMask)) {
+            continue;
+        }
+
+        stream << QDateTime::fromMSecsSinceEpoch(entry.timestamp).toString(EXPORT_TIMESTAMP_FORMAT)
+            << " [" << _sources[entry.source].name << "] ";
+
+        if (entry.level != LogLevelUnknown) {
+            stream << "[" << LogLineParser::nameForLevel(entry.level) << "] ";
+        }
+
+        stream << entry.text << "\n";
+    }
+
+    return stream.status() == QTextStream::Ok;
+}
@@ -0,0 +1,93 @@
+//
+//  LogTimeline.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_LogTimeline_h
+#define hifi_LogTimeline_h
+
+#include <QBitArray>
+#include <QColor>
+#include <QObject>
+#include <QQueue>
+#include <QTimer>
+#include <QVector>
+
+#include "LogStore.h"
+
+struct TimelineEntry {
+    qint64 timestamp;
+    int source;
+    LogLevel level;
+    QString text;
+};
+
+// Merges the output of every running process into one time-ordered stream.
+//
+// Each poll pulls new lines from the sources' LogStores into per-source queues, then k-way
+// merges the queue heads up to a watermark: the oldest "latest timestamp" among sources that
+// have spoken recently. A line is only released once no live source can still produce
+// something older, while sources that go quiet stop holding the merge back after a grace
+// period. Merged entries live in a fixed-size ring addressed by an ever-growing sequence number.
+//
+// Polling only runs between start() and stop(), while something is showing the timeline.
+// start() only backfills the tail of each store, and each poll reads a bounded number of lines
+// per source, so neither blocks the UI on a large store. A removed source is dropped once the ring no longer holds any of its lines, and the sources
+// after it move down one index.
+class LogTimeline : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogTimeline(QObject* parent = 0);
+
+    int addSource(const QString& name, const LogStore* store);
+    void removeSource(const LogStore* store);
+
+    int getSourceCount() const { return _sources.size(); }
+    const QString& getSourceName(int source) const { return _sources[source].name; }
+    const QColor& getSourceColor(int source) const { return _sources[source].color; }
+    bool isSourceActive(int source) const { return _sources[source].store != NULL; }
+
+    qint64 getFirstSequence() const { return _endSequence - _entries.size(); }
+    qint64 getEndSequence() const { return _endSequence; }
+    const TimelineEntry& getEntry(qint64 sequence) const;
+
+    bool exportTo(const QString& path, const QBitArray& hiddenSources, quint8 levelMask) const;
+
+public slots:
+    void start();
+    void stop();
+    void poll();
+
+signals:
+    void sourcesChanged();
+    void sourceRemoved(int source);
+    void entriesAppended();
+
+private:
+    struct Source {
+        QString name;
+        QColor color;
+        const LogStore* store;
+        int generation;
+        int nextLine;
+        qint64 lastTimestamp;
+        qint64 lastDataMSecs;
+        qint64 lastSequence;
+        QQueue<TimelineEntry> pending;
+    };
+
+    void readNewLines(int sourceIndex, qint64 now);
+    void merge(qint64 now);
+    void appendEntry(const TimelineEntry& entry);
+    void pruneSources();
+
+    QVector<Source> _sources;
+    QVector<TimelineEntry> _entries;
+    qint64 _endSequence;
+    QTimer _pollTimer;
+};
+
+#endif
@@ -0,0 +1,215 @@
+//
+//  MappedLogFile.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "MappedLogFile.h"
+#include "LogLifecycleManager.h"
+
+#include <QDebug>
+#include <QMetaType>
+
+#include <cstring>
+
+const int LINES_PER_CHECKPOINT = 256;
+const qint64 INDEX_CHUNK_BYTES = 32 * 1024 * 1024;
+const qint64 SNAPSHOT_CHUNK_BYTES = 1024 * 1024;
+
+// keeps a pathological single-line file from turning into one giant QString
+const int MAX_DISPLAY_LINE_BYTES = 4096;
+
+LineIndexBuilder::LineIndexBuilder(const QString& path, int linesPerCheckpoint) :
+    QObject(),
+    _path(path),
+    _linesPerCheckpoint(linesPerCheckpoint),
+    _isCancelled(0)
+{
+}
+
+void LineIndexBuilder::build() {
+    QFile file(_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        emit progress(QVector<qint64>(), 0, 0, true);
+        return;
+    }
+
+    // only what exists when we start is indexed, the file is a closed segment or a private copy
+    qint64 fileSize = file.size();
+    qint64 offset = 0;
+    int lineCount = 0;
+    bool endsWithNewline = true;
+
+    QVector<qint64> checkpoints;
+    checkpoints << 0;
+
+    while (offset < fileSize && !_isCancelled.load()) {
+        qint64 chunkLength = qMin(fileSize - offset, INDEX_CHUNK_BYTES);
+        uchar* chunk = file.map(offset, chunkLength);
+        if (!chunk) {
+            qDebug() << "Could not map" << _path << "at offset" << offset;
+            break;
+        }
+
+        const char* data = reinterpret_cast<const char*>(chunk);
+        const char* end = data + chunkLength;
+        const char* position = data;
+
+        while (position < end) {
+            const char* newline = static_cast<const char*>(memchr(position, '\n', end - position));
+            if (!newline) {
+                break;
+            }
+
+            ++lineCount;
+            if (lineCount % _linesPerCheckpoint == 0) {
+                checkpoints << offset + (newline - data) + 1;
+            }
+            position = newline + 1;
+        }
+
+        endsWithNewline = data[chunkLength - 1] == '\n';
+        file.unmap(chunk);
+
+        offset += chunkLength;
+        emit progress(checkpoints, lineCount, offset, false);
+        checkpoints.clear();
+    }
+
+    if (!endsWithNewline) {
+        // the unterminated last line is still a line
+        ++lineCount;
+    }
+
+    emit progress(checkpoints, lineCount, offset, true);
+}
+
+MappedLogFile::MappedLogFile(const QString& path, QObject* parent) :
+    QObject(parent),
+    _path(path),
+    _file(path),
+    _lineCount(0),
+    _indexedBytes(0),
+    _isIndexComplete(false),
+    _indexThread(NULL),
+    _indexBuilder(NULL)
+{
+    qRegisterMetaType<QVector<qint64> >("QVector<qint64>");
+}
+
+MappedLogFile::~MappedLogFile() {
+    if (_indexThread) {
+        if (_indexBuilder) {
+            _indexBuilder->cancel();
+        }
+        _indexThread->quit();
+        _indexThread->wait();
+    }
+}
+
+bool MappedLogFile::open() {
+    if (LogLifecycleManager::isCompressedSegment(_path)) {
+        QByteArray contents = LogLifecycleManager::readCompressedSegment(_path);
+        if (!_extractedFile.open() || _extractedFile.write(contents) != contents.size() || !_extractedFile.flush()) {
+            qDebug() << "Could not extract" << _path << "for viewing";
+            return false;
+        }
+        _file.setFileName(_extractedFile.fileName());
+    } else if (LogLifecycleManager::isLiveLog(_path)) {
+        // a rotation truncates live files in place, which would fault our mappings, so view a copy
+        QFile liveFile(_path);
+        if (!liveFile.open(QIODevice::ReadOnly) || !_extractedFile.open()) {
+            return false;
+        }
+
+        QByteArray chunk;
+        while (!(chunk = liveFile.read(SNAPSHOT_CHUNK_BYTES)).isEmpty()) {
+            if (_extractedFile.write(chunk) != chunk.size()) {
+                qDebug() << "Could not copy" << _path << "for viewing";
+                return false;
+            }
+        }
+        if (!_extractedFile.flush()) {
+            return false;
+        }
+        _file.setFileName(_extractedFile.fileName());
+    }
+
+    if (!_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    _indexThread = new QThread(this);
+    _indexBuilder = new LineIndexBuilder(_file.fileName(), LINES_PER_CHECKPOINT);
+    _indexBuilder->moveToThread(_indexThread);
+
+    connect(_indexThread, &QThread::started, _indexBuilder, &LineIndexBuilder::build);
+    connect(_indexThread, &QThread::finished, _indexBuilder, &QObject::deleteLater);
+    connect(_indexBuilder, &LineIndexBuilder::progress, this, &MappedLogFile::handleIndexProgress);
+
+    _indexThread->start(QThread::LowPriority);
+    return true;
+}
+
+void MappedLogFile::handleIndexProgress(const QVector<qint64>& checkpoints, int lineCount,
+                                        qint64 indexedBytes, bool isFinished) {
+    _checkpoints += checkpoints;
+    _lineCount = lineCount;
+    _indexedBytes = indexedBytes;
+    _isIndexComplete = isFinished;
+
+    if (isFinished) {
+        // the builder deletes itself once its thread winds down
+        _indexBuilder = NULL;
+        _indexThread->quit();
+    }
+
+    emit indexProgress(lineCount, indexedBytes, isFinished);
+}
+
+QStringList MappedLogFile::readLines(int firstLine, int count) {
+    QStringList lines;
+
+    count = qMin(count, _lineCount - firstLine);
+    if (firstLine < 0 || count <= 0) {
+        return lines;
+    }
+
+    int firstCheckpoint = firstLine / LINES_PER_CHECKPOINT;
+    int endCheckpoint = (firstLine + count) / LINES_PER_CHECKPOINT + 1;
+
+    qint64 start = _checkpoints[firstCheckpoint];
+    qint64 end = endCheckpoint < _checkpoints.size() ? _checkpoints[endCheckpoint] : _indexedBytes;
+
+    uchar* mapped = _file.map(start, end - start);
+    if (!mapped) {
+        return lines;
+    }
+
+    const char* data = reinterpret_cast<const char*>(mapped);
+    const char* dataEnd = data + (end - start);
+    const char* position = data;
+
+    int linesToSkip = firstLine - firstCheckpoint * LINES_PER_CHECKPOINT;
+
+    while (position < dataEnd && lines.size() < count) {
+        const char* newline = static_cast<const char*>(memchr(position, '\n', dataEnd - position));
+        const char* lineEnd = newline ? newline : dataEnd;
+
+        if (linesToSkip > 0) {
+            --linesToSkip;
+        } else {
+            int lineLength = qMin<qint64>(lineEnd - position, MAX_DISPLAY_LINE_BYTES);
+            if (lineLength > 0 && position[lineLength - 1] == '\r') {
+                --lineLength;
+            }
+            lines << QString::fromUtf8(position, lineLength);
+        }
+
+        position = lineEnd + 1;
+    }
+
+    _file.unmap(mapped);
+    return lines;
+}
@@ -0,0 +1,80 @@
+//
+//  MappedLogFile.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_MappedLogFile_h
+#define hifi_MappedLogFile_h
+
+#include <QAtomicInt>
+#include <QFile>
+#include <QObject>
+#include <QStringList>
+#include <QTemporaryFile>
+#include <QThread>
+#include <QVector>
+
+// Scans a file on a worker thread and reports the offset of every Nth line.
+class LineIndexBuilder : public QObject
+{
+    Q_OBJECT
+public:
+    LineIndexBuilder(const QString& path, int linesPerCheckpoint);
+
+    void cancel() { _isCancelled.store(1); }
+
+public slots:
+    void build();
+
+signals:
+    void progress(const QVector<qint64>& checkpoints, int lineCount, qint64 indexedBytes, bool isFinished);
+
+private:
+    QString _path;
+    int _linesPerCheckpoint;
+    QAtomicInt _isCancelled;
+};
+
+// Read-only view of a (possibly multi-GB) log file. Opening is immediate; a sparse line index
+// fills in on a background thread and readLines() maps only the span between the checkpoints
+// around the requested lines, so memory use follows what is on screen rather than the file size.
+// Compressed segments are extracted to a temporary file first and then viewed the same way, as
+// are copies of live files, which a rotation could otherwise truncate underneath the mappings.
+class MappedLogFile : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MappedLogFile(const QString& path, QObject* parent = 0);
+    ~MappedLogFile();
+
+    bool open();
+
+    const QString& getPath() const { return _path; }
+    qint64 getSize() const { return _file.size(); }
+    int getLineCount() const { return _lineCount; }
+    bool isIndexComplete() const { return _isIndexComplete; }
+
+    QStringList readLines(int firstLine, int count);
+
+signals:
+    void indexProgress(int lineCount, qint64 indexedBytes, bool isFinished);
+
+private slots:
+    void handleIndexProgress(const QVector<qint64>& checkpoints, int lineCount, qint64 indexedBytes, bool isFinished);
+
+private:
+    QString _path;
+    QFile _file;
+    QTemporaryFile _extractedFile;
+    QVector<qint64> _checkpoints;
+    int _lineCount;
+    qint64 _indexedBytes;
+    bool _isIndexComplete;
+
+    QThread* _indexThread;
+    LineIndexBuilder* _indexBuilder;
+};
+
+#endif
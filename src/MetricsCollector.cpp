@@ -0,0 +1,227 @@
+//
+//  MetricsCollector.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "MetricsCollector.h"
+
+#include "BackgroundProcess.h"
+#include "HttpClient.h"
+#include "LogMetrics.h"
+#include "MetricsRegistry.h"
+#include "ProcessStats.h"
+#include "StackLauncher.h"
+
+#include <QSet>
+
+const int COLLECT_INTERVAL_MS = 1000;
+
+MetricsCollector::MetricsCollector(MetricsRegistry& registry, QObject* parent) :
+    QObject(parent),
+    _registry(registry),
+    _logMetrics(NULL),
+    _httpClient(NULL)
+{
+    _collectTimer.setInterval(COLLECT_INTERVAL_MS);
+    connect(&_collectTimer, &QTimer::timeout, this, &MetricsCollector::collect);
+    _collectTimer.start();
+}
+
+void MetricsCollector::addProcess(const QString& name, BackgroundProcess* process, const StackLauncher* launcher) {
+    QStringList labels = QStringList() << "process" << name;
+
+    ProcessSeries series;
+    series.process = process;
+    series.launcher = launcher;
+    series.up = _registry.registerSeries(MetricsRegistry::Gauge, "stack_manager_process_up",
+                                         "Whether the stack process is running.", labels);
+    series.starts = _registry.registerSeries(MetricsRegistry::Counter, "stack_manager_process_starts",
+                                             "Times the stack process was started.", labels);
+    series.restarts = _registry.registerSeries(MetricsRegistry::Counter, "stack_manager_process_restarts",
+                                               "Times the stack process was restarted by its restart policy.", labels);
+    series.uptime = _registry.registerSeries(MetricsRegistry::Gauge, "stack_manager_process_uptime_seconds",
+                                             "Time since the stack process last started, 0 while it is down.",
+                                             labels, MetricsRegistry::MSECS_SCALE, "seconds");
+    series.cpu = _registry.registerSeries(MetricsRegistry::Counter, "stack_manager_process_cpu_seconds",
+                                          "User and system CPU time of the stack process.", labels,
+                                          MetricsRegistry::MSECS_SCALE, "seconds");
+    series.resident = _registry.registerSeries(MetricsRegistry::Gauge, "stack_manager_process_resident_memory_bytes",
+                                               "Resident memory of the stack process.", labels, 1, "bytes");
+    series.read = _registry.registerSeries(MetricsRegistry::Counter, "stack_manager_process_read_bytes",
+                                           "Storage reads of the stack process.", labels, 1, "bytes");
+    series.written = _registry.registerSeries(MetricsRegistry::Counter, "stack_manager_process_written_bytes",
+                                              "Storage writes of the stack process.", labels, 1, "bytes");
+    _processes << series;
+
+    if (process->state() == QProcess::Running) {
+        _processes.last().runningTimer.start();
+    }
+
+    connect(process, SIGNAL(stateChanged(QProcess::ProcessState)),
+            SLOT(handleProcessStateChanged(QProcess::ProcessState)));
+}
+
+void MetricsCollector::handleProcessStateChanged(QProcess::ProcessState state) {
+    BackgroundProcess* process = static_cast<BackgroundProcess*>(sender());
+
+    for (int i = 0; i < _processes.size(); ++i) {
+        ProcessSeries& series = _processes[i];
+        if (series.process != process) {
+            continue;
+        }
+
+        if (state == QProcess::Running) {
+            series.runningTimer.start();
+            _registry.add(series.starts);
+
+            // a restarted process counts from zero again, the series carry on from the runs before it
+            series.previousRuns.cpuMSecs += series.currentRun.cpuMSecs;
+            series.previousRuns.readBytes += series.currentRun.readBytes;
+            series.previousRuns.writtenBytes += series.currentRun.writtenBytes;
+            series.currentRun = ProcessTotals();
+        } else if (state == QProcess::NotRunning) {
+            series.runningTimer.invalidate();
+        }
+    }
+}
+
+void MetricsCollector::collect() {
+    for (int i = 0; i < _processes.size(); ++i) {
+        ProcessSeries& series = _processes[i];
+        bool isRunning = series.runningTimer.isValid();
+
+        _registry.set(series.up, isRunning ? 1 : 0);
+        _registry.set(series.uptime, isRunning ? series.runningTimer.elapsed() : 0);
+
+        if (series.launcher) {
+            _registry.set(series.restarts, series.launcher->getRestartCount(series.process));
+        }
+
+        // CPU and I/O stay at their last values once the process is gone, as counters should
+        ProcessSample sample;
+        if (isRunning && ProcessStats::sample(series.process->processId(), sample)) {
+            series.currentRun.cpuMSecs = sample.cpuMSecs;
+            _registry.set(series.cpu, series.previousRuns.cpuMSecs + series.currentRun.cpuMSecs);
+            _registry.set(series.resident, sample.residentBytes);
+            if (sample.readBytes >= 0) {
+                series.currentRun.readBytes = sample.readBytes;
+                series.currentRun.writtenBytes = sample.writtenBytes;
+                _registry.set(series.read, series.previousRuns.readBytes + series.currentRun.readBytes);
+                _registry.set(series.written, series.previousRuns.writtenBytes + series.currentRun.writtenBytes);
+            }
+        } else if (!isRunning) {
+            _registry.set(series.resident, 0);
+        }
+    }
+
+    if (_logMetrics) {
+        collectLogMetrics();
+    }
+
+    if (_httpClient) {
+        collectHttpMetrics();
+    }
+}
+
+void MetricsCollector::collectLogMetrics() {
+    const QStringList& metricNames = _logMetrics->getMetricNames();
+
+    // forget the sources LogMetrics no longer has, their labels are free for new ones
+    QSet<int> sourceIDs;
+    for (int source = 0; source < _logMetrics->getSourceCount(); ++source) {
+        sourceIDs.insert(_logMetrics->getSourceID(source));
+    }
+    QHash<int, LogSeries>::iterator it = _logSeries.begin();
+    while (it != _logSeries.end()) {
+        if (sourceIDs.contains(it.key())) {
+            ++it;
+        } else {
+            it = _logSeries.erase(it);
+        }
+    }
+
+    for (int source = 0; source < _logMetrics->getSourceCount(); ++source) {
+        LogSeries& logSeries = _logSeries[_logMetrics->getSourceID(source)];
+        QVector<int>& series = logSeries.series;
+        if (series.isEmpty()) {
+            logSeries.label = uniqueLogLabel(_logMetrics->getSourceName(source));
+            QStringList labels = QStringList() << "process" << logSeries.label;
+
+            series << _registry.registerSeries(MetricsRegistry::Counter, "stack_manager_log_lines",
+                                               "Lines of output captured from the process.", labels);
+            series << _registry.registerSeries(MetricsRegistry::Counter, "stack_manager_log_bytes",
+                                               "Bytes of output captured from the process.", labels, 1, "bytes");
+            series << _registry.registerSeries(MetricsRegistry::Counter, "stack_manager_log_warnings",
+                                               "Warning lines in the process's output.", labels);
+            series << _registry.registerSeries(MetricsRegistry::Counter, "stack_manager_log_errors",
+                                               "Error lines in the process's output.", labels);
+
+            // the counters from the metrics configuration follow the built-in ones
+            for (int metric = LogMetrics::BuiltInMetricCount; metric < metricNames.size(); ++metric) {
+                series << _registry.registerSeries(MetricsRegistry::Counter, "stack_manager_log_matches",
+                                                   "Output lines matching a configured log counter.",
+                                                   QStringList(labels) << "counter" << metricNames[metric]);
+            }
+        }
+
+        for (int metric = 0; metric < series.size(); ++metric) {
+            _registry.set(series[metric], _logMetrics->getTotal(source, metric));
+        }
+    }
+}
+
+QString MetricsCollector::uniqueLogLabel(const QString& name) const {
+    // two live sources under one name would otherwise store into the same series
+    QString label = name;
+    int suffix = 2;
+
+    bool isTaken = true;
+    while (isTaken) {
+        isTaken = false;
+        foreach(const LogSeries& logSeries, _logSeries) {
+            if (logSeries.label == label) {
+                label = QString("%1 #%2").arg(name).arg(suffix++);
+                isTaken = true;
+                break;
+            }
+        }
+    }
+
+    return label;
+}
+
+void MetricsCollector::collectHttpMetrics() {
+    const QHash<QString, HttpHostMetrics>& hostMetrics = _httpClient->getMetrics();
+
+    QHash<QString, HttpHostMetrics>::const_iterator it = hostMetrics.constBegin();
+    for (; it != hostMetrics.constEnd(); ++it) {
+        QVector<int>& series = _httpSeries[it.key()];
+        if (series.isEmpty()) {
+            QStringList labels = QStringList() << "host" << it.key();
+
+            series << _registry.registerSeries(MetricsRegistry::Counter, "stack_manager_http_requests",
+                                               "HTTP requests made, however many attempts each took.", labels);
+            series << _registry.registerSeries(MetricsRegistry::Counter, "stack_manager_http_retries",
+                                               "HTTP attempts made beyond one per finished request.", labels);
+            series << _registry.registerSeries(MetricsRegistry::Counter, "stack_manager_http_failures",
+                                               "HTTP requests that failed after their last attempt.", labels);
+            series << _registry.registerSeries(MetricsRegistry::Counter, "stack_manager_http_timeouts",
+                                               "HTTP attempts given up on at their deadline or stall timeout.", labels);
+            series << _registry.registerSeries(MetricsRegistry::Counter, "stack_manager_http_received_bytes",
+                                               "HTTP response bytes received.", labels, 1, "bytes");
+            series << _registry.registerSeries(MetricsRegistry::Counter, "stack_manager_http_request_seconds",
+                                               "Time spent on HTTP requests, from first attempt to result.", labels,
+                                               MetricsRegistry::MSECS_SCALE, "seconds");
+        }
+
+        const HttpHostMetrics& metrics = it.value();
+        _registry.set(series[0], metrics.requests);
+        _registry.set(series[1], metrics.attempts - metrics.requests);
+        _registry.set(series[2], metrics.failures);
+        _registry.set(series[3], metrics.timeouts);
+        _registry.set(series[4], metrics.bytesReceived);
+        _registry.set(series[5], metrics.totalLatencyMSecs);
+    }
+}
@@ -0,0 +1,90 @@
+//
+//  MetricsCollector.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_MetricsCollector_h
+#define hifi_MetricsCollector_h
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QProcess>
+#include <QTimer>
+#include <QVector>
+
+class BackgroundProcess;
+class HttpClient;
+class LogMetrics;
+class MetricsRegistry;
+class StackLauncher;
+
+// Copies what the GUI thread knows into the metrics registry once a second: state, restarts,
+// uptime, CPU, memory and I/O of each stack process (CPU and I/O summed over its restarts), the
+// log counters LogMetrics keeps and the HttpClient's per-host totals. Series are registered the
+// first time they are seen and only stored into after that, so scrapes never have to ask the GUI
+// thread for anything.
+class MetricsCollector : public QObject
+{
+    Q_OBJECT
+public:
+    MetricsCollector(MetricsRegistry& registry, QObject* parent = 0);
+
+    // the launcher, when there is one, knows how often the process was restarted
+    void addProcess(const QString& name, BackgroundProcess* process, const StackLauncher* launcher = NULL);
+    void setLogMetrics(LogMetrics* logMetrics) { _logMetrics = logMetrics; }
+    void setHttpClient(HttpClient* httpClient) { _httpClient = httpClient; }
+
+public slots:
+    void collect();
+
+private slots:
+    void handleProcessStateChanged(QProcess::ProcessState state);
+
+private:
+    struct ProcessTotals {
+        ProcessTotals() : cpuMSecs(0), readBytes(0), writtenBytes(0) {}
+
+        qint64 cpuMSecs;
+        qint64 readBytes;
+        qint64 writtenBytes;
+    };
+
+    struct LogSeries {
+        QString label;
+        QVector<int> series;
+    };
+
+    struct ProcessSeries {
+        BackgroundProcess* process;
+        const StackLauncher* launcher;
+        QElapsedTimer runningTimer;
+        ProcessTotals previousRuns;
+        ProcessTotals currentRun;
+        int up;
+        int starts;
+        int restarts;
+        int uptime;
+        int cpu;
+        int resident;
+        int read;
+        int written;
+    };
+
+    void collectLogMetrics();
+    QString uniqueLogLabel(const QString& name) const;
+    void collectHttpMetrics();
+
+    MetricsRegistry& _registry;
+    QList<ProcessSeries> _processes;
+    LogMetrics* _logMetrics;
+    QHash<int, LogSeries> _logSeries; // by LogMetrics source ID
+    HttpClient* _httpClient;
+    QHash<QString, QVector<int> > _httpSeries;
+    QTimer _collectTimer;
+};
+
+#endif
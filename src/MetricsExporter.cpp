@@ -0,0 +1,146 @@
+//
+//  MetricsExporter.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "MetricsExporter.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include "MetricsRegistry.h"
+
+const QByteArray METRICS_PATH = "/metrics";
+const QByteArray METRICS_CONTENT_TYPE = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+// nothing a scraper sends comes close, anything bigger is not a scraper
+const int MAX_REQUEST_HEADER_BYTES = 16 * 1024;
+
+const int INITIAL_BODY_BYTES = 64 * 1024;
+
+MetricsExporter::MetricsExporter(MetricsRegistry& registry, quint16 port, QObject* parent) :
+    QObject(parent),
+    _registry(registry),
+    _port(port),
+    _server(NULL)
+{
+    _body.reserve(INITIAL_BODY_BYTES);
+
+    _scrapesSeries = _registry.registerSeries(MetricsRegistry::Counter, "stack_manager_metrics_scrapes",
+                                              "Scrapes of the metrics endpoint.");
+    _renderSeries = _registry.registerSeries(MetricsRegistry::Gauge, "stack_manager_metrics_render_seconds",
+                                             "Time the previous scrape took to render.", QStringList(),
+                                             1000 * 1000, "seconds");
+}
+
+void MetricsExporter::start() {
+    _server = new QTcpServer(this);
+    connect(_server, &QTcpServer::newConnection, this, &MetricsExporter::handleNewConnection);
+
+    // only for this host, the endpoint has no authentication
+    if (!_server->listen(QHostAddress::LocalHost, _port)) {
+        qWarning() << "Could not serve metrics on port" << _port << "-" << _server->errorString();
+        return;
+    }
+
+    _port = _server->serverPort();
+    qDebug() << "Serving metrics at" << QString("http://127.0.0.1:%1%2").arg(_port).arg(QString(METRICS_PATH));
+}
+
+void MetricsExporter::handleNewConnection() {
+    while (_server->hasPendingConnections()) {
+        QTcpSocket* socket = _server->nextPendingConnection();
+        _requestBuffers.insert(socket, QByteArray());
+
+        connect(socket, &QTcpSocket::readyRead, this, &MetricsExporter::handleReadyRead);
+        connect(socket, &QTcpSocket::disconnected, this, &MetricsExporter::handleDisconnected);
+    }
+}
+
+void MetricsExporter::handleDisconnected() {
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    _requestBuffers.remove(socket);
+    socket->deleteLater();
+}
+
+void MetricsExporter::handleReadyRead() {
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    if (!_requestBuffers.contains(socket)) {
+        return;
+    }
+
+    QByteArray& buffer = _requestBuffers[socket];
+    buffer += socket->readAll();
+
+    // a keep-alive client may have sent several requests by now
+    int headerEnd;
+    while ((headerEnd = buffer.indexOf("\r\n\r\n")) >= 0) {
+        QByteArray requestHeader = buffer.left(headerEnd);
+        buffer.remove(0, headerEnd + 4);
+
+        if (!respond(socket, requestHeader)) {
+            _requestBuffers.remove(socket);
+            socket->disconnectFromHost();
+            return;
+        }
+    }
+
+    if (buffer.size() > MAX_REQUEST_HEADER_BYTES) {
+        _requestBuffers.remove(socket);
+        socket->abort();
+    }
+}
+
+bool MetricsExporter::respond(QTcpSocket* socket, const QByteArray& requestHeader) {
+    QList<QByteArray> lines = requestHeader.split('\n');
+    QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    if (requestLine.size() != 3) {
+        socket->write("HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        return false;
+    }
+
+    const QByteArray& method = requestLine[0];
+    int queryStart = requestLine[1].indexOf('?');
+    QByteArray path = queryStart >= 0 ? requestLine[1].left(queryStart) : requestLine[1];
+
+    // HTTP/1.1 keeps the connection unless told otherwise, 1.0 only when asked to
+    bool keepAlive = requestLine[2] == "HTTP/1.1";
+    for (int i = 1; i < lines.size(); ++i) {
+        QByteArray line = lines[i].trimmed().toLower();
+        if (line.startsWith("connection:")) {
+            QByteArray value = line.mid(11).trimmed();
+            keepAlive = value == "keep-alive" || (keepAlive && value != "close");
+        }
+    }
+
+    QByteArray connectionHeader = keepAlive ? "" : "Connection: close\r\n";
+
+    if (method != "GET" && method != "HEAD") {
+        socket->write("HTTP/1.1 405 Method Not Allowed\r\nAllow: GET, HEAD\r\nContent-Length: 0\r\n"
+                      + connectionHeader + "\r\n");
+        return keepAlive;
+    }
+
+    if (path != METRICS_PATH) {
+        socket->write("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n" + connectionHeader + "\r\n");
+        return keepAlive;
+    }
+
+    QElapsedTimer renderTimer;
+    renderTimer.start();
+    _registry.render(_body);
+    _registry.set(_renderSeries, renderTimer.nsecsElapsed() / 1000);
+    _registry.add(_scrapesSeries);
+
+    socket->write("HTTP/1.1 200 OK\r\nContent-Type: " + METRICS_CONTENT_TYPE + "\r\nContent-Length: "
+                  + QByteArray::number(_body.size()) + "\r\n" + connectionHeader + "\r\n");
+    if (method == "GET") {
+        socket->write(_body);
+    }
+
+    return keepAlive;
+}
@@ -0,0 +1,52 @@
+//
+//  MetricsExporter.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_MetricsExporter_h
+#define hifi_MetricsExporter_h
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+
+class MetricsRegistry;
+class QTcpServer;
+class QTcpSocket;
+
+// Serves the registry as OpenMetrics text at /metrics on a localhost port, for Prometheus or
+// anything else that scrapes. Plain HTTP/1.1 with keep-alive and nothing else, so a stand-in or
+// proxy in front of it sees an ordinary server. Lives on its own thread: a scrape renders from
+// the registry's counters into a reused buffer and never involves the GUI thread.
+class MetricsExporter : public QObject
+{
+    Q_OBJECT
+public:
+    MetricsExporter(MetricsRegistry& registry, quint16 port, QObject* parent = 0);
+
+    // the port actually listened on once started, which a port of 0 leaves to the OS
+    quint16 getPort() const { return _port; }
+
+public slots:
+    void start();
+
+private slots:
+    void handleNewConnection();
+    void handleReadyRead();
+    void handleDisconnected();
+
+private:
+    bool respond(QTcpSocket* socket, const QByteArray& requestHeader);
+
+    MetricsRegistry& _registry;
+    quint16 _port;
+    QTcpServer* _server;
+    QHash<QTcpSocket*, QByteArray> _requestBuffers;
+    QByteArray _body;
+    int _scrapesSeries;
+    int _renderSeries;
+};
+
+#endif
@@ -0,0 +1,167 @@
+//
+//  MetricsRegistry.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "MetricsRegistry.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+
+#include <cstdio>
+#include <cstring>
+
+const int VALUE_BUFFER_SIZE = 48;
+
+static QByteArray escapeLabelValue(const QString& value) {
+    QByteArray escaped = value.toUtf8();
+    escaped.replace('\\', "\\\\");
+    escaped.replace('"', "\\\"");
+    escaped.replace('\n', "\\n");
+    return escaped;
+}
+
+static QByteArray escapeHelp(const QString& help) {
+    QByteArray escaped = help.toUtf8();
+    escaped.replace('\\', "\\\\");
+    escaped.replace('\n', "\\n");
+    return escaped;
+}
+
+// scales are powers of ten, formatted without going through floating point
+static int formatValue(char* buffer, qint64 value, int scale) {
+    if (scale <= 1) {
+        return qsnprintf(buffer, VALUE_BUFFER_SIZE, "%lld", (long long)value);
+    }
+
+    int decimals = 0;
+    for (int remaining = scale; remaining > 1; remaining /= 10) {
+        ++decimals;
+    }
+
+    const char* sign = value < 0 ? "-" : "";
+    qint64 magnitude = qAbs(value);
+    return qsnprintf(buffer, VALUE_BUFFER_SIZE, "%s%lld.%0*lld", sign, (long long)(magnitude / scale), decimals,
+                     (long long)(magnitude % scale));
+}
+
+MetricsRegistry& MetricsRegistry::getInstance() {
+    static MetricsRegistry staticInstance;
+    return staticInstance;
+}
+
+MetricsRegistry::MetricsRegistry() {
+    memset(_values, 0, sizeof(_values));
+    _seriesNames.reserve(MAX_SERIES);
+    _seriesScales.reserve(MAX_SERIES);
+}
+
+int MetricsRegistry::registerSeries(Type type, const QString& family, const QString& help, const QStringList& labels,
+                                    int scale, const QString& unit) {
+    Q_ASSERT(labels.size() % 2 == 0);
+
+    QString key = family + QChar(0) + labels.join(QChar(0));
+
+    QMutexLocker locker(&_mutex);
+
+    int series = _seriesIDs.value(key, -1);
+    if (series >= 0) {
+        return series;
+    }
+
+    if (_seriesNames.size() >= MAX_SERIES) {
+        qWarning() << "No room left for metric" << family << labels;
+        return -1;
+    }
+
+    int familyID = _familyIDs.value(family, -1);
+    if (familyID < 0) {
+        QByteArray name = family.toUtf8();
+
+        Family newFamily;
+        newFamily.header = "# TYPE " + name + (type == Counter ? " counter\n" : " gauge\n");
+        if (!unit.isEmpty()) {
+            newFamily.header += "# UNIT " + name + " " + unit.toUtf8() + "\n";
+        }
+        newFamily.header += "# HELP " + name + " " + escapeHelp(help) + "\n";
+
+        familyID = _families.size();
+        _families << newFamily;
+        _familyIDs.insert(family, familyID);
+    }
+
+    // counters are sampled under their family name with _total on the end
+    QByteArray seriesName = family.toUtf8() + (type == Counter ? "_total" : "");
+    if (!labels.isEmpty()) {
+        seriesName += '{';
+        for (int i = 0; i < labels.size(); i += 2) {
+            if (i > 0) {
+                seriesName += ',';
+            }
+            seriesName += labels[i].toUtf8() + "=\"" + escapeLabelValue(labels[i + 1]) + '"';
+        }
+        seriesName += '}';
+    }
+    seriesName += ' ';
+
+    series = _seriesNames.size();
+    _seriesNames << seriesName;
+    _seriesScales << qMax(1, scale);
+    _values[series] = 0;
+
+    _families[familyID].series << series;
+    _seriesIDs.insert(key, series);
+
+    return series;
+}
+
+void MetricsRegistry::set(int series, qint64 value) {
+    if (series < 0) {
+        return;
+    }
+
+    QMutexLocker locker(&_mutex);
+    _values[series] = value;
+}
+
+void MetricsRegistry::add(int series, qint64 delta) {
+    if (series < 0) {
+        return;
+    }
+
+    QMutexLocker locker(&_mutex);
+    _values[series] += delta;
+}
+
+qint64 MetricsRegistry::get(int series) {
+    if (series < 0) {
+        return 0;
+    }
+
+    QMutexLocker locker(&_mutex);
+    return _values[series];
+}
+
+void MetricsRegistry::render(QByteArray& output) {
+    // a reserved array keeps its allocation when emptied
+    output.reserve(output.capacity());
+    output.resize(0);
+
+    char buffer[VALUE_BUFFER_SIZE];
+
+    QMutexLocker locker(&_mutex);
+
+    foreach(const Family& family, _families) {
+        output += family.header;
+
+        foreach(int series, family.series) {
+            output += _seriesNames[series];
+            output.append(buffer, formatValue(buffer, _values[series], _seriesScales[series]));
+            output += '\n';
+        }
+    }
+
+    output += "# EOF\n";
+}
@@ -0,0 +1,69 @@
+//
+//  MetricsRegistry.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_MetricsRegistry_h
+#define hifi_MetricsRegistry_h
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Counters and gauges for the metrics endpoint, rendered as OpenMetrics text.
+//
+// A series is registered once and from then on is a slot in a preallocated array: setting or
+// adding to it is a short locked store from whichever thread owns the value, and rendering walks
+// the slots with the family headers and series names already formatted, so a scrape costs
+// microseconds and never waits on the thread that produces the values. Values are integers,
+// divided by the series scale on the way out, so milliseconds can be reported as seconds.
+class MetricsRegistry
+{
+public:
+    enum Type {
+        Counter = 0,
+        Gauge
+    };
+
+    static const int MAX_SERIES = 4096;
+
+    // the scale for values kept in milliseconds and reported in seconds
+    static const int MSECS_SCALE = 1000;
+
+    static MetricsRegistry& getInstance();
+
+    // the same id for a family and labels already registered, -1 once MAX_SERIES are taken;
+    // labels are name/value pairs, the family's unit if any must end its name
+    int registerSeries(Type type, const QString& family, const QString& help, const QStringList& labels = QStringList(),
+                       int scale = 1, const QString& unit = QString());
+
+    void set(int series, qint64 value);
+    void add(int series, qint64 delta = 1);
+    qint64 get(int series);
+
+    // replaces the contents of output, whose capacity is kept from one call to the next
+    void render(QByteArray& output);
+
+private:
+    MetricsRegistry();
+
+    struct Family {
+        QByteArray header; // TYPE, UNIT and HELP lines
+        QVector<int> series;
+    };
+
+    QMutex _mutex;
+    QVector<Family> _families;
+    QHash<QString, int> _familyIDs;
+    QHash<QString, int> _seriesIDs;
+    QVector<QByteArray> _seriesNames; // name and labels, up to the value
+    QVector<int> _seriesScales;
+    qint64 _values[MAX_SERIES];
+};
+
+#endif
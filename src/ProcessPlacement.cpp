@@ -0,0 +1,269 @@
+//
+//  ProcessPlacement.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "ProcessPlacement.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QList>
+
+#include "StackProfile.h"
+
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+#ifdef Q_OS_LINUX
+Q_STATIC_ASSERT(ProcessPlacement::MAX_CPUS <= CPU_SETSIZE);
+#endif
+
+const int CGROUP_CPU_PERIOD_USECS = 100000;
+
+// from linux/mempolicy.h and linux/ioprio.h, which aren't always installed
+const int MPOL_BIND_MODE = 2;
+const int IOPRIO_WHO_PROCESS_TARGET = 1;
+const int IOPRIO_CLASS_SHIFT_BITS = 13;
+
+static QString cgroupRoot;
+
+static bool writeControlFile(const QString& path, const QByteArray& value) {
+    QFile controlFile(path);
+    if (!controlFile.open(QIODevice::WriteOnly) || controlFile.write(value) != value.size()) {
+        qWarning() << "Could not write" << value << "to" << path << "-" << controlFile.errorString();
+        return false;
+    }
+    return true;
+}
+
+void ProcessPlacement::setCgroupRoot(const QString& root) {
+    if (!QFile::exists(root + "/cgroup.procs")) {
+        qWarning() << root << "is not a cgroup v2 directory, CPU and memory caps are off.";
+        return;
+    }
+
+    cgroupRoot = root;
+
+    // the caps live in per-process groups below the root, which need these controllers handed down
+    writeControlFile(cgroupRoot + "/cgroup.subtree_control", "+cpu +memory");
+}
+
+QVector<int> ProcessPlacement::parseCpuList(const QByteArray& cpuList) {
+    QVector<int> cpus;
+
+    // the kernel's list format, "0-3,8,10-11"
+    foreach(const QByteArray& range, cpuList.trimmed().split(',')) {
+        if (range.isEmpty()) {
+            continue;
+        }
+
+        int dash = range.indexOf('-');
+        int first = range.left(dash < 0 ? range.size() : dash).toInt();
+        int last = dash < 0 ? first : range.mid(dash + 1).toInt();
+
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus << cpu;
+        }
+    }
+
+    return cpus;
+}
+
+QVector<int> ProcessPlacement::cpusForNumaNode(int numaNode) {
+    QFile cpuListFile(QString("/sys/devices/system/node/node%1/cpulist").arg(numaNode));
+    if (!cpuListFile.open(QIODevice::ReadOnly)) {
+        return QVector<int>();
+    }
+    return parseCpuList(cpuListFile.readAll());
+}
+
+PreparedPlacement ProcessPlacement::prepare(const QString& name, const ProcessLimits& limits) {
+    PreparedPlacement placement;
+    placement.cpuSet = limits.cpuSet;
+    placement.niceness = limits.niceness;
+    placement.maxMemoryBytes = limits.maxMemoryBytes;
+
+#ifdef Q_OS_LINUX
+    if (limits.numaNode >= 0) {
+        QVector<int> nodeCpus = cpusForNumaNode(limits.numaNode);
+        if (nodeCpus.isEmpty()) {
+            qWarning() << "There is no NUMA node" << limits.numaNode << "for" << name;
+        } else {
+            placement.numaNode = limits.numaNode;
+
+            // memory on the node is only local to the node's own cores
+            if (placement.cpuSet.isEmpty()) {
+                placement.cpuSet = nodeCpus;
+            }
+        }
+    }
+
+    if (limits.ioPriorityClass != IOPriorityDefault) {
+        int level = limits.ioPriorityClass == IOPriorityIdle ? 0 : qBound(0, limits.ioPriorityLevel, 7);
+        placement.ioPriority = (int(limits.ioPriorityClass) << IOPRIO_CLASS_SHIFT_BITS) | level;
+    }
+
+    if (limits.cpuQuotaPercent > 0 || limits.cgroupMemoryBytes > 0) {
+        if (cgroupRoot.isEmpty()) {
+            qWarning() << name << "asks for cgroup caps but no cgroup was given with --cgroup.";
+        } else {
+            QString group = cgroupRoot + "/" + name;
+            QDir().mkpath(group);
+
+            QByteArray cpuMax = "max";
+            if (limits.cpuQuotaPercent > 0) {
+                cpuMax = QByteArray::number(qint64(CGROUP_CPU_PERIOD_USECS) * limits.cpuQuotaPercent / 100)
+                    + " " + QByteArray::number(CGROUP_CPU_PERIOD_USECS);
+            }
+            QByteArray memoryMax = limits.cgroupMemoryBytes > 0 ? QByteArray::number(limits.cgroupMemoryBytes) : "max";
+
+            if (writeControlFile(group + "/cpu.max", cpuMax) && writeControlFile(group + "/memory.max", memoryMax)) {
+                placement.cgroupProcsPath = QFile::encodeName(group + "/cgroup.procs");
+            }
+        }
+    }
+#else
+    if (limits.numaNode >= 0 || limits.ioPriorityClass != IOPriorityDefault
+        || limits.cpuQuotaPercent > 0 || limits.cgroupMemoryBytes > 0) {
+        qWarning() << "NUMA, IO priority and cgroup limits for" << name << "are only supported on Linux.";
+    }
+#endif
+
+    return placement;
+}
+
+// system calls only, pid 0 being the caller, since the child runs this between fork and exec
+static void applyPlacement(qint64 pid, const char* cgroupProcsEntry, const PreparedPlacement& placement) {
+#ifdef Q_OS_LINUX
+    if (!placement.cgroupProcsPath.isEmpty()) {
+        int procsFile = open(placement.cgroupProcsPath.constData(), O_WRONLY);
+        if (procsFile >= 0) {
+            if (write(procsFile, cgroupProcsEntry, strlen(cgroupProcsEntry)) < 0) {
+                // nothing to report to from the child, it just runs uncapped
+            }
+            close(procsFile);
+        }
+    }
+
+    if (!placement.cpuSet.isEmpty()) {
+        cpu_set_t cpuMask;
+        CPU_ZERO(&cpuMask);
+        for (int i = 0; i < placement.cpuSet.size(); ++i) {
+            // profiles are validated, but a NUMA node's CPU list comes straight from the kernel
+            if (placement.cpuSet[i] >= 0 && placement.cpuSet[i] < MAX_CPUS) {
+                CPU_SET(placement.cpuSet[i], &cpuMask);
+            }
+        }
+        sched_setaffinity(pid_t(pid), sizeof(cpuMask), &cpuMask);
+    }
+
+    if (placement.ioPriority >= 0) {
+        syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS_TARGET, int(pid), placement.ioPriority);
+    }
+#endif
+
+#ifdef Q_OS_UNIX
+    if (placement.niceness != 0) {
+        setpriority(PRIO_PROCESS, id_t(pid), placement.niceness);
+    }
+
+    if (placement.maxMemoryBytes > 0) {
+        struct rlimit memoryLimit;
+        memoryLimit.rlim_cur = placement.maxMemoryBytes;
+        memoryLimit.rlim_max = placement.maxMemoryBytes;
+#ifdef Q_OS_LINUX
+        prlimit(pid_t(pid), RLIMIT_AS, &memoryLimit, NULL);
+#else
+        if (pid == 0) {
+            setrlimit(RLIMIT_AS, &memoryLimit);
+        }
+#endif
+    }
+#endif
+}
+
+void ProcessPlacement::applyInChild(const PreparedPlacement& placement) {
+    // "0" in cgroup.procs moves the writer, so everything the child execs is capped from its first instruction
+    applyPlacement(0, "0", placement);
+
+#ifdef Q_OS_LINUX
+    if (placement.numaNode >= 0 && placement.numaNode < int(sizeof(unsigned long) * 8)) {
+        unsigned long nodeMask = 1UL << placement.numaNode;
+        syscall(SYS_set_mempolicy, MPOL_BIND_MODE, &nodeMask, sizeof(nodeMask) * 8 + 1);
+    }
+#endif
+}
+
+bool ProcessPlacement::canApplyToProcess(const PreparedPlacement& placement) {
+#ifdef Q_OS_LINUX
+    return placement.numaNode < 0;
+#else
+    return placement.maxMemoryBytes == 0;
+#endif
+}
+
+void ProcessPlacement::applyToProcess(qint64 pid, const PreparedPlacement& placement) {
+    // threads the child started before this keep their old CPU mask, in practice it hasn't started any yet
+    QByteArray cgroupProcsEntry = QByteArray::number(pid);
+    applyPlacement(pid, cgroupProcsEntry.constData(), placement);
+}
+
+QVector<int> ProcessPlacement::placeAutomatically(LaunchPlan& plan, const QVector<int>& availableCpus) {
+    QList<LaunchStep*> latencySensitiveSteps;
+    QList<LaunchStep*> sharedSteps;
+
+    for (int stage = 0; stage < plan.stages.size(); ++stage) {
+        for (int i = 0; i < plan.stages[stage].size(); ++i) {
+            LaunchStep& step = plan.stages[stage][i];
+
+            // placement spelled out in the profile always wins
+            if (!step.limits.cpuSet.isEmpty() || step.limits.numaNode >= 0) {
+                continue;
+            }
+
+            if (step.isLatencySensitive) {
+                latencySensitiveSteps << &step;
+            } else {
+                sharedSteps << &step;
+            }
+        }
+    }
+
+    if (latencySensitiveSteps.isEmpty()) {
+        return QVector<int>();
+    }
+
+    int sharedCpuCount = availableCpus.size() - latencySensitiveSteps.size();
+    if (sharedCpuCount < 1) {
+        qWarning() << "Automatic placement needs more than" << latencySensitiveSteps.size()
+            << "CPUs to isolate the mixers, leaving everything unpinned.";
+        return QVector<int>();
+    }
+
+    // mixers take cores from the top, everything else shares the ones below
+    for (int i = 0; i < latencySensitiveSteps.size(); ++i) {
+        int cpu = availableCpus[availableCpus.size() - 1 - i];
+        latencySensitiveSteps[i]->limits.cpuSet = QVector<int>() << cpu;
+        qDebug() << latencySensitiveSteps[i]->name << "gets CPU" << cpu << "to itself.";
+    }
+
+    QVector<int> sharedCpus = availableCpus.mid(0, sharedCpuCount);
+    foreach(LaunchStep* step, sharedSteps) {
+        step->limits.cpuSet = sharedCpus;
+    }
+
+    return sharedCpus;
+}
@@ -0,0 +1,79 @@
+//
+//  ProcessPlacement.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_ProcessPlacement_h
+#define hifi_ProcessPlacement_h
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+struct LaunchPlan;
+
+enum IOPriorityClass {
+    IOPriorityDefault = 0,
+    IOPriorityRealtime,
+    IOPriorityBestEffort,
+    IOPriorityIdle
+};
+
+struct ProcessLimits {
+    ProcessLimits() : niceness(0), maxMemoryBytes(0), numaNode(-1), ioPriorityClass(IOPriorityDefault),
+        ioPriorityLevel(4), cpuQuotaPercent(0), cgroupMemoryBytes(0) {}
+
+    QVector<int> cpuSet; // empty leaves the child on every core
+    int niceness;
+    qint64 maxMemoryBytes; // address space cap, 0 for none
+    int numaNode; // memory bound to this node, and CPUs too unless cpuSet is given
+    IOPriorityClass ioPriorityClass;
+    int ioPriorityLevel; // 0 (highest) to 7 within the class
+    int cpuQuotaPercent; // cgroup v2 cpu.max, 100 is one full core
+    qint64 cgroupMemoryBytes; // cgroup v2 memory.max
+};
+
+// Everything the child applies to itself between fork and exec, worked out in the parent so the
+// child only makes system calls.
+struct PreparedPlacement {
+    PreparedPlacement() : niceness(0), maxMemoryBytes(0), numaNode(-1), ioPriority(-1) {}
+
+    QVector<int> cpuSet;
+    int niceness;
+    qint64 maxMemoryBytes;
+    int numaNode;
+    int ioPriority; // already encoded for ioprio_set, -1 to leave alone
+    QByteArray cgroupProcsPath;
+};
+
+// Where and how children run: CPU affinity, NUMA memory binding, nice and IO priority, and
+// cgroup v2 CPU and memory caps inside a delegated cgroup given with --cgroup. Linux only, the
+// other platforms apply nice and the address space cap and ignore the rest.
+class ProcessPlacement
+{
+public:
+    // CPU_SETSIZE, the most CPUs an affinity mask can name
+    static const int MAX_CPUS = 1024;
+
+    static void setCgroupRoot(const QString& cgroupRoot);
+
+    static PreparedPlacement prepare(const QString& name, const ProcessLimits& limits);
+    static void applyInChild(const PreparedPlacement& placement);
+
+    // for children something else started; NUMA binding, and the memory cap outside Linux,
+    // only work from inside the child
+    static bool canApplyToProcess(const PreparedPlacement& placement);
+    static void applyToProcess(qint64 pid, const PreparedPlacement& placement);
+
+    // gives every latency sensitive step a core of its own out of availableCpus and puts
+    // everything else on the cores that are left; returns those shared cores, for processes
+    // started outside the plan, or nothing when no core was set aside
+    static QVector<int> placeAutomatically(LaunchPlan& plan, const QVector<int>& availableCpus);
+
+    static QVector<int> parseCpuList(const QByteArray& cpuList);
+    static QVector<int> cpusForNumaNode(int numaNode);
+};
+
+#endif
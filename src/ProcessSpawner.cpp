@@ -0,0 +1,225 @@
+//
+//  ProcessSpawner.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "ProcessSpawner.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+
+#include <cstring>
+
+#include "BackgroundProcess.h"
+#include "SpawnerProtocol.h"
+
+const QString SPAWNER_BINARY = "stack-manager-spawner";
+const int HELPER_CONNECT_TIMEOUT_MS = 5000;
+
+ProcessSpawner::ProcessSpawner(QObject* parent) :
+    QObject(parent),
+    _socket(NULL),
+    _nextSpawnID(1)
+{
+    _helper.setProcessChannelMode(QProcess::ForwardedChannels);
+}
+
+ProcessSpawner::~ProcessSpawner() {
+    if (_socket) {
+        // the helper stops whatever is left once we hang up
+        _socket->disconnect(this);
+        _socket->abort();
+        _helper.waitForFinished();
+    }
+
+    foreach(QPointer<BackgroundProcess> process, _processes) {
+        if (process) {
+            process->spawnerFinished(-1, true);
+        }
+    }
+}
+
+QString ProcessSpawner::defaultHelperPath() {
+    return QDir::toNativeSeparators(QCoreApplication::applicationDirPath() + "/" + SPAWNER_BINARY);
+}
+
+bool ProcessSpawner::start(const QString& helperPath) {
+#ifdef Q_OS_UNIX
+    if (!QFile::exists(helperPath)) {
+        qWarning() << "No spawner helper at" << helperPath << "- children will be forked from the Stack Manager.";
+        return false;
+    }
+
+    QString serverName = QString("%1-%2").arg(SPAWNER_BINARY).arg(QCoreApplication::applicationPid());
+    QLocalServer::removeServer(serverName);
+    if (!_server.listen(serverName)) {
+        qWarning() << "Could not listen for the spawner helper:" << _server.errorString();
+        return false;
+    }
+
+    // the one fork we can't avoid, done before the GUI has grown
+    _helper.start(helperPath, QStringList() << _server.fullServerName());
+
+    if (!_server.waitForNewConnection(HELPER_CONNECT_TIMEOUT_MS)) {
+        qWarning() << "The spawner helper did not connect - children will be forked from the Stack Manager.";
+        _helper.kill();
+        _server.close();
+        return false;
+    }
+
+    _socket = _server.nextPendingConnection();
+    _server.close();
+
+    connect(_socket, &QLocalSocket::readyRead, this, &ProcessSpawner::readMessages);
+    connect(_socket, &QLocalSocket::disconnected, this, &ProcessSpawner::helperDisconnected);
+
+    qDebug() << "Children are spawned by" << helperPath << "process" << _helper.processId();
+    return true;
+#else
+    Q_UNUSED(helperPath);
+    return false;
+#endif
+}
+
+bool ProcessSpawner::isAvailable() const {
+    return _socket && _socket->state() == QLocalSocket::ConnectedState;
+}
+
+quint32 ProcessSpawner::spawn(BackgroundProcess* process, const QString& program, const QStringList& arguments,
+                              const QString& workingDirectory, const QStringList& environment,
+                              const QString& stdoutPath, const QString& stderrPath) {
+    quint32 spawnID = _nextSpawnID++;
+    _processes.insert(spawnID, process);
+
+    QList<QByteArray> fields;
+    fields << SPAWN_MESSAGE << QByteArray::number(spawnID) << QFile::encodeName(program)
+        << QFile::encodeName(workingDirectory) << QFile::encodeName(stdoutPath) << QFile::encodeName(stderrPath)
+        << QByteArray::number(arguments.size());
+
+    foreach(const QString& argument, arguments) {
+        fields << argument.toLocal8Bit();
+    }
+    foreach(const QString& variable, environment) {
+        fields << variable.toLocal8Bit();
+    }
+
+    sendMessage(fields);
+    return spawnID;
+}
+
+void ProcessSpawner::terminate(quint32 spawnID) {
+    sendMessage(QList<QByteArray>() << SIGNAL_MESSAGE << QByteArray::number(spawnID) << TERMINATE_SIGNAL_NAME);
+}
+
+void ProcessSpawner::kill(quint32 spawnID) {
+    sendMessage(QList<QByteArray>() << SIGNAL_MESSAGE << QByteArray::number(spawnID) << KILL_SIGNAL_NAME);
+}
+
+bool ProcessSpawner::waitForExit(quint32 spawnID, int msecs) {
+    QElapsedTimer timer;
+    timer.start();
+
+    // readyRead fires from inside waitForReadyRead, so the exit is handled as it comes in
+    while (_processes.contains(spawnID) && isAvailable()) {
+        int remaining = msecs - int(timer.elapsed());
+        if (remaining <= 0 || !_socket->waitForReadyRead(remaining)) {
+            break;
+        }
+    }
+
+    return !_processes.contains(spawnID);
+}
+
+void ProcessSpawner::sendMessage(const QList<QByteArray>& fields) {
+    if (!isAvailable()) {
+        return;
+    }
+
+    QByteArray payload;
+    foreach(const QByteArray& field, fields) {
+        payload += field;
+        payload += '\0';
+    }
+
+    quint32 length = payload.size();
+    _socket->write(reinterpret_cast<const char*>(&length), sizeof(length));
+    _socket->write(payload);
+    _socket->flush();
+}
+
+void ProcessSpawner::readMessages() {
+    _buffer += _socket->readAll();
+
+    int consumed = 0;
+    while (_buffer.size() - consumed >= int(sizeof(quint32))) {
+        quint32 length = 0;
+        memcpy(&length, _buffer.constData() + consumed, sizeof(length));
+
+        if (length > MAX_SPAWNER_MESSAGE_BYTES) {
+            qWarning() << "The spawner helper sent a" << length << "byte message, hanging up on it.";
+            _socket->abort();
+            return;
+        }
+
+        if (quint32(_buffer.size() - consumed) - sizeof(length) < length) {
+            break;
+        }
+
+        QByteArray payload = _buffer.mid(consumed + sizeof(length), length);
+        consumed += sizeof(length) + length;
+
+        // every field is terminated, so the split leaves an empty one at the end
+        QList<QByteArray> fields = payload.split('\0');
+        fields.removeLast();
+        handleMessage(fields);
+    }
+
+    _buffer.remove(0, consumed);
+}
+
+void ProcessSpawner::handleMessage(const QList<QByteArray>& fields) {
+    if (fields.size() < 3) {
+        return;
+    }
+
+    quint32 spawnID = fields[1].toUInt();
+    QPointer<BackgroundProcess> process = _processes.value(spawnID);
+
+    if (fields[0] == SPAWNED_MESSAGE) {
+        if (process) {
+            process->spawnerStarted(fields[2].toLongLong());
+        }
+    } else if (fields[0] == FAILED_MESSAGE) {
+        _processes.remove(spawnID);
+        if (process) {
+            process->spawnerFailed(QString::fromLocal8Bit(fields[2]));
+        }
+    } else if (fields[0] == EXITED_MESSAGE && fields.size() >= 4) {
+        _processes.remove(spawnID);
+        if (process) {
+            process->spawnerFinished(fields[2].toInt(), fields[3] == "1");
+        }
+    }
+}
+
+void ProcessSpawner::helperDisconnected() {
+    qWarning() << "The spawner helper went away - children will be forked from the Stack Manager.";
+
+    _socket->deleteLater();
+    _socket = NULL;
+
+    // whatever it started is out of our reach now
+    QHash<quint32, QPointer<BackgroundProcess> > processes = _processes;
+    _processes.clear();
+
+    foreach(QPointer<BackgroundProcess> process, processes) {
+        if (process) {
+            process->spawnerFinished(-1, true);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+//
+//  ProcessSpawner.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_ProcessSpawner_h
+#define hifi_ProcessSpawner_h
+
+#include <QHash>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QObject>
+#include <QPointer>
+#include <QProcess>
+#include <QStringList>
+
+class BackgroundProcess;
+
+// Talks to stack-manager-spawner, a small helper started once at launch that posix_spawns and
+// reaps our children, so starting one doesn't fork the whole GUI process. Unix only; when the
+// helper is missing or goes away BackgroundProcess falls back to QProcess.
+class ProcessSpawner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ProcessSpawner(QObject* parent = 0);
+    ~ProcessSpawner();
+
+    static QString defaultHelperPath();
+
+    bool start(const QString& helperPath);
+    bool isAvailable() const;
+
+    // returns the id the child is known by, its progress is reported back to the process
+    quint32 spawn(BackgroundProcess* process, const QString& program, const QStringList& arguments,
+                  const QString& workingDirectory, const QStringList& environment,
+                  const QString& stdoutPath, const QString& stderrPath);
+    void terminate(quint32 spawnID);
+    void kill(quint32 spawnID);
+    bool waitForExit(quint32 spawnID, int msecs);
+
+private slots:
+    void readMessages();
+    void helperDisconnected();
+
+private:
+    void sendMessage(const QList<QByteArray>& fields);
+    void handleMessage(const QList<QByteArray>& fields);
+
+    QLocalServer _server;
+    QLocalSocket* _socket;
+    QProcess _helper;
+    QByteArray _buffer;
+    quint32 _nextSpawnID;
+    QHash<quint32, QPointer<BackgroundProcess> > _processes;
+};
+
+#endif
@@ -0,0 +1,103 @@
+//
+//  ProcessStats.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "ProcessStats.h"
+
+#if defined(Q_OS_LINUX)
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+
+#include <unistd.h>
+#elif defined(Q_OS_MAC)
+#include <libproc.h>
+#endif
+
+#if defined(Q_OS_LINUX)
+static bool readProcFile(const QString& path, QByteArray& contents) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    // proc files report a size of zero, so read until the end instead of by size
+    contents = file.readAll();
+    return !contents.isEmpty();
+}
+#endif
+
+bool ProcessStats::sample(qint64 processID, ProcessSample& sample) {
+    if (processID <= 0) {
+        return false;
+    }
+
+#if defined(Q_OS_LINUX)
+    QString procPath = "/proc/" + QString::number(processID);
+
+    QByteArray stat;
+    if (!readProcFile(procPath + "/stat", stat)) {
+        return false;
+    }
+
+    // the command name can hold spaces and parens, the fields we want come after its last ')'
+    int commandEnd = stat.lastIndexOf(')');
+    if (commandEnd < 0) {
+        return false;
+    }
+
+    // counted from the state field, utime and stime are the 12th and 13th
+    const int UTIME_FIELD = 11;
+    const int STIME_FIELD = 12;
+
+    QList<QByteArray> fields = stat.mid(commandEnd + 2).split(' ');
+    if (fields.size() <= STIME_FIELD) {
+        return false;
+    }
+
+    static const qint64 ticksPerSecond = sysconf(_SC_CLK_TCK);
+    static const qint64 pageSize = sysconf(_SC_PAGESIZE);
+
+    qint64 cpuTicks = fields[UTIME_FIELD].toLongLong() + fields[STIME_FIELD].toLongLong();
+    sample.cpuMSecs = cpuTicks * 1000 / ticksPerSecond;
+
+    QByteArray statm;
+    if (readProcFile(procPath + "/statm", statm)) {
+        QList<QByteArray> pages = statm.split(' ');
+        if (pages.size() > 1) {
+            sample.residentBytes = pages[1].toLongLong() * pageSize;
+        }
+    }
+
+    // only readable for our own children, the rest of the sample is still good without it
+    QByteArray io;
+    if (readProcFile(procPath + "/io", io)) {
+        foreach(const QByteArray& line, io.split('\n')) {
+            if (line.startsWith("read_bytes: ")) {
+                sample.readBytes = line.mid(12).toLongLong();
+            } else if (line.startsWith("write_bytes: ")) {
+                sample.writtenBytes = line.mid(13).toLongLong();
+            }
+        }
+    }
+
+    return true;
+#elif defined(Q_OS_MAC)
+    struct proc_taskinfo taskInfo;
+    if (proc_pidinfo(processID, PROC_PIDTASKINFO, 0, &taskInfo, sizeof(taskInfo)) != sizeof(taskInfo)) {
+        return false;
+    }
+
+    const qint64 NSECS_PER_MSEC = 1000 * 1000;
+    sample.cpuMSecs = (taskInfo.pti_total_user + taskInfo.pti_total_system) / NSECS_PER_MSEC;
+    sample.residentBytes = taskInfo.pti_resident_size;
+
+    return true;
+#else
+    Q_UNUSED(sample);
+    return false;
+#endif
+}
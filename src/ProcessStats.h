@@ -0,0 +1,31 @@
+//
+//  ProcessStats.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_ProcessStats_h
+#define hifi_ProcessStats_h
+
+#include <QtGlobal>
+
+struct ProcessSample {
+    ProcessSample() : cpuMSecs(-1), residentBytes(-1), readBytes(-1), writtenBytes(-1) {}
+
+    qint64 cpuMSecs; // user plus system time since the process started
+    qint64 residentBytes;
+    qint64 readBytes; // storage I/O since the process started, -1 where the OS won't say
+    qint64 writtenBytes;
+};
+
+// Reads CPU time, resident memory and storage I/O of a child from the OS, without spawning
+// anything. Linux reads /proc and OS X asks libproc, which leaves out I/O; elsewhere sampling
+// fails and callers show no stats.
+class ProcessStats
+{
+public:
+    static bool sample(qint64 processID, ProcessSample& sample);
+};
+
+#endif
@@ -0,0 +1,221 @@
+//
+//  StackInstance.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "StackInstance.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcessEnvironment>
+#include <QStringList>
+#include <QThread>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "BackgroundProcess.h"
+#include "GlobalData.h"
+
+const quint16 BASE_HTTP_PORT = 40100;
+const int STACK_PORT_STRIDE = 10;
+
+// never mirrored into a stack's launch directory
+const QStringList UNMIRRORED_DIRECTORIES = QStringList() << "stacks" << "logs" << "Logs" << "staged" << "pr-binaries";
+
+static bool linkOrCopy(const QString& source, const QString& target) {
+#ifdef Q_OS_WIN
+    if (CreateHardLinkW((LPCWSTR) QDir::toNativeSeparators(target).utf16(),
+                        (LPCWSTR) QDir::toNativeSeparators(source).utf16(), NULL)) {
+        return true;
+    }
+#else
+    if (link(QFile::encodeName(source).constData(), QFile::encodeName(target).constData()) == 0) {
+        return true;
+    }
+#endif
+
+    // another volume or no hard link support, fall back to a real copy
+    return QFile::copy(source, target);
+}
+
+static int mirrorDirectory(const QDir& source, const QString& targetPath, const QStringList& skippedNames) {
+    QDir().mkpath(targetPath);
+    int failures = 0;
+
+    QFileInfoList entries = source.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System);
+    foreach(const QFileInfo& entry, entries) {
+        if (skippedNames.contains(entry.fileName())) {
+            continue;
+        }
+
+        QString target = targetPath + "/" + entry.fileName();
+        QFileInfo existing(target);
+
+        if (entry.isSymLink()) {
+            // framework bundles are full of these, point them at the shared target
+            if (!existing.isSymLink() && !QFile::link(entry.symLinkTarget(), target)) {
+                ++failures;
+            }
+        } else if (entry.isDir()) {
+            failures += mirrorDirectory(QDir(entry.absoluteFilePath()), target, QStringList());
+        } else if (!existing.exists() || existing.size() != entry.size()
+                   || existing.lastModified() < entry.lastModified()) {
+            // a hard link shares the shared file's timestamp and a copy is newer, so only updates land here
+            QFile::remove(target);
+            if (!linkOrCopy(entry.absoluteFilePath(), target)) {
+                ++failures;
+            }
+        }
+    }
+
+    return failures;
+}
+
+StackInstance::StackInstance(int index, int stackCount, QObject* parent) :
+    QObject(parent),
+    _index(index),
+    _name(QString("Stack %1").arg(index + 1)),
+    _httpPort(httpPortForStack(index)),
+    _httpsPort(_httpPort + 1),
+    _domainPort(_httpPort + 2),
+    _cpuSet(cpuSetForStack(index, stackCount)),
+    _domainServerProcess(NULL),
+    _acMonitorProcess(NULL)
+{
+    GlobalData& globalData = GlobalData::getInstance();
+
+    _rootPath = QDir::toNativeSeparators(globalData.getStacksPath() + QString::number(index + 1) + "/");
+    _tempPath = QDir::toNativeSeparators(_rootPath + "tmp/");
+    QDir().mkpath(_tempPath);
+
+    QString domainServerPath;
+    QString assignmentClientPath;
+
+    if (globalData.isGetHifiBuildDirectorySet()) {
+        // a developer build is run in place, only the working state is kept apart
+        _launchPath = globalData.getClientsLaunchPath();
+        domainServerPath = globalData.getDomainServerExecutablePath();
+        assignmentClientPath = globalData.getAssignmentClientExecutablePath();
+    } else {
+        _launchPath = QDir::toNativeSeparators(_rootPath + "launch/");
+        domainServerPath = _launchPath + QFileInfo(globalData.getDomainServerExecutablePath()).fileName();
+        assignmentClientPath = _launchPath + QFileInfo(globalData.getAssignmentClientExecutablePath()).fileName();
+    }
+
+    // Qt keeps the files behind its shared memory keys in the temp dir, so a private TMPDIR
+    // gives this stack's children their own key namespace
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert("TMPDIR", _tempPath);
+    environment.insert("TMP", _tempPath);
+    environment.insert("TEMP", _tempPath);
+    environment.insert("XDG_CONFIG_HOME", _rootPath + "config");
+    environment.insert("XDG_DATA_HOME", _rootPath + "data");
+    environment.insert("HIFI_DOMAIN_SERVER_HTTP_PORT", QString::number(_httpPort));
+    environment.insert("HIFI_DOMAIN_SERVER_HTTPS_PORT", QString::number(_httpsPort));
+    environment.insert("HIFI_DOMAIN_SERVER_PORT", QString::number(_domainPort));
+
+    QString logsPath = QDir::toNativeSeparators(globalData.getProcessLogsPath() + QString("stack-%1/").arg(index + 1));
+
+    _domainServerProcess = new BackgroundProcess(domainServerPath, this);
+    _acMonitorProcess = new BackgroundProcess(assignmentClientPath, this);
+
+    QList<BackgroundProcess*> processes;
+    processes << _domainServerProcess << _acMonitorProcess;
+
+    foreach(BackgroundProcess* process, processes) {
+        process->setLogDirectory(logsPath);
+        process->setWorkingDirectory(_launchPath);
+        process->setProcessEnvironment(environment);
+        process->setCpuSet(_cpuSet);
+        connect(process, SIGNAL(stateChanged(QProcess::ProcessState)), this, SIGNAL(stateChanged()));
+    }
+}
+
+bool StackInstance::canIsolateStacks() {
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    // OS X and Windows keep settings and data where QStandardPaths says, whatever XDG_* hold
+    return false;
+#endif
+}
+
+QVector<int> StackInstance::cpuSetForStack(int index, int stackCount) {
+    QVector<int> cpuSet;
+
+    // contiguous equal shares, a host with fewer cores than stacks doesn't pin anything
+    int cpuCount = QThread::idealThreadCount();
+    if (stackCount <= 1 || cpuCount < stackCount) {
+        return cpuSet;
+    }
+
+    int cpusPerStack = cpuCount / stackCount;
+    for (int cpu = index * cpusPerStack; cpu < (index + 1) * cpusPerStack; ++cpu) {
+        cpuSet << cpu;
+    }
+
+    return cpuSet;
+}
+
+quint16 StackInstance::httpPortForStack(int index) {
+    return BASE_HTTP_PORT + index * STACK_PORT_STRIDE;
+}
+
+QString StackInstance::getBaseUrl() const {
+    return QString("http://localhost:%1").arg(_httpPort);
+}
+
+bool StackInstance::prepareLaunchDirectory() {
+    if (GlobalData::getInstance().isGetHifiBuildDirectorySet()) {
+        return true;
+    }
+
+    int failures = mirrorDirectory(QDir(GlobalData::getInstance().getClientsLaunchPath()), _launchPath,
+                                   UNMIRRORED_DIRECTORIES);
+    if (failures > 0) {
+        qWarning() << "Could not mirror" << failures << "files into the launch directory of" << _name;
+    }
+
+    return failures == 0;
+}
+
+void StackInstance::start() {
+    // pick up binaries replaced by an update since the last start
+    prepareLaunchDirectory();
+
+    _domainServerProcess->start(QStringList());
+    _acMonitorProcess->start(QStringList() << "-n" << "4" << "-a" << "localhost"
+                             << "-p" << QString::number(_domainPort));
+}
+
+void StackInstance::stop() {
+    _domainServerProcess->stop();
+    _acMonitorProcess->stop();
+}
+
+bool StackInstance::isRunning() const {
+    return _domainServerProcess->state() != QProcess::NotRunning
+        || _acMonitorProcess->state() != QProcess::NotRunning;
+}
+
+QString StackInstance::describeCpuSet(const QVector<int>& cpuSet) {
+    if (cpuSet.isEmpty()) {
+        return "all CPUs";
+    }
+
+    // stack CPU sets are always one contiguous range
+    return QString("CPUs %1-%2").arg(cpuSet.first()).arg(cpuSet.last());
+}
+
+QString StackInstance::describe() const {
+    return QString("%1: %2, %3, %4").arg(_name, getBaseUrl(), describeCpuSet(_cpuSet),
+                                         isRunning() ? "running" : "stopped");
+}
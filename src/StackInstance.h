@@ -0,0 +1,72 @@
+//
+//  StackInstance.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_StackInstance_h
+#define hifi_StackInstance_h
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+class BackgroundProcess;
+
+// One extra domain, with its own domain-server and assignment-client monitor, next to the
+// primary stack that AppDelegate runs.
+//
+// Each stack gets a block of ports, a copy of the launch directory built from hard links to the
+// shared binaries and resources, its own logs subdirectory, and its own TMPDIR and XDG dirs
+// so the Qt shared memory keys and settings of its children don't collide with other stacks.
+// QStandardPaths only follows the XDG dirs on Linux, so that is the only place extra stacks run.
+class StackInstance : public QObject
+{
+    Q_OBJECT
+public:
+    StackInstance(int index, int stackCount, QObject* parent = 0);
+
+    // whether the children's settings and data can be kept apart here
+    static bool canIsolateStacks();
+
+    static QVector<int> cpuSetForStack(int index, int stackCount);
+    static quint16 httpPortForStack(int index);
+    static QString describeCpuSet(const QVector<int>& cpuSet);
+
+    int getIndex() const { return _index; }
+    const QString& getName() const { return _name; }
+    quint16 getHttpPort() const { return _httpPort; }
+    quint16 getDomainPort() const { return _domainPort; }
+    QString getBaseUrl() const;
+    const QVector<int>& getCpuSet() const { return _cpuSet; }
+
+    BackgroundProcess* getDomainServerProcess() { return _domainServerProcess; }
+    BackgroundProcess* getAssignmentClientMonitorProcess() { return _acMonitorProcess; }
+
+    void start();
+    void stop();
+    bool isRunning() const;
+    QString describe() const;
+
+signals:
+    void stateChanged();
+
+private:
+    bool prepareLaunchDirectory();
+
+    int _index;
+    QString _name;
+    QString _rootPath;
+    QString _launchPath;
+    QString _tempPath;
+    quint16 _httpPort;
+    quint16 _httpsPort;
+    quint16 _domainPort;
+    QVector<int> _cpuSet;
+
+    BackgroundProcess* _domainServerProcess;
+    BackgroundProcess* _acMonitorProcess;
+};
+
+#endif
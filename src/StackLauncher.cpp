@@ -0,0 +1,170 @@
+//
+//  StackLauncher.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "StackLauncher.h"
+
+#include <QDebug>
+
+#include "BackgroundProcess.h"
+
+const int RESTART_DELAY_MS = 2000;
+
+StackLauncher::StackLauncher(const LaunchPlan& plan, QObject* parent) :
+    QObject(parent),
+    _plan(plan),
+    _isUp(false),
+    _launchingStage(-1)
+{
+    foreach(const QList<LaunchStep>& stage, _plan.stages) {
+        QList<BackgroundProcess*> stageProcesses;
+
+        foreach(const LaunchStep& step, stage) {
+            BackgroundProcess* process = new BackgroundProcess(step.program, this);
+            process->setLimits(step.limits);
+
+            connect(process, SIGNAL(started()), this, SLOT(advanceLaunch()));
+            connect(process, SIGNAL(error(QProcess::ProcessError)), this, SLOT(advanceLaunch()));
+            connect(process, SIGNAL(finished(int, QProcess::ExitStatus)),
+                    this, SLOT(handleProcessFinished(int, QProcess::ExitStatus)));
+
+            _steps.insert(process, step);
+            _processes << process;
+            stageProcesses << process;
+        }
+
+        _stageProcesses << stageProcesses;
+    }
+
+    _restartTimer.setSingleShot(true);
+    _restartTimer.setInterval(RESTART_DELAY_MS);
+    connect(&_restartTimer, &QTimer::timeout, this, &StackLauncher::restartPending);
+}
+
+BackgroundProcess* StackLauncher::getFirstProcess(const QString& binary) const {
+    foreach(BackgroundProcess* process, _processes) {
+        if (_steps[process].binary == binary) {
+            return process;
+        }
+    }
+    return NULL;
+}
+
+bool StackLauncher::isRunning() const {
+    foreach(BackgroundProcess* process, _processes) {
+        if (process->state() != QProcess::NotRunning) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void StackLauncher::start() {
+    _isUp = true;
+    _stoppedProcesses.clear();
+    _pendingRestarts.clear();
+
+    if (!_stageProcesses.isEmpty()) {
+        startStage(0);
+    }
+}
+
+void StackLauncher::startStage(int stage) {
+    _launchingStage = stage;
+    emit stageStarted(stage);
+
+    // the children fork and exec in parallel, the event loop hears back from each
+    foreach(BackgroundProcess* process, _stageProcesses[stage]) {
+        if (process->state() == QProcess::NotRunning && !_stoppedProcesses.contains(process)) {
+            process->start(_steps[process].arguments);
+        }
+    }
+
+    advanceLaunch();
+}
+
+void StackLauncher::advanceLaunch() {
+    if (!_isUp || _launchingStage < 0) {
+        return;
+    }
+
+    foreach(BackgroundProcess* process, _stageProcesses[_launchingStage]) {
+        if (process->state() == QProcess::Starting) {
+            return;
+        }
+    }
+
+    if (_launchingStage + 1 < _stageProcesses.size()) {
+        startStage(_launchingStage + 1);
+    } else {
+        _launchingStage = -1;
+    }
+}
+
+void StackLauncher::stop() {
+    _isUp = false;
+    _launchingStage = -1;
+    _pendingRestarts.clear();
+    _restartTimer.stop();
+
+    // dependents go down before what they depend on
+    for (int stage = _stageProcesses.size() - 1; stage >= 0; --stage) {
+        foreach(BackgroundProcess* process, _stageProcesses[stage]) {
+            if (process->state() != QProcess::NotRunning) {
+                process->stop();
+            }
+        }
+    }
+}
+
+void StackLauncher::toggleBinary(const QString& binary, bool start) {
+    foreach(BackgroundProcess* process, _processes) {
+        if (_steps[process].binary != binary) {
+            continue;
+        }
+
+        if (start) {
+            _stoppedProcesses.remove(process);
+            if (process->state() == QProcess::NotRunning) {
+                process->start(_steps[process].arguments);
+            }
+        } else {
+            // held down until it is toggled back on, not restarted by its policy
+            _stoppedProcesses.insert(process);
+            _pendingRestarts.remove(process);
+            process->stop();
+        }
+    }
+}
+
+void StackLauncher::handleProcessFinished(int exitCode, QProcess::ExitStatus exitStatus) {
+    BackgroundProcess* process = static_cast<BackgroundProcess*>(sender());
+    const LaunchStep& step = _steps[process];
+
+    if (!_isUp || _stoppedProcesses.contains(process)) {
+        return;
+    }
+
+    bool hasFailed = exitStatus == QProcess::CrashExit || exitCode != 0;
+    if (step.restartPolicy == RestartAlways || (step.restartPolicy == RestartOnFailure && hasFailed)) {
+        qDebug() << step.name << "exited with code" << exitCode << "- restarting it in" << RESTART_DELAY_MS << "ms.";
+        _pendingRestarts.insert(process);
+        if (!_restartTimer.isActive()) {
+            _restartTimer.start();
+        }
+    }
+}
+
+void StackLauncher::restartPending() {
+    foreach(BackgroundProcess* process, _pendingRestarts) {
+        // a rolling restart may have brought it back already
+        if (process->state() == QProcess::NotRunning) {
+            process->start(_steps[process].arguments);
+            ++_restartCounts[process];
+        }
+    }
+    _pendingRestarts.clear();
+}
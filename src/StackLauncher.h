@@ -0,0 +1,68 @@
+//
+//  StackLauncher.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_StackLauncher_h
+#define hifi_StackLauncher_h
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+
+#include "StackProfile.h"
+
+class BackgroundProcess;
+
+// Runs a LaunchPlan. Every step of a stage is started at once and the next stage follows as
+// soon as all of them have started or failed to, stopping goes through the stages in reverse.
+// Processes that exit while the stack is up are brought back according to their restart policy.
+class StackLauncher : public QObject
+{
+    Q_OBJECT
+public:
+    StackLauncher(const LaunchPlan& plan, QObject* parent = 0);
+
+    const QList<BackgroundProcess*>& getProcesses() const { return _processes; }
+    const QString& getName(BackgroundProcess* process) const { return _steps[process].name; }
+    const QString& getBinary(BackgroundProcess* process) const { return _steps[process].binary; }
+    BackgroundProcess* getFirstProcess(const QString& binary) const;
+
+    // times the restart policy has brought this process back
+    int getRestartCount(BackgroundProcess* process) const { return _restartCounts.value(process); }
+
+    bool isRunning() const;
+
+    void start();
+    void stop();
+    void toggleBinary(const QString& binary, bool start);
+
+signals:
+    void stageStarted(int stage);
+
+private slots:
+    void advanceLaunch();
+    void handleProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void restartPending();
+
+private:
+    void startStage(int stage);
+
+    LaunchPlan _plan;
+    QList<BackgroundProcess*> _processes; // in plan order
+    QList<QList<BackgroundProcess*> > _stageProcesses;
+    QHash<BackgroundProcess*, LaunchStep> _steps;
+
+    bool _isUp;
+    int _launchingStage;
+    QSet<BackgroundProcess*> _stoppedProcesses;
+    QSet<BackgroundProcess*> _pendingRestarts;
+    QHash<BackgroundProcess*, int> _restartCounts;
+    QTimer _restartTimer;
+};
+
+#endif
@@ -0,0 +1,294 @@
+//
+//  StackProfile.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "StackProfile.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+
+#include "GlobalData.h"
+
+const QString StackProfile::DOMAIN_SERVER_BINARY = "domain-server";
+const QString StackProfile::ASSIGNMENT_CLIENT_BINARY = "assignment-client";
+const QString StackProfile::DEFAULT_PROFILE_PATH = ":/default-profile.json";
+
+const QString PROFILE_NAME_KEY = "name";
+const QString PROFILE_PROCESSES_KEY = "processes";
+const QString PROFILE_PLACEMENT_KEY = "placement";
+const QString PROCESS_NAME_KEY = "name";
+const QString PROCESS_BINARY_KEY = "binary";
+const QString PROCESS_ARGUMENTS_KEY = "arguments";
+const QString PROCESS_ASSIGNMENT_TYPE_KEY = "assignmentType";
+const QString PROCESS_POOL_KEY = "pool";
+const QString PROCESS_REPLICAS_KEY = "replicas";
+const QString PROCESS_DEPENDS_ON_KEY = "dependsOn";
+const QString PROCESS_RESTART_KEY = "restart";
+const QString PROCESS_LATENCY_SENSITIVE_KEY = "latencySensitive";
+const QString PROCESS_LIMITS_KEY = "limits";
+const QString LIMITS_CPUS_KEY = "cpus";
+const QString LIMITS_NICE_KEY = "nice";
+const QString LIMITS_MEMORY_KEY = "memoryMB";
+const QString LIMITS_NUMA_NODE_KEY = "numaNode";
+const QString LIMITS_IO_CLASS_KEY = "ioClass";
+const QString LIMITS_IO_LEVEL_KEY = "ioLevel";
+const QString LIMITS_CPU_PERCENT_KEY = "cpuPercent";
+const QString LIMITS_CGROUP_MEMORY_KEY = "cgroupMemoryMB";
+
+const int MAX_REPLICAS = 64;
+
+static QStringList toStringList(const QJsonValue& value) {
+    QStringList strings;
+    foreach(const QJsonValue& element, value.toArray()) {
+        strings << element.toString();
+    }
+    return strings;
+}
+
+bool StackProfile::load(const QString& path, QStringList& errors) {
+    QFile profileFile(path);
+    if (!profileFile.open(QIODevice::ReadOnly)) {
+        errors << "Could not open " + path;
+        return false;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(profileFile.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !document.isObject()) {
+        errors << QString("%1 is not a JSON object: %2").arg(path, parseError.errorString());
+        return false;
+    }
+
+    QJsonObject profile = document.object();
+    _name = profile[PROFILE_NAME_KEY].toString(QFileInfo(path).completeBaseName());
+    _processes.clear();
+
+    QString placement = profile[PROFILE_PLACEMENT_KEY].toString("manual");
+    if (placement != "manual" && placement != "auto") {
+        errors << QString("unknown placement \"%1\"").arg(placement);
+    }
+    _automaticPlacement = placement == "auto";
+
+    QHash<QString, RestartPolicy> restartPolicies;
+    restartPolicies.insert("never", RestartNever);
+    restartPolicies.insert("on-failure", RestartOnFailure);
+    restartPolicies.insert("always", RestartAlways);
+
+    QHash<QString, IOPriorityClass> ioClasses;
+    ioClasses.insert("default", IOPriorityDefault);
+    ioClasses.insert("realtime", IOPriorityRealtime);
+    ioClasses.insert("best-effort", IOPriorityBestEffort);
+    ioClasses.insert("idle", IOPriorityIdle);
+
+    foreach(const QJsonValue& value, profile[PROFILE_PROCESSES_KEY].toArray()) {
+        QJsonObject processObject = value.toObject();
+
+        ProcessSpec spec;
+        spec.name = processObject[PROCESS_NAME_KEY].toString();
+        spec.binary = processObject[PROCESS_BINARY_KEY].toString();
+        spec.arguments = toStringList(processObject[PROCESS_ARGUMENTS_KEY]);
+        spec.assignmentType = processObject[PROCESS_ASSIGNMENT_TYPE_KEY].toString();
+        spec.pool = processObject[PROCESS_POOL_KEY].toString();
+        spec.replicas = processObject[PROCESS_REPLICAS_KEY].toInt(1);
+        spec.dependsOn = toStringList(processObject[PROCESS_DEPENDS_ON_KEY]);
+
+        QString restart = processObject[PROCESS_RESTART_KEY].toString("never");
+        if (!restartPolicies.contains(restart)) {
+            errors << QString("%1: unknown restart policy \"%2\"").arg(spec.name, restart);
+        }
+        spec.restartPolicy = restartPolicies.value(restart, RestartNever);
+
+        bool isMixer = spec.assignmentType == "audio-mixer" || spec.assignmentType == "avatar-mixer";
+        spec.latencySensitive = processObject[PROCESS_LATENCY_SENSITIVE_KEY].toBool(isMixer);
+
+        QJsonObject limits = processObject[PROCESS_LIMITS_KEY].toObject();
+        foreach(const QJsonValue& cpu, limits[LIMITS_CPUS_KEY].toArray()) {
+            spec.limits.cpuSet << cpu.toInt();
+        }
+        spec.limits.niceness = limits[LIMITS_NICE_KEY].toInt(0);
+        spec.limits.maxMemoryBytes = qint64(limits[LIMITS_MEMORY_KEY].toDouble(0)) * 1024 * 1024;
+        spec.limits.numaNode = limits[LIMITS_NUMA_NODE_KEY].toInt(-1);
+        spec.limits.ioPriorityLevel = limits[LIMITS_IO_LEVEL_KEY].toInt(4);
+        spec.limits.cpuQuotaPercent = limits[LIMITS_CPU_PERCENT_KEY].toInt(0);
+        spec.limits.cgroupMemoryBytes = qint64(limits[LIMITS_CGROUP_MEMORY_KEY].toDouble(0)) * 1024 * 1024;
+
+        QString ioClass = limits[LIMITS_IO_CLASS_KEY].toString("default");
+        if (!ioClasses.contains(ioClass)) {
+            errors << QString("%1: unknown IO class \"%2\"").arg(spec.name, ioClass);
+        }
+        spec.limits.ioPriorityClass = ioClasses.value(ioClass, IOPriorityDefault);
+
+        _processes << spec;
+    }
+
+    return errors.isEmpty() && validate(errors);
+}
+
+bool StackProfile::validate(QStringList& errors) const {
+    QHash<QString, int> assignmentTypes = GlobalData::getInstance().getAvailableAssignmentTypes();
+    QSet<QString> names;
+    int domainServerCount = 0;
+
+    foreach(const ProcessSpec& spec, _processes) {
+        if (spec.name.isEmpty()) {
+            errors << "A process has no name";
+        } else if (names.contains(spec.name)) {
+            errors << "More than one process is called " + spec.name;
+        }
+        names.insert(spec.name);
+
+        if (spec.binary.isEmpty()) {
+            errors << spec.name + ": no binary";
+        }
+
+        if (!spec.assignmentType.isEmpty() && !assignmentTypes.contains(spec.assignmentType)) {
+            errors << QString("%1: unknown assignment type \"%2\"").arg(spec.name, spec.assignmentType);
+        }
+
+        if ((!spec.assignmentType.isEmpty() || !spec.pool.isEmpty()) && spec.binary != ASSIGNMENT_CLIENT_BINARY) {
+            errors << spec.name + ": only an assignment-client takes an assignment type or pool";
+        }
+
+        if (spec.replicas < 1 || spec.replicas > MAX_REPLICAS) {
+            errors << QString("%1: replicas must be between 1 and %2").arg(spec.name).arg(MAX_REPLICAS);
+        }
+
+        if (spec.binary == DOMAIN_SERVER_BINARY) {
+            domainServerCount += spec.replicas;
+        }
+
+        foreach(int cpu, spec.limits.cpuSet) {
+            if (cpu < 0 || cpu >= ProcessPlacement::MAX_CPUS) {
+                errors << QString("%1: CPUs in limits must be between 0 and %2").arg(spec.name)
+                    .arg(ProcessPlacement::MAX_CPUS - 1);
+            }
+        }
+
+        if (spec.limits.ioPriorityLevel < 0 || spec.limits.ioPriorityLevel > 7) {
+            errors << spec.name + ": ioLevel must be between 0 and 7";
+        }
+
+        if (spec.limits.cpuQuotaPercent < 0) {
+            errors << spec.name + ": negative cpuPercent in limits";
+        }
+    }
+
+    // the rest of the Stack Manager talks to exactly one domain-server
+    if (domainServerCount != 1) {
+        errors << "A profile needs exactly one domain-server";
+    }
+
+    foreach(const ProcessSpec& spec, _processes) {
+        foreach(const QString& dependency, spec.dependsOn) {
+            if (!names.contains(dependency)) {
+                errors << QString("%1 depends on unknown process %2").arg(spec.name, dependency);
+            } else if (dependency == spec.name) {
+                errors << spec.name + " depends on itself";
+            }
+        }
+    }
+
+    return errors.isEmpty();
+}
+
+LaunchStep StackProfile::stepForSpec(const ProcessSpec& spec, int replica) const {
+    GlobalData& globalData = GlobalData::getInstance();
+
+    LaunchStep step;
+    step.name = spec.replicas > 1 ? QString("%1 %2").arg(spec.name).arg(replica + 1) : spec.name;
+    step.binary = spec.binary;
+    step.restartPolicy = spec.restartPolicy;
+    step.limits = spec.limits;
+    step.isLatencySensitive = spec.latencySensitive;
+
+    if (spec.binary == DOMAIN_SERVER_BINARY) {
+        step.program = globalData.getDomainServerExecutablePath();
+    } else if (spec.binary == ASSIGNMENT_CLIENT_BINARY) {
+        step.program = globalData.getAssignmentClientExecutablePath();
+    } else if (QDir::isAbsolutePath(spec.binary)) {
+        step.program = spec.binary;
+    } else {
+        step.program = QDir::toNativeSeparators(globalData.getClientsLaunchPath() + spec.binary);
+    }
+
+    if (!spec.assignmentType.isEmpty()) {
+        step.arguments << "-t" << QString::number(globalData.getAvailableAssignmentTypes().value(spec.assignmentType));
+    }
+    if (!spec.pool.isEmpty()) {
+        step.arguments << "--pool" << spec.pool;
+    }
+    step.arguments << spec.arguments;
+
+    return step;
+}
+
+bool StackProfile::compile(LaunchPlan& plan, QStringList& errors) const {
+    if (!validate(errors)) {
+        return false;
+    }
+
+    // each process goes one stage after the latest of its dependencies, whatever is left
+    // unplaced once no more progress can be made is part of a cycle
+    QHash<QString, int> stageOf;
+    bool placedAny = true;
+
+    while (placedAny && stageOf.size() < _processes.size()) {
+        placedAny = false;
+
+        foreach(const ProcessSpec& spec, _processes) {
+            if (stageOf.contains(spec.name)) {
+                continue;
+            }
+
+            int stage = 0;
+            bool isReady = true;
+            foreach(const QString& dependency, spec.dependsOn) {
+                if (!stageOf.contains(dependency)) {
+                    isReady = false;
+                    break;
+                }
+                stage = qMax(stage, stageOf[dependency] + 1);
+            }
+
+            if (isReady) {
+                stageOf.insert(spec.name, stage);
+                placedAny = true;
+            }
+        }
+    }
+
+    if (stageOf.size() < _processes.size()) {
+        QStringList cycle;
+        foreach(const ProcessSpec& spec, _processes) {
+            if (!stageOf.contains(spec.name)) {
+                cycle << spec.name;
+            }
+        }
+        errors << "Dependency cycle between " + cycle.join(", ");
+        return false;
+    }
+
+    plan.stages.clear();
+    plan.automaticPlacement = _automaticPlacement;
+    foreach(const ProcessSpec& spec, _processes) {
+        int stage = stageOf[spec.name];
+        while (plan.stages.size() <= stage) {
+            plan.stages << QList<LaunchStep>();
+        }
+
+        for (int replica = 0; replica < spec.replicas; ++replica) {
+            plan.stages[stage] << stepForSpec(spec, replica);
+        }
+    }
+
+    return true;
+}
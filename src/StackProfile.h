@@ -0,0 +1,92 @@
+//
+//  StackProfile.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_StackProfile_h
+#define hifi_StackProfile_h
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "ProcessPlacement.h"
+
+enum RestartPolicy {
+    RestartNever = 0,
+    RestartOnFailure,
+    RestartAlways
+};
+
+struct ProcessSpec {
+    ProcessSpec() : replicas(1), restartPolicy(RestartNever), latencySensitive(false) {}
+
+    QString name;
+    QString binary;
+    QStringList arguments;
+    QString assignmentType;
+    QString pool;
+    int replicas;
+    QStringList dependsOn;
+    RestartPolicy restartPolicy;
+    ProcessLimits limits;
+    bool latencySensitive;
+};
+
+struct LaunchStep {
+    QString name; // the spec name, numbered when it has replicas
+    QString binary;
+    QString program;
+    QStringList arguments;
+    RestartPolicy restartPolicy;
+    ProcessLimits limits;
+    bool isLatencySensitive; // gets a core of its own under automatic placement
+};
+
+// Stages run in order, and every step in a stage only depends on earlier stages, so a stage
+// can be started all at once.
+struct LaunchPlan {
+    LaunchPlan() : automaticPlacement(false) {}
+
+    QList<QList<LaunchStep> > stages;
+    bool automaticPlacement;
+};
+
+// A stack topology read from JSON: the processes to run, how to launch and restart them and
+// what they depend on. compile() checks it and orders it into a LaunchPlan.
+//
+//  { "name": "...", "placement": "manual|auto", "processes": [ { "name": "Audio Mixer",
+//    "binary": "assignment-client", "assignmentType": "audio-mixer", "pool": "", "arguments": [],
+//    "replicas": 1, "dependsOn": ["Domain Server"], "restart": "never|on-failure|always",
+//    "latencySensitive": true, "limits": { "cpus": [2, 3], "numaNode": 0, "nice": 0, "memoryMB": 0,
+//    "ioClass": "realtime|best-effort|idle", "ioLevel": 4, "cpuPercent": 100, "cgroupMemoryMB": 0 } } ] }
+//
+// Mixers are latency sensitive unless a profile says otherwise.
+class StackProfile
+{
+public:
+    static const QString DOMAIN_SERVER_BINARY;
+    static const QString ASSIGNMENT_CLIENT_BINARY;
+    static const QString DEFAULT_PROFILE_PATH;
+
+    StackProfile() : _automaticPlacement(false) {}
+
+    bool load(const QString& path, QStringList& errors);
+    bool compile(LaunchPlan& plan, QStringList& errors) const;
+
+    const QString& getName() const { return _name; }
+    bool hasAutomaticPlacement() const { return _automaticPlacement; }
+    const QList<ProcessSpec>& getProcesses() const { return _processes; }
+
+private:
+    bool validate(QStringList& errors) const;
+    LaunchStep stepForSpec(const ProcessSpec& spec, int replica) const;
+
+    QString _name;
+    bool _automaticPlacement;
+    QList<ProcessSpec> _processes;
+};
+
+#endif
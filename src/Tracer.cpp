@@ -0,0 +1,137 @@
+//
+//  Tracer.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "Tracer.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QThread>
+
+static QElapsedTimer startClock() {
+    QElapsedTimer clock;
+    clock.start();
+    return clock;
+}
+
+// started during static initialisation, before anything could want to record
+static const QElapsedTimer TRACE_CLOCK = startClock();
+
+// untouched pages of the ring cost nothing until a span lands in them
+static TraceEvent traceEvents[Tracer::BUFFER_EVENTS];
+static QAtomicInt nextTraceEvent(0);
+
+static TraceEvent pinnedTraceEvents[Tracer::PINNED_EVENTS];
+static QAtomicInt nextPinnedTraceEvent(0);
+
+static const char PINNED_CATEGORY[] = "startup";
+
+volatile bool Tracer::_isEnabled = true;
+
+void Tracer::setEnabled(bool isEnabled) {
+    if (!isEnabled) {
+        nextTraceEvent.store(0);
+        nextPinnedTraceEvent.store(0);
+    }
+    _isEnabled = isEnabled;
+}
+
+qint64 Tracer::now() {
+    return TRACE_CLOCK.nsecsElapsed() / 1000;
+}
+
+void Tracer::record(const char* category, const char* name, qint64 startMicros, const QString& detail) {
+    TraceEvent* slot = NULL;
+
+    if (qstrcmp(category, PINNED_CATEGORY) == 0) {
+        int pinnedIndex = nextPinnedTraceEvent.fetchAndAddRelaxed(1);
+        if (pinnedIndex < PINNED_EVENTS) {
+            slot = &pinnedTraceEvents[pinnedIndex];
+        } else {
+            // pinned slots all taken, leave the rest to the ring like any other span
+            nextPinnedTraceEvent.store(PINNED_EVENTS);
+        }
+    }
+
+    if (!slot) {
+        slot = &traceEvents[quint32(nextTraceEvent.fetchAndAddRelaxed(1)) % BUFFER_EVENTS];
+    }
+
+    TraceEvent& event = *slot;
+
+    event.category = category;
+    event.name = name;
+    event.startMicros = startMicros;
+    event.durationMicros = now() - startMicros;
+    event.threadID = quintptr(QThread::currentThreadId());
+
+    if (detail.isEmpty()) {
+        event.detail[0] = '\0';
+    } else {
+        qstrncpy(event.detail, detail.toUtf8().constData(), TRACE_DETAIL_SIZE);
+    }
+}
+
+static QJsonObject traceEventObject(const TraceEvent& event, qint64 pid) {
+    QJsonObject eventObject;
+    eventObject["name"] = QString(event.name);
+    eventObject["cat"] = QString(event.category);
+    eventObject["ph"] = QString("X");
+    eventObject["ts"] = double(event.startMicros);
+    eventObject["dur"] = double(event.durationMicros);
+    eventObject["pid"] = double(pid);
+    eventObject["tid"] = double(event.threadID);
+
+    if (event.detail[0] != '\0') {
+        QJsonObject args;
+        args["detail"] = QString::fromUtf8(event.detail);
+        eventObject["args"] = args;
+    }
+
+    return eventObject;
+}
+
+bool Tracer::writeChromeTrace(const QString& path) {
+    quint32 recorded = quint32(nextTraceEvent.load());
+    quint32 count = qMin(recorded, quint32(BUFFER_EVENTS));
+    int pinnedCount = qMin(nextPinnedTraceEvent.load(), PINNED_EVENTS);
+    qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonArray traceEventArray;
+
+    for (int i = 0; i < pinnedCount; ++i) {
+        traceEventArray.append(traceEventObject(pinnedTraceEvents[i], pid));
+    }
+
+    for (quint32 i = recorded - count; i != recorded; ++i) {
+        traceEventArray.append(traceEventObject(traceEvents[i % BUFFER_EVENTS], pid));
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = traceEventArray;
+    root["displayTimeUnit"] = QString("ms");
+
+    QSaveFile traceFile(path);
+    if (!traceFile.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write trace to" << path;
+        return false;
+    }
+
+    traceFile.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!traceFile.commit()) {
+        qWarning() << "Could not write trace to" << path;
+        return false;
+    }
+
+    qDebug() << "Wrote" << traceEventArray.size() << "trace events to" << path;
+    return true;
+}
@@ -0,0 +1,75 @@
+//
+//  Tracer.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_Tracer_h
+#define hifi_Tracer_h
+
+#include <QString>
+
+const int TRACE_DETAIL_SIZE = 48;
+
+struct TraceEvent {
+    const char* category;
+    const char* name;
+    qint64 startMicros;
+    qint64 durationMicros;
+    quintptr threadID;
+    char detail[TRACE_DETAIL_SIZE];
+};
+
+// Records timed spans into a fixed ring of BUFFER_EVENTS and writes them out as Chrome
+// trace-event JSON for chrome://tracing or any viewer that reads that format. Recording a span
+// is a couple of clock reads and a copy into the slot an atomic counter hands out, from any
+// thread; once the ring is full the oldest spans are overwritten. Spans of the "startup"
+// category go to PINNED_EVENTS slots of their own that are never overwritten, so a long session
+// still has its startup in the trace. Category and name must be string literals, the optional
+// detail is truncated to fit its slot.
+//
+// Recording is on from process start so the first steps of startup can be caught, and turned
+// off again once the command line shows no trace was asked for.
+class Tracer
+{
+public:
+    static const int BUFFER_EVENTS = 16384; // a power of two
+    static const int PINNED_EVENTS = 512;
+
+    static bool isEnabled() { return _isEnabled; }
+    static void setEnabled(bool isEnabled);
+
+    static qint64 now();
+    static void record(const char* category, const char* name, qint64 startMicros, const QString& detail = QString());
+
+    static bool writeChromeTrace(const QString& path);
+
+private:
+    static volatile bool _isEnabled;
+};
+
+// Records the time between its construction and destruction as one span.
+class TraceSpan
+{
+public:
+    TraceSpan(const char* category, const char* name, const QString& detail = QString()) :
+        _category(category), _name(name), _detail(detail), _startMicros(Tracer::isEnabled() ? Tracer::now() : -1) {}
+
+    // for a span that turned out to have no work in it, so it does not take up a slot
+    void cancel() { _startMicros = -1; }
+
+    ~TraceSpan() {
+        if (_startMicros >= 0 && Tracer::isEnabled()) {
+            Tracer::record(_category, _name, _startMicros, _detail);
+        }
+    }
+
+private:
+    const char* _category;
+    const char* _name;
+    QString _detail;
+    qint64 _startMicros;
+};
+
+#endif
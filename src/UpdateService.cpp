@@ -0,0 +1,314 @@
+//
+//  UpdateService.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "UpdateService.h"
+#include "GlobalData.h"
+#include "HttpClient.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QNetworkRequest>
+#include <QTextStream>
+
+const int UPDATE_CHECK_INTERVAL_MS = 3600000; // an hour
+const int MSECS_PER_DAY = 86400000;
+
+const HttpRequestPolicy MD5_REQUEST_POLICY(15 * 1000, 3);
+const int BINARY_STALL_TIMEOUT_MS = 60 * 1000;
+
+const char COMPONENT_PROPERTY[] = "updateComponent";
+const char EXPECTED_MD5_PROPERTY[] = "expectedMD5";
+
+const QString STAGED_MD5_SUFFIX = ".md5";
+const QString DOWNLOAD_SUFFIX = ".download";
+const QString PREVIOUS_SUFFIX = ".previous";
+
+static QByteArray parseMD5(const QByteArray& data) {
+    // the MD5 files are "<hash>  <filename>" on some platforms, so only keep the first token
+    QByteArray md5;
+    QTextStream stream(data.trimmed());
+    stream >> md5;
+    return md5.toLower();
+}
+
+UpdateService::UpdateService(HttpClient* httpClient, QObject* parent) :
+    QObject(parent),
+    _httpClient(httpClient),
+    _outstandingChecks(0),
+    _hasNewStage(false)
+{
+    GlobalData& globalData = GlobalData::getInstance();
+    QString stagedPath = globalData.getStagedUpdatesPath();
+
+    Component domainServer;
+    domainServer.name = "domain-server";
+    domainServer.binaryURL = globalData.getDomainServerURL();
+    domainServer.md5URL = globalData.getDomainServerMD5URL();
+    domainServer.activePath = globalData.getDomainServerExecutablePath();
+    domainServer.stagedPath = stagedPath + QFileInfo(domainServer.activePath).fileName();
+    _components << domainServer;
+
+    Component assignmentClient;
+    assignmentClient.name = "assignment-client";
+    assignmentClient.binaryURL = globalData.getAssignmentClientURL();
+    assignmentClient.md5URL = globalData.getAssignmentClientMD5URL();
+    assignmentClient.activePath = globalData.getAssignmentClientExecutablePath();
+    assignmentClient.stagedPath = stagedPath + QFileInfo(assignmentClient.activePath).fileName();
+    _components << assignmentClient;
+
+    // pick up anything a previous run staged and verified but never activated
+    foreach(const Component& component, _components) {
+        QByteArray expectedMD5 = stagedMD5(component);
+        if (!expectedMD5.isEmpty() && md5ForFile(component.stagedPath) == expectedMD5) {
+            qDebug() << "Found staged update for" << component.name;
+            _stagedComponents.insert(component.name);
+        }
+    }
+
+    _checkTimer.setInterval(UPDATE_CHECK_INTERVAL_MS);
+    connect(&_checkTimer, &QTimer::timeout, this, &UpdateService::checkForUpdates);
+    _checkTimer.start();
+
+    _activationTimer.setSingleShot(true);
+    connect(&_activationTimer, &QTimer::timeout, this, &UpdateService::handleScheduledActivation);
+}
+
+void UpdateService::setScheduledActivationTime(const QTime& time) {
+    _scheduledActivationTime = time;
+
+    int msecsUntilActivation = QTime::currentTime().msecsTo(time);
+    if (msecsUntilActivation <= 0) {
+        msecsUntilActivation += MSECS_PER_DAY;
+    }
+
+    qDebug() << "Staged updates will be activated at" << time.toString("hh:mm");
+    _activationTimer.start(msecsUntilActivation);
+}
+
+void UpdateService::checkForUpdates() {
+    if (_outstandingChecks > 0 || !_pendingComponents.isEmpty()) {
+        // the previous check is still running
+        return;
+    }
+
+    foreach(const Component& component, _components) {
+        HttpRequest* request = _httpClient->get(QNetworkRequest(component.md5URL), MD5_REQUEST_POLICY);
+        request->setProperty(COMPONENT_PROPERTY, component.name);
+        connect(request, &HttpRequest::finished, this, &UpdateService::handleMD5Reply);
+        ++_outstandingChecks;
+    }
+}
+
+void UpdateService::handleMD5Reply() {
+    HttpRequest* request = qobject_cast<HttpRequest*>(sender());
+    const Component* component = componentForReply(request);
+    --_outstandingChecks;
+
+    if (!component) {
+        qWarning() << "Ignoring an update check for an unknown component.";
+        maybeEmitUpdateStaged();
+        return;
+    }
+
+    QByteArray latestMD5 = parseMD5(request->getBody());
+
+    if (!request->isSuccess() || latestMD5.isEmpty()) {
+        qDebug() << "Could not check for an update to" << component->name << "-" << request->getErrorString();
+    } else if (latestMD5 == md5ForFile(component->activePath)) {
+        // the active binary is current, anything staged for it is stale
+        discardStage(*component);
+    } else if (latestMD5 != stagedMD5(*component)) {
+        qDebug() << "Staging new build of" << component->name << "in the background.";
+
+        discardStage(*component);
+        _pendingComponents.insert(component->name);
+
+        // the download runs as long as it keeps moving, a failed one is picked up by the next check
+        HttpRequestPolicy binaryPolicy(0);
+        binaryPolicy.stallTimeoutMSecs = BINARY_STALL_TIMEOUT_MS;
+
+        HttpRequest* binaryRequest = _httpClient->get(QNetworkRequest(component->binaryURL), binaryPolicy);
+        binaryRequest->setProperty(COMPONENT_PROPERTY, component->name);
+        binaryRequest->setProperty(EXPECTED_MD5_PROPERTY, latestMD5);
+        connect(binaryRequest, &HttpRequest::finished, this, &UpdateService::handleBinaryReply);
+    }
+    maybeEmitUpdateStaged();
+}
+
+void UpdateService::handleBinaryReply() {
+    HttpRequest* request = qobject_cast<HttpRequest*>(sender());
+    const Component* component = componentForReply(request);
+
+    if (!component) {
+        qWarning() << "Ignoring a downloaded update for an unknown component.";
+        _pendingComponents.remove(request->property(COMPONENT_PROPERTY).toString());
+        maybeEmitUpdateStaged();
+        return;
+    }
+
+    _pendingComponents.remove(component->name);
+
+    // whatever became of this one, another component may have been staged in the same check
+    stageBinary(*component, request);
+    maybeEmitUpdateStaged();
+}
+
+void UpdateService::stageBinary(const Component& component, HttpRequest* request) {
+    QByteArray expectedMD5 = request->property(EXPECTED_MD5_PROPERTY).toByteArray();
+
+    if (!request->isSuccess()) {
+        qDebug() << "Failed to download update for" << component.name << "-" << request->getErrorString();
+        return;
+    }
+
+    const QByteArray& binaryData = request->getBody();
+
+    if (QCryptographicHash::hash(binaryData, QCryptographicHash::Md5).toHex() != expectedMD5) {
+        qDebug() << "Downloaded update for" << component.name << "does not match its MD5, discarding it.";
+        return;
+    }
+
+    QDir().mkpath(GlobalData::getInstance().getStagedUpdatesPath());
+
+    // write next to the slot first so a partially written binary is never considered staged
+    QFile downloadFile(component.stagedPath + DOWNLOAD_SUFFIX);
+    downloadFile.remove();
+    if (!downloadFile.open(QIODevice::WriteOnly) || downloadFile.write(binaryData) != binaryData.size()) {
+        qDebug() << "Could not write staged update to" << downloadFile.fileName();
+        downloadFile.remove();
+        return;
+    }
+    downloadFile.close();
+
+    if (!downloadFile.rename(component.stagedPath)) {
+        qDebug() << "Could not move staged update into place at" << component.stagedPath;
+        downloadFile.remove();
+        return;
+    }
+
+    QFile md5File(component.stagedPath + STAGED_MD5_SUFFIX);
+    if (md5File.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        md5File.write(expectedMD5);
+        md5File.close();
+    }
+
+    qDebug() << "Staged verified update for" << component.name;
+    _stagedComponents.insert(component.name);
+    _hasNewStage = true;
+}
+
+bool UpdateService::activateStagedUpdate() {
+    if (!hasStagedUpdate()) {
+        return false;
+    }
+
+    QList<const Component*> swappedComponents;
+    bool success = true;
+
+    for (int i = 0; i < _components.size(); ++i) {
+        const Component& component = _components[i];
+
+        if (!_stagedComponents.contains(component.name)) {
+            continue;
+        }
+
+        QString previousPath = component.activePath + PREVIOUS_SUFFIX;
+        QFile::remove(previousPath);
+
+        // renaming works even while the old binary is running, the children keep their mapping of it
+        if (QFile::exists(component.activePath) && !QFile::rename(component.activePath, previousPath)) {
+            qDebug() << "Could not move aside active binary" << component.activePath;
+            success = false;
+            break;
+        }
+
+        if (!QFile::rename(component.stagedPath, component.activePath)) {
+            qDebug() << "Could not activate staged binary" << component.stagedPath;
+            QFile::rename(previousPath, component.activePath);
+            success = false;
+            break;
+        }
+
+        QFile::setPermissions(component.activePath, QFile::ExeOwner | QFile::ReadOwner | QFile::WriteOwner);
+        swappedComponents << &component;
+    }
+
+    if (!success) {
+        // put back whatever we already swapped so the pair of binaries stays consistent
+        foreach(const Component* component, swappedComponents) {
+            QFile::rename(component->activePath, component->stagedPath);
+            QFile::rename(component->activePath + PREVIOUS_SUFFIX, component->activePath);
+        }
+        return false;
+    }
+
+    foreach(const Component* component, swappedComponents) {
+        QFile::remove(component->stagedPath + STAGED_MD5_SUFFIX);
+        qDebug() << "Activated staged update for" << component->name;
+    }
+
+    _stagedComponents.clear();
+    return true;
+}
+
+void UpdateService::handleScheduledActivation() {
+    if (hasStagedUpdate()) {
+        qDebug() << "Scheduled update window reached.";
+        emit activationDue();
+    }
+
+    // come back at the same time tomorrow
+    setScheduledActivationTime(_scheduledActivationTime);
+}
+
+const UpdateService::Component* UpdateService::componentForReply(QObject* reply) const {
+    QString name = reply->property(COMPONENT_PROPERTY).toString();
+
+    for (int i = 0; i < _components.size(); ++i) {
+        if (_components[i].name == name) {
+            return &_components[i];
+        }
+    }
+
+    return NULL;
+}
+
+QByteArray UpdateService::md5ForFile(const QString& path) const {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(&file);
+    return hash.result().toHex();
+}
+
+QByteArray UpdateService::stagedMD5(const Component& component) const {
+    QFile md5File(component.stagedPath + STAGED_MD5_SUFFIX);
+    if (!md5File.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    return parseMD5(md5File.readAll());
+}
+
+void UpdateService::discardStage(const Component& component) {
+    _stagedComponents.remove(component.name);
+    QFile::remove(component.stagedPath);
+    QFile::remove(component.stagedPath + STAGED_MD5_SUFFIX);
+}
+
+void UpdateService::maybeEmitUpdateStaged() {
+    if (_hasNewStage && _outstandingChecks == 0 && _pendingComponents.isEmpty()) {
+        _hasNewStage = false;
+        emit updateStaged();
+    }
+}
@@ -0,0 +1,79 @@
+//
+//  UpdateService.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_UpdateService_h
+#define hifi_UpdateService_h
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTime>
+#include <QTimer>
+#include <QUrl>
+
+class HttpClient;
+class HttpRequest;
+
+// Keeps the domain-server and assignment-client binaries current while the stack runs.
+// New builds are downloaded and MD5-verified into an inactive "staged" slot next to the
+// active binaries; activation swaps the slots with renames so it is effectively atomic,
+// and keeps the replaced binaries as *.previous for a manual rollback.
+class UpdateService : public QObject
+{
+    Q_OBJECT
+public:
+    UpdateService(HttpClient* httpClient, QObject* parent = 0);
+
+    bool hasStagedUpdate() const { return !_stagedComponents.isEmpty() && _pendingComponents.isEmpty(); }
+
+    void setScheduledActivationTime(const QTime& time);
+
+public slots:
+    void checkForUpdates();
+    bool activateStagedUpdate();
+
+signals:
+    void updateStaged();
+    void activationDue();
+
+private slots:
+    void handleMD5Reply();
+    void handleBinaryReply();
+    void handleScheduledActivation();
+
+private:
+    struct Component {
+        QString name;
+        QUrl binaryURL;
+        QUrl md5URL;
+        QString activePath;
+        QString stagedPath;
+    };
+
+    // NULL when the reply names no known component
+    const Component* componentForReply(QObject* reply) const;
+    void stageBinary(const Component& component, HttpRequest* request);
+    QByteArray md5ForFile(const QString& path) const;
+    QByteArray stagedMD5(const Component& component) const;
+    void discardStage(const Component& component);
+    void maybeEmitUpdateStaged();
+
+    HttpClient* _httpClient;
+    QList<Component> _components;
+    QSet<QString> _pendingComponents;
+    QSet<QString> _stagedComponents;
+    int _outstandingChecks;
+    bool _hasNewStage;
+
+    QTimer _checkTimer;
+    QTimer _activationTimer;
+    QTime _scheduledActivationTime;
+};
+
+#endif
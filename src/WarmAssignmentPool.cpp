@@ -0,0 +1,197 @@
+//
+//  WarmAssignmentPool.cpp
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "WarmAssignmentPool.h"
+
+#include <QDebug>
+
+#include "BackgroundProcess.h"
+#include "GlobalData.h"
+
+const int REFILL_INTERVAL_MS = 2000;
+const qint64 DEMAND_WINDOW_MS = 5 * 60 * 1000;
+
+// with no recent demand one process still waits in the default pool
+const int MIN_IDLE_PROCESSES = 1;
+
+WarmAssignmentPool::WarmAssignmentPool(int maxSize, QObject* parent) :
+    QObject(parent),
+    _maxSize(qMax(maxSize, MIN_IDLE_PROCESSES)),
+    _isRunning(false),
+    _warmHandoutCount(0),
+    _coldHandoutCount(0)
+{
+    _clock.start();
+
+    _refillTimer.setInterval(REFILL_INTERVAL_MS);
+    connect(&_refillTimer, &QTimer::timeout, this, &WarmAssignmentPool::refill);
+}
+
+QStringList WarmAssignmentPool::argumentsForPool(const QString& pool) {
+    QStringList arguments = QStringList() << "-t"
+        << QString::number(GlobalData::getInstance().getAvailableAssignmentTypes().value("agent"));
+    if (!pool.isEmpty()) {
+        arguments << "--pool" << pool;
+    }
+    return arguments;
+}
+
+void WarmAssignmentPool::start() {
+    _isRunning = true;
+    _refillTimer.start();
+    refill();
+}
+
+void WarmAssignmentPool::stop() {
+    _isRunning = false;
+    _refillTimer.stop();
+
+    foreach(BackgroundProcess* process, _idleProcesses.keys()) {
+        retire(process);
+    }
+}
+
+BackgroundProcess* WarmAssignmentPool::take(const QString& pool) {
+    _handouts << qMakePair(_clock.elapsed(), pool);
+
+    // one waiting in another pool would have to be stopped first, a cold start is no slower
+    BackgroundProcess* process = NULL;
+    QHash<BackgroundProcess*, QString>::const_iterator it = _idleProcesses.constBegin();
+    for (; it != _idleProcesses.constEnd(); ++it) {
+        if (it.key()->state() == QProcess::Running && it.value() == pool) {
+            process = it.key();
+            break;
+        }
+    }
+
+    if (_isRunning) {
+        // replace whatever we hand out without waiting for the next tick
+        QTimer::singleShot(0, this, SLOT(refill()));
+    }
+
+    if (!process) {
+        ++_coldHandoutCount;
+        qDebug() << "No warm scripted assignment-client for pool" << pool << "-" << _warmHandoutCount << "warm,"
+            << _coldHandoutCount << "cold so far";
+        return NULL;
+    }
+
+    _idleProcesses.remove(process);
+    disconnect(process, 0, this, 0);
+
+    ++_warmHandoutCount;
+    qDebug() << "Handing out a warm scripted assignment-client for pool" << pool << "-" << _warmHandoutCount
+        << "warm," << _coldHandoutCount << "cold so far";
+
+    return process;
+}
+
+void WarmAssignmentPool::replaceIdleProcesses() {
+    foreach(BackgroundProcess* process, _idleProcesses.keys()) {
+        retire(process);
+    }
+
+    refill();
+}
+
+QHash<QString, int> WarmAssignmentPool::targetSizes() {
+    qint64 windowStart = _clock.elapsed() - DEMAND_WINDOW_MS;
+    while (!_handouts.isEmpty() && _handouts.first().first < windowStart) {
+        _handouts.removeFirst();
+    }
+
+    QHash<QString, int> targets;
+    for (int i = 0; i < _handouts.size(); ++i) {
+        ++targets[_handouts[i].second];
+    }
+
+    if (targets.isEmpty()) {
+        targets.insert(QString(), MIN_IDLE_PROCESSES);
+    }
+
+    // over the cap, the busiest pools give up processes first
+    int total = 0;
+    foreach(int target, targets) {
+        total += target;
+    }
+
+    while (total > _maxSize) {
+        QHash<QString, int>::iterator busiest = targets.begin();
+        for (QHash<QString, int>::iterator it = targets.begin(); it != targets.end(); ++it) {
+            if (it.value() > busiest.value()) {
+                busiest = it;
+            }
+        }
+        --busiest.value();
+        --total;
+    }
+
+    return targets;
+}
+
+void WarmAssignmentPool::refill() {
+    if (!_isRunning) {
+        return;
+    }
+
+    QHash<QString, int> targets = targetSizes();
+    QHash<QString, int> idleCounts;
+    foreach(const QString& pool, _idleProcesses) {
+        ++idleCounts[pool];
+    }
+
+    // shed first, so falling demand in one pool frees room for another
+    foreach(BackgroundProcess* process, _idleProcesses.keys()) {
+        QString pool = _idleProcesses.value(process);
+        if (idleCounts[pool] > targets.value(pool)) {
+            --idleCounts[pool];
+            retire(process);
+        }
+    }
+
+    QHash<QString, int>::const_iterator it = targets.constBegin();
+    for (; it != targets.constEnd(); ++it) {
+        for (int count = idleCounts.value(it.key()); count < it.value(); ++count) {
+            startIdleProcess(it.key());
+        }
+    }
+}
+
+void WarmAssignmentPool::startIdleProcess(const QString& pool) {
+    BackgroundProcess* process = new BackgroundProcess(GlobalData::getInstance().getAssignmentClientExecutablePath(),
+                                                       this);
+    connect(process, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(idleProcessFinished()));
+    connect(process, SIGNAL(error(QProcess::ProcessError)), this, SLOT(idleProcessFinished()));
+
+    _idleProcesses.insert(process, pool);
+    process->setCpuSet(_cpuSet);
+    process->start(argumentsForPool(pool));
+}
+
+void WarmAssignmentPool::idleProcessFinished() {
+    BackgroundProcess* process = qobject_cast<BackgroundProcess*>(sender());
+
+    // the next refill replaces it
+    if (process && _idleProcesses.remove(process) > 0) {
+        qDebug() << "A warm scripted assignment-client exited while idle";
+        process->deleteLater();
+    }
+}
+
+void WarmAssignmentPool::retire(BackgroundProcess* process) {
+    _idleProcesses.remove(process);
+    disconnect(process, 0, this, 0);
+
+    if (process->state() == QProcess::NotRunning) {
+        process->deleteLater();
+        return;
+    }
+
+    // reaped when it exits, so retiring a whole pool never waits on one process after another
+    connect(process, SIGNAL(finished(int, QProcess::ExitStatus)), process, SLOT(deleteLater()));
+    process->requestStop();
+}
@@ -0,0 +1,69 @@
+//
+//  WarmAssignmentPool.h
+//  StackManagerQt/src
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_WarmAssignmentPool_h
+#define hifi_WarmAssignmentPool_h
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+class BackgroundProcess;
+
+// Scripted assignment-clients started ahead of demand, so running a script doesn't wait on a
+// fork, exec and domain-server handshake. Idle processes already wait in the pool they will be
+// asked for, and a request no idle process matches is started cold. How many are kept per pool
+// follows the handouts of the last few minutes, up to the size given with --warm-pool.
+class WarmAssignmentPool : public QObject
+{
+    Q_OBJECT
+public:
+    WarmAssignmentPool(int maxSize, QObject* parent = 0);
+
+    static QStringList argumentsForPool(const QString& pool);
+
+    // a running process the caller now owns, or NULL to start one cold
+    BackgroundProcess* take(const QString& pool);
+
+    int getIdleCount() const { return _idleProcesses.size(); }
+
+    // after the binary changed, idle processes still run the old one
+    void replaceIdleProcesses();
+
+    // for processes started from here on, empty leaves them on every core
+    void setCpuSet(const QVector<int>& cpuSet) { _cpuSet = cpuSet; }
+
+public slots:
+    void start();
+    void stop();
+
+private slots:
+    void refill();
+    void idleProcessFinished();
+
+private:
+    QHash<QString, int> targetSizes();
+    void startIdleProcess(const QString& pool);
+    void retire(BackgroundProcess* process);
+
+    int _maxSize;
+    QVector<int> _cpuSet;
+    bool _isRunning;
+    QHash<BackgroundProcess*, QString> _idleProcesses;
+    QList<QPair<qint64, QString> > _handouts; // when, and for which pool
+    QElapsedTimer _clock;
+    QTimer _refillTimer;
+    quint64 _warmHandoutCount;
+    quint64 _coldHandoutCount;
+};
+
+#endif
@@ -0,0 +1,82 @@
+//
+//  AssignmentDelegate.cpp
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "AssignmentDelegate.h"
+
+#include <QApplication>
+#include <QMouseEvent>
+#include <QPainter>
+
+#include "AssignmentModel.h"
+#include "SvgPixmapCache.h"
+
+// the assignment-run.svg and assignment-stop.svg artwork is 59x32
+const QSize RUN_BUTTON_SIZE = QSize(44, 24);
+const int RUN_BUTTON_MARGIN = 4;
+
+AssignmentDelegate::AssignmentDelegate(QObject* parent) :
+    QStyledItemDelegate(parent)
+{
+
+}
+
+QRect AssignmentDelegate::buttonRect(const QRect& cellRect) const {
+    return QRect(cellRect.left() + RUN_BUTTON_MARGIN,
+                 cellRect.top() + (cellRect.height() - RUN_BUTTON_SIZE.height()) / 2,
+                 RUN_BUTTON_SIZE.width(), RUN_BUTTON_SIZE.height());
+}
+
+void AssignmentDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const {
+    if (index.column() != AssignmentModel::StateColumn) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    const AssignmentModel* model = static_cast<const AssignmentModel*>(index.model());
+
+    QStyleOptionViewItem textOption = option;
+    initStyleOption(&textOption, index);
+    QStyle* style = textOption.widget ? textOption.widget->style() : QApplication::style();
+
+    // the background spans the whole cell, the state text sits to the right of the button
+    QStyleOptionViewItem backgroundOption = textOption;
+    backgroundOption.text.clear();
+    style->drawControl(QStyle::CE_ItemViewItem, &backgroundOption, painter, textOption.widget);
+
+    textOption.rect.setLeft(option.rect.left() + RUN_BUTTON_MARGIN * 2 + RUN_BUTTON_SIZE.width());
+    style->drawControl(QStyle::CE_ItemViewItem, &textOption, painter, textOption.widget);
+
+    QString svgImage = model->isRunning(index.row()) ? ":/assignment-stop.svg" : ":/assignment-run.svg";
+    SvgPixmapCache::State state = (option.state & QStyle::State_Enabled) ? SvgPixmapCache::Normal : SvgPixmapCache::Disabled;
+    painter->drawPixmap(buttonRect(option.rect).topLeft(),
+                        SvgPixmapCache::pixmap(svgImage, RUN_BUTTON_SIZE, painter->device()->devicePixelRatio(), state));
+}
+
+QSize AssignmentDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const {
+    QSize size = QStyledItemDelegate::sizeHint(option, index);
+
+    if (index.column() == AssignmentModel::StateColumn) {
+        size.setWidth(size.width() + RUN_BUTTON_MARGIN * 2 + RUN_BUTTON_SIZE.width());
+    }
+    size.setHeight(qMax(size.height(), RUN_BUTTON_SIZE.height() + RUN_BUTTON_MARGIN * 2));
+
+    return size;
+}
+
+bool AssignmentDelegate::editorEvent(QEvent* event, QAbstractItemModel* model, const QStyleOptionViewItem& option,
+                                     const QModelIndex& index) {
+    if (index.column() == AssignmentModel::StateColumn && event->type() == QEvent::MouseButtonRelease) {
+        QMouseEvent* mouseEvent = static_cast<QMouseEvent*>(event);
+
+        if (mouseEvent->button() == Qt::LeftButton && buttonRect(option.rect).contains(mouseEvent->pos())) {
+            static_cast<AssignmentModel*>(model)->toggle(index.row());
+            return true;
+        }
+    }
+
+    return QStyledItemDelegate::editorEvent(event, model, option, index);
+}
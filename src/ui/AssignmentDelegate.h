@@ -0,0 +1,33 @@
+//
+//  AssignmentDelegate.h
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_AssignmentDelegate_h
+#define hifi_AssignmentDelegate_h
+
+#include <QStyledItemDelegate>
+
+// Paints the run/stop button into each assignment's state cell and toggles the assignment when
+// it is clicked. The button is only drawn, never a widget, so rows stay cheap however many
+// there are.
+class AssignmentDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    explicit AssignmentDelegate(QObject* parent = 0);
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const;
+
+protected:
+    bool editorEvent(QEvent* event, QAbstractItemModel* model, const QStyleOptionViewItem& option,
+                     const QModelIndex& index);
+
+private:
+    QRect buttonRect(const QRect& cellRect) const;
+};
+
+#endif
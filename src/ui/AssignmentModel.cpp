@@ -0,0 +1,244 @@
+//
+//  AssignmentModel.cpp
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "AssignmentModel.h"
+
+#include <algorithm>
+
+#include "AppDelegate.h"
+#include "ProcessStats.h"
+
+const int SAMPLE_INTERVAL_MS = 2000;
+const int SHORT_SCRIPT_ID_LENGTH = 8;
+const double BYTES_PER_MB = 1024.0 * 1024.0;
+
+AssignmentModel::AssignmentModel(QObject* parent) :
+    QAbstractTableModel(parent)
+{
+    _clock.start();
+
+    _sampleTimer.setInterval(SAMPLE_INTERVAL_MS);
+    connect(&_sampleTimer, &QTimer::timeout, this, &AssignmentModel::sampleProcesses);
+    _sampleTimer.start();
+}
+
+int AssignmentModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : _assignments.size();
+}
+
+int AssignmentModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant AssignmentModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= _assignments.size()) {
+        return QVariant();
+    }
+
+    const Assignment& assignment = _assignments[index.row()];
+
+    if (role == Qt::ToolTipRole && index.column() == ScriptIDColumn) {
+        return assignment.scriptID.toString();
+    }
+
+    if (role == Qt::EditRole && index.column() == PoolColumn) {
+        return assignment.pool;
+    }
+
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (index.column()) {
+        case ScriptIDColumn:
+            // drop the opening brace
+            return assignment.scriptID.toString().mid(1, SHORT_SCRIPT_ID_LENGTH);
+        case PoolColumn:
+            return assignment.pool.isEmpty() ? QString("-") : assignment.pool;
+        case ProcessIDColumn:
+            return assignment.processID > 0 ? QString::number(assignment.processID) : QString();
+        case StateColumn:
+            if (!assignment.isRunning) {
+                return QString("Stopped");
+            }
+            return assignment.hasExited ? QString("Exited") : QString("Running");
+        case CPUColumn:
+            return assignment.cpuPercent >= 0.0 ? QString("%1%").arg(assignment.cpuPercent, 0, 'f', 1) : QString();
+        case MemoryColumn:
+            return assignment.residentBytes >= 0
+                ? QString("%1 MB").arg(assignment.residentBytes / BYTES_PER_MB, 0, 'f', 1) : QString();
+        default:
+            return QVariant();
+    }
+}
+
+QVariant AssignmentModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (section) {
+        case ScriptIDColumn:
+            return QString("Script");
+        case PoolColumn:
+            return QString("Pool ID");
+        case ProcessIDColumn:
+            return QString("PID");
+        case StateColumn:
+            return QString("State");
+        case CPUColumn:
+            return QString("CPU");
+        case MemoryColumn:
+            return QString("RSS");
+        default:
+            return QVariant();
+    }
+}
+
+Qt::ItemFlags AssignmentModel::flags(const QModelIndex& index) const {
+    Qt::ItemFlags itemFlags = QAbstractTableModel::flags(index);
+
+    // the pool is passed on the command line, so it can only change while stopped
+    if (index.isValid() && index.column() == PoolColumn && !_assignments[index.row()].isRunning) {
+        itemFlags |= Qt::ItemIsEditable;
+    }
+
+    return itemFlags;
+}
+
+bool AssignmentModel::setData(const QModelIndex& index, const QVariant& value, int role) {
+    if (!index.isValid() || index.column() != PoolColumn || role != Qt::EditRole
+        || _assignments[index.row()].isRunning) {
+        return false;
+    }
+
+    _assignments[index.row()].pool = value.toString().trimmed();
+    emit dataChanged(index, index);
+    return true;
+}
+
+void AssignmentModel::addAssignment() {
+    Assignment assignment;
+    assignment.scriptID = QUuid::createUuid();
+
+    beginInsertRows(QModelIndex(), _assignments.size(), _assignments.size());
+    _assignments.append(assignment);
+    endInsertRows();
+}
+
+void AssignmentModel::toggle(int row) {
+    if (_assignments[row].isRunning) {
+        stopRow(row);
+    } else {
+        startRow(row);
+    }
+}
+
+void AssignmentModel::start(const QList<int>& rows) {
+    foreach(int row, rows) {
+        if (!_assignments[row].isRunning) {
+            startRow(row);
+        }
+    }
+}
+
+void AssignmentModel::stop(const QList<int>& rows) {
+    foreach(int row, rows) {
+        if (_assignments[row].isRunning) {
+            stopRow(row);
+        }
+    }
+}
+
+void AssignmentModel::remove(const QList<int>& rows) {
+    stop(rows);
+
+    // from the bottom up so the remaining row numbers stay valid
+    QList<int> sortedRows = rows;
+    std::sort(sortedRows.begin(), sortedRows.end());
+
+    for (int i = sortedRows.size() - 1; i >= 0; --i) {
+        int row = sortedRows[i];
+        beginRemoveRows(QModelIndex(), row, row);
+        _assignments.remove(row);
+        endRemoveRows();
+    }
+}
+
+void AssignmentModel::startRow(int row) {
+    Assignment& assignment = _assignments[row];
+
+    AppDelegate* app = AppDelegate::getInstance();
+    app->startScriptedAssignment(assignment.scriptID, assignment.pool);
+
+    // 0 until the spawner reports the child, sampleProcesses picks it up then
+    assignment.processID = app->getScriptedAssignmentProcessID(assignment.scriptID);
+    assignment.isRunning = true;
+    assignment.hasExited = false;
+    assignment.lastCpuMSecs = -1;
+
+    emitRowChanged(row);
+}
+
+void AssignmentModel::stopRow(int row) {
+    Assignment& assignment = _assignments[row];
+
+    AppDelegate::getInstance()->stopScriptedAssignment(assignment.scriptID);
+    assignment.processID = 0;
+    assignment.isRunning = false;
+    assignment.cpuPercent = -1.0;
+    assignment.residentBytes = -1;
+
+    emitRowChanged(row);
+}
+
+void AssignmentModel::emitRowChanged(int row) {
+    emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+}
+
+void AssignmentModel::sampleProcesses() {
+    AppDelegate* app = AppDelegate::getInstance();
+    qint64 now = _clock.elapsed();
+    int firstChanged = -1;
+    int lastChanged = -1;
+
+    for (int row = 0; row < _assignments.size(); ++row) {
+        Assignment& assignment = _assignments[row];
+        if (!assignment.isRunning) {
+            continue;
+        }
+
+        // the stack restarts scripted processes under new IDs, and they can exit on their own
+        assignment.processID = app->getScriptedAssignmentProcessID(assignment.scriptID);
+        assignment.hasExited = !app->isScriptedAssignmentRunning(assignment.scriptID);
+
+        ProcessSample sample;
+        if (ProcessStats::sample(assignment.processID, sample)) {
+            if (assignment.lastCpuMSecs >= 0 && now > assignment.lastSampleMSecs) {
+                assignment.cpuPercent = 100.0 * (sample.cpuMSecs - assignment.lastCpuMSecs)
+                    / (now - assignment.lastSampleMSecs);
+            }
+            assignment.lastCpuMSecs = sample.cpuMSecs;
+            assignment.residentBytes = sample.residentBytes;
+        } else {
+            assignment.lastCpuMSecs = -1;
+            assignment.cpuPercent = -1.0;
+            assignment.residentBytes = -1;
+        }
+        assignment.lastSampleMSecs = now;
+
+        if (firstChanged < 0) {
+            firstChanged = row;
+        }
+        lastChanged = row;
+    }
+
+    // one notification for the whole span, the view only repaints what is on screen
+    if (firstChanged >= 0) {
+        emit dataChanged(index(firstChanged, ProcessIDColumn), index(lastChanged, MemoryColumn));
+    }
+}
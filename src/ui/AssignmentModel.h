@@ -0,0 +1,79 @@
+//
+//  AssignmentModel.h
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_AssignmentModel_h
+#define hifi_AssignmentModel_h
+
+#include <QAbstractTableModel>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QUuid>
+#include <QVector>
+
+// The scripted assignments added from the main window, one row each, with the state and
+// resource use of their process. Rows are plain data rendered by a view, so adding hundreds
+// of them costs no widgets, and CPU/RSS are sampled only for rows that are running.
+class AssignmentModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    enum Column {
+        ScriptIDColumn = 0,
+        PoolColumn,
+        ProcessIDColumn,
+        StateColumn,
+        CPUColumn,
+        MemoryColumn,
+        ColumnCount
+    };
+
+    explicit AssignmentModel(QObject* parent = 0);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    Qt::ItemFlags flags(const QModelIndex& index) const;
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole);
+
+    bool isRunning(int row) const { return _assignments[row].isRunning; }
+
+    void addAssignment();
+    void toggle(int row);
+    void start(const QList<int>& rows);
+    void stop(const QList<int>& rows);
+    void remove(const QList<int>& rows);
+
+private slots:
+    void sampleProcesses();
+
+private:
+    struct Assignment {
+        Assignment() : processID(0), isRunning(false), hasExited(false), cpuPercent(-1.0), residentBytes(-1),
+            lastCpuMSecs(-1), lastSampleMSecs(0) {}
+
+        QUuid scriptID;
+        QString pool;
+        qint64 processID;
+        bool isRunning;
+        bool hasExited;
+        double cpuPercent;
+        qint64 residentBytes;
+        qint64 lastCpuMSecs;
+        qint64 lastSampleMSecs;
+    };
+
+    void startRow(int row);
+    void stopRow(int row);
+    void emitRowChanged(int row);
+
+    QVector<Assignment> _assignments;
+    QTimer _sampleTimer;
+    QElapsedTimer _clock;
+};
+
+#endif
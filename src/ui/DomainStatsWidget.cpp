@@ -0,0 +1,150 @@
+//
+//  DomainStatsWidget.cpp
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "DomainStatsWidget.h"
+
+#include <QPainter>
+
+const int TEXT_LINES = 2;
+const int SPARKLINE_HEIGHT = 28;
+const int SPARKLINE_SPACING = 12;
+const int LINE_SPACING = 4;
+
+const QColor TEXT_COLOR = QColor(84, 84, 84);
+const QColor NODES_COLOR = QColor(3, 150, 126);
+const QColor BANDWIDTH_COLOR = QColor(41, 128, 185);
+const QColor BASELINE_COLOR = QColor(205, 205, 205);
+
+static QString formatKbps(double kbps) {
+    return kbps >= 1000.0 ? QString("%1 Mbps").arg(kbps / 1000.0, 0, 'f', 1) : QString("%1 kbps").arg(kbps, 0, 'f', 0);
+}
+
+DomainStatsWidget::DomainStatsWidget(DomainStatsPoller* poller, QWidget* parent) :
+    QWidget(parent),
+    _poller(poller)
+{
+    connect(_poller, &DomainStatsPoller::sampled, this, &DomainStatsWidget::refresh);
+}
+
+void DomainStatsWidget::refresh() {
+    // the second line is elided to fit, the tooltip has all of it
+    if (_poller->getSampleCount() > 0) {
+        setToolTip(describeNodeTypes(_poller->getLatestSample()).join("\n"));
+    }
+    update();
+}
+
+QStringList DomainStatsWidget::describeNodeTypes(const DomainStatsSample& sample) const {
+    const QStringList& nodeTypes = _poller->getNodeTypes();
+    QStringList descriptions;
+
+    for (int type = 0; type < sample.nodesByType.size(); ++type) {
+        if (sample.nodesByType[type] == 0) {
+            continue;
+        }
+
+        QString description = QString("%1 %2").arg(nodeTypes[type]).arg(sample.nodesByType[type]);
+        if (sample.hasBandwidth) {
+            description += QString(" (%1 / %2)").arg(formatKbps(sample.inboundKbpsByType[type]),
+                                                     formatKbps(sample.outboundKbpsByType[type]));
+        }
+        descriptions << description;
+    }
+
+    return descriptions;
+}
+
+QSize DomainStatsWidget::sizeHint() const {
+    return QSize(QWidget::sizeHint().width(),
+                 TEXT_LINES * (fontMetrics().height() + LINE_SPACING) + SPARKLINE_HEIGHT);
+}
+
+void DomainStatsWidget::paintEvent(QPaintEvent*) {
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(TEXT_COLOR);
+
+    int lineHeight = fontMetrics().height() + LINE_SPACING;
+    QRect firstLine(0, 0, width(), lineHeight);
+    QRect secondLine = firstLine.translated(0, lineHeight);
+
+    if (_poller->getSampleCount() == 0) {
+        painter.drawText(firstLine, Qt::AlignLeft | Qt::AlignVCenter, "Waiting for domain-server stats...");
+        return;
+    }
+
+    const DomainStatsSample& latest = _poller->getLatestSample();
+
+    double inboundKbps = 0.0;
+    double outboundKbps = 0.0;
+    for (int type = 0; type < latest.nodesByType.size(); ++type) {
+        inboundKbps += latest.inboundKbpsByType[type];
+        outboundKbps += latest.outboundKbpsByType[type];
+    }
+
+    QString bandwidth = "bandwidth not reported";
+    if (latest.hasBandwidth) {
+        bandwidth = QString("%1 in / %2 out").arg(formatKbps(inboundKbps), formatKbps(outboundKbps));
+    }
+
+    painter.drawText(firstLine, Qt::AlignLeft | Qt::AlignVCenter,
+                     QString("%1 nodes, %2 pending and %3 fulfilled assignments, %4")
+                     .arg(latest.nodeCount).arg(latest.pendingAssignments).arg(latest.fulfilledAssignments)
+                     .arg(bandwidth));
+
+    painter.drawText(secondLine, Qt::AlignLeft | Qt::AlignVCenter,
+                     fontMetrics().elidedText(describeNodeTypes(latest).join("   "), Qt::ElideRight, width()));
+
+    QVector<double> nodeCounts;
+    QVector<double> totalKbps;
+    for (int i = 0; i < _poller->getSampleCount(); ++i) {
+        const DomainStatsSample& sample = _poller->getSample(i);
+        nodeCounts << sample.nodeCount;
+
+        double kbps = 0.0;
+        for (int type = 0; type < sample.inboundKbpsByType.size(); ++type) {
+            kbps += sample.inboundKbpsByType[type] + sample.outboundKbpsByType[type];
+        }
+        totalKbps << kbps;
+    }
+
+    int sparklineWidth = (width() - SPARKLINE_SPACING) / 2;
+    int sparklineY = secondLine.bottom() + 1;
+    drawSparkline(painter, QRect(0, sparklineY, sparklineWidth, SPARKLINE_HEIGHT), nodeCounts, NODES_COLOR);
+    drawSparkline(painter, QRect(sparklineWidth + SPARKLINE_SPACING, sparklineY, sparklineWidth, SPARKLINE_HEIGHT),
+                  totalKbps, BANDWIDTH_COLOR);
+}
+
+void DomainStatsWidget::drawSparkline(QPainter& painter, const QRect& rect, const QVector<double>& values,
+                                      const QColor& color) {
+    painter.setPen(BASELINE_COLOR);
+    painter.drawLine(rect.bottomLeft(), rect.bottomRight());
+
+    if (values.size() < 2) {
+        return;
+    }
+
+    double maxValue = 0.0;
+    foreach(double value, values) {
+        maxValue = qMax(maxValue, value);
+    }
+    if (maxValue <= 0.0) {
+        return;
+    }
+
+    // the full history spans the rect, newest on the right
+    QPolygonF line;
+    double step = double(rect.width()) / (DomainStatsPoller::HISTORY_SAMPLES - 1);
+    double x = rect.right() - step * (values.size() - 1);
+    foreach(double value, values) {
+        line << QPointF(x, rect.bottom() - (rect.height() - 1) * value / maxValue);
+        x += step;
+    }
+
+    painter.setPen(QPen(color, 1.5));
+    painter.drawPolyline(line);
+}
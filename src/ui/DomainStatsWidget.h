@@ -0,0 +1,38 @@
+//
+//  DomainStatsWidget.h
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_DomainStatsWidget_h
+#define hifi_DomainStatsWidget_h
+
+#include <QWidget>
+
+#include "DomainStatsPoller.h"
+
+// A compact dashboard of the domain: node and assignment counts, bandwidth per node type, and
+// sparklines of node count and total bandwidth over the poller's history.
+class DomainStatsWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit DomainStatsWidget(DomainStatsPoller* poller, QWidget* parent = 0);
+
+    QSize sizeHint() const;
+
+protected:
+    void paintEvent(QPaintEvent* event);
+
+private slots:
+    void refresh();
+
+private:
+    QStringList describeNodeTypes(const DomainStatsSample& sample) const;
+    void drawSparkline(QPainter& painter, const QRect& rect, const QVector<double>& values, const QColor& color);
+
+    DomainStatsPoller* _poller;
+};
+
+#endif
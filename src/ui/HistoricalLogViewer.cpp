@@ -0,0 +1,89 @@
+//
+//  HistoricalLogViewer.cpp
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "HistoricalLogViewer.h"
+
+#include <QFontDatabase>
+#include <QPainter>
+#include <QScrollBar>
+
+const int TEXT_LEFT_MARGIN = 4;
+
+HistoricalLogViewer::HistoricalLogViewer(QWidget* parent) :
+    QAbstractScrollArea(parent),
+    _logFile(NULL),
+    _cachedFirstLine(-1),
+    _cachedLineCount(0)
+{
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    viewport()->setAutoFillBackground(true);
+}
+
+void HistoricalLogViewer::setLogFile(MappedLogFile* logFile) {
+    if (_logFile) {
+        disconnect(_logFile, 0, this, 0);
+    }
+
+    _logFile = logFile;
+    _cachedLines.clear();
+    _cachedFirstLine = -1;
+    verticalScrollBar()->setValue(0);
+
+    if (_logFile) {
+        connect(_logFile, &MappedLogFile::indexProgress, this, &HistoricalLogViewer::updateLineCount);
+    }
+
+    updateLineCount();
+}
+
+void HistoricalLogViewer::updateLineCount() {
+    int lineCount = _logFile ? _logFile->getLineCount() : 0;
+    int pageStep = visibleLineCount();
+
+    verticalScrollBar()->setPageStep(pageStep);
+    verticalScrollBar()->setRange(0, qMax(0, lineCount - pageStep));
+
+    // lines near the end of what was indexed may have been cut short, fetch them again
+    _cachedFirstLine = -1;
+    viewport()->update();
+}
+
+void HistoricalLogViewer::resizeEvent(QResizeEvent* event) {
+    QAbstractScrollArea::resizeEvent(event);
+    updateLineCount();
+}
+
+int HistoricalLogViewer::visibleLineCount() const {
+    return viewport()->height() / fontMetrics().lineSpacing() + 1;
+}
+
+void HistoricalLogViewer::paintEvent(QPaintEvent*) {
+    if (!_logFile) {
+        return;
+    }
+
+    int firstLine = verticalScrollBar()->value();
+    int lineCount = visibleLineCount();
+
+    if (firstLine != _cachedFirstLine || lineCount != _cachedLineCount) {
+        _cachedLines = _logFile->readLines(firstLine, lineCount);
+        _cachedFirstLine = firstLine;
+        _cachedLineCount = lineCount;
+    }
+
+    QPainter painter(viewport());
+    painter.setPen(palette().color(QPalette::Text));
+
+    int lineSpacing = fontMetrics().lineSpacing();
+    int y = fontMetrics().ascent();
+
+    foreach(const QString& line, _cachedLines) {
+        painter.drawText(TEXT_LEFT_MARGIN, y, line);
+        y += lineSpacing;
+    }
+}
@@ -0,0 +1,41 @@
+//
+//  HistoricalLogViewer.h
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_HistoricalLogViewer_h
+#define hifi_HistoricalLogViewer_h
+
+#include <QAbstractScrollArea>
+#include <QStringList>
+
+#include "MappedLogFile.h"
+
+// Virtualized view over a MappedLogFile that only ever asks for the lines on screen.
+class HistoricalLogViewer : public QAbstractScrollArea
+{
+    Q_OBJECT
+public:
+    explicit HistoricalLogViewer(QWidget* parent = 0);
+
+    void setLogFile(MappedLogFile* logFile);
+
+protected:
+    virtual void paintEvent(QPaintEvent*);
+    virtual void resizeEvent(QResizeEvent*);
+
+private slots:
+    void updateLineCount();
+
+private:
+    int visibleLineCount() const;
+
+    MappedLogFile* _logFile;
+    QStringList _cachedLines;
+    int _cachedFirstLine;
+    int _cachedLineCount;
+};
+
+#endif
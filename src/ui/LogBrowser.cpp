@@ -0,0 +1,143 @@
+//
+//  LogBrowser.cpp
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "LogBrowser.h"
+#include "GlobalData.h"
+#include "LogLifecycleManager.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QLocale>
+#include <QPushButton>
+#include <QSplitter>
+#include <QVBoxLayout>
+
+const int FILE_LIST_WIDTH = 220;
+
+static QString formatBytes(qint64 bytes) {
+    const qint64 BYTES_PER_KB = 1024;
+    const qint64 BYTES_PER_MB = BYTES_PER_KB * 1024;
+    const qint64 BYTES_PER_GB = BYTES_PER_MB * 1024;
+
+    if (bytes >= BYTES_PER_GB) {
+        return QString::number(double(bytes) / BYTES_PER_GB, 'f', 1) + " GB";
+    } else if (bytes >= BYTES_PER_MB) {
+        return QString::number(double(bytes) / BYTES_PER_MB, 'f', 1) + " MB";
+    } else {
+        return QString::number((bytes + BYTES_PER_KB - 1) / BYTES_PER_KB) + " KB";
+    }
+}
+
+LogBrowser::LogBrowser(QWidget* parent) :
+    QWidget(parent),
+    _logFile(NULL)
+{
+    QVBoxLayout* layout = new QVBoxLayout;
+
+    QHBoxLayout* buttonLayout = new QHBoxLayout;
+    QPushButton* refreshButton = new QPushButton("Refresh");
+    QPushButton* openButton = new QPushButton("Open file...");
+    buttonLayout->addWidget(refreshButton);
+    buttonLayout->addWidget(openButton);
+    buttonLayout->addStretch();
+    layout->addLayout(buttonLayout);
+
+    QSplitter* splitter = new QSplitter;
+
+    _fileList = new QListWidget;
+    _fileList->setMinimumWidth(FILE_LIST_WIDTH);
+    splitter->addWidget(_fileList);
+
+    _viewer = new HistoricalLogViewer;
+    splitter->addWidget(_viewer);
+    splitter->setStretchFactor(1, 1);
+
+    layout->addWidget(splitter, 1);
+
+    _statusLabel = new QLabel;
+    layout->addWidget(_statusLabel);
+
+    setLayout(layout);
+
+    connect(refreshButton, &QPushButton::clicked, this, &LogBrowser::refreshFileList);
+    connect(openButton, &QPushButton::clicked, this, &LogBrowser::openOtherFile);
+    connect(_fileList, &QListWidget::itemActivated, this, &LogBrowser::openSelectedFile);
+}
+
+void LogBrowser::showEvent(QShowEvent* event) {
+    QWidget::showEvent(event);
+    refreshFileList();
+}
+
+void LogBrowser::refreshFileList() {
+    QDir logsDir(GlobalData::getInstance().getProcessLogsPath());
+    QList<QFileInfoList> logs = LogLifecycleManager::findChildLogs(logsDir.absolutePath());
+
+    _fileList->clear();
+
+    // newest first, with the stack subdirectory in front of files that are in one and each log's
+    // rotated segments indented under it
+    for (int i = logs.size() - 1; i >= 0; --i) {
+        const QFileInfoList& logFiles = logs[i];
+
+        for (int j = logFiles.size() - 1; j >= 0; --j) {
+            const QFileInfo& logFile = logFiles[j];
+            QString indent = j == logFiles.size() - 1 ? "" : "    ";
+
+            QListWidgetItem* item = new QListWidgetItem(indent + logsDir.relativeFilePath(logFile.absoluteFilePath())
+                                                        + " (" + formatBytes(logFile.size()) + ")");
+            item->setData(Qt::UserRole, logFile.absoluteFilePath());
+            item->setToolTip(logFile.lastModified().toString());
+            _fileList->addItem(item);
+        }
+    }
+}
+
+void LogBrowser::openSelectedFile() {
+    QListWidgetItem* item = _fileList->currentItem();
+    if (item) {
+        openFile(item->data(Qt::UserRole).toString());
+    }
+}
+
+void LogBrowser::openOtherFile() {
+    QString path = QFileDialog::getOpenFileName(this, "Open log file", GlobalData::getInstance().getProcessLogsPath());
+    if (!path.isEmpty()) {
+        openFile(path);
+    }
+}
+
+void LogBrowser::openFile(const QString& path) {
+    _viewer->setLogFile(NULL);
+    delete _logFile;
+
+    _logFile = new MappedLogFile(path, this);
+    if (!_logFile->open()) {
+        _statusLabel->setText("Could not open " + path);
+        delete _logFile;
+        _logFile = NULL;
+        return;
+    }
+
+    connect(_logFile, &MappedLogFile::indexProgress, this, &LogBrowser::updateStatus);
+    _viewer->setLogFile(_logFile);
+    updateStatus(0, 0, false);
+}
+
+void LogBrowser::updateStatus(int lineCount, qint64 indexedBytes, bool isFinished) {
+    QString status = QFileInfo(_logFile->getPath()).fileName() + " - "
+        + QLocale().toString(lineCount) + " lines";
+
+    if (!isFinished) {
+        status += QString(", indexing %1 of %2").arg(formatBytes(indexedBytes), formatBytes(_logFile->getSize()));
+    }
+
+    _statusLabel->setText(status);
+}
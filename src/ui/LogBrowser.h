@@ -0,0 +1,44 @@
+//
+//  LogBrowser.h
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_LogBrowser_h
+#define hifi_LogBrowser_h
+
+#include <QLabel>
+#include <QListWidget>
+#include <QWidget>
+
+#include "HistoricalLogViewer.h"
+#include "MappedLogFile.h"
+
+// Lists the stdout/stderr files of past runs and opens them in a HistoricalLogViewer.
+class LogBrowser : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit LogBrowser(QWidget* parent = 0);
+
+public slots:
+    void refreshFileList();
+    void openFile(const QString& path);
+
+protected:
+    virtual void showEvent(QShowEvent*);
+
+private slots:
+    void openSelectedFile();
+    void openOtherFile();
+    void updateStatus(int lineCount, qint64 indexedBytes, bool isFinished);
+
+private:
+    QListWidget* _fileList;
+    HistoricalLogViewer* _viewer;
+    QLabel* _statusLabel;
+    MappedLogFile* _logFile;
+};
+
+#endif
@@ -0,0 +1,128 @@
+//
+//  LogSearchWidget.cpp
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "LogSearchWidget.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QVBoxLayout>
+
+const int MAX_SEARCH_MATCHES = 1000;
+
+const QString RESULT_TIME_FORMAT = "yyyy-MM-dd hh:mm:ss";
+
+LogSearchWidget::LogSearchWidget(QWidget* parent) :
+    QWidget(parent)
+{
+    QVBoxLayout* layout = new QVBoxLayout;
+
+    QHBoxLayout* queryLayout = new QHBoxLayout;
+
+    _queryLineEdit = new QLineEdit;
+    _queryLineEdit->setPlaceholderText("Text to find");
+    queryLayout->addWidget(_queryLineEdit, 1);
+
+    _regexCheckBox = new QCheckBox("Regex");
+    queryLayout->addWidget(_regexCheckBox);
+
+    _levelComboBox = new QComboBox;
+    _levelComboBox->addItem("All levels", ALL_LOG_LEVELS);
+    _levelComboBox->addItem("Warnings and errors", logLevelBit(LogLevelWarning) | logLevelBit(LogLevelCritical)
+                            | logLevelBit(LogLevelFatal));
+    _levelComboBox->addItem("Errors only", logLevelBit(LogLevelCritical) | logLevelBit(LogLevelFatal));
+    queryLayout->addWidget(_levelComboBox);
+
+    _searchButton = new QPushButton("Search");
+    queryLayout->addWidget(_searchButton);
+
+    layout->addLayout(queryLayout);
+
+    QHBoxLayout* timeLayout = new QHBoxLayout;
+
+    _timeRangeCheckBox = new QCheckBox("Between");
+    timeLayout->addWidget(_timeRangeCheckBox);
+
+    _fromDateTimeEdit = new QDateTimeEdit(QDateTime::currentDateTime().addSecs(-3600));
+    _fromDateTimeEdit->setCalendarPopup(true);
+    _fromDateTimeEdit->setEnabled(false);
+    timeLayout->addWidget(_fromDateTimeEdit);
+
+    timeLayout->addWidget(new QLabel("and"));
+
+    _toDateTimeEdit = new QDateTimeEdit(QDateTime::currentDateTime());
+    _toDateTimeEdit->setCalendarPopup(true);
+    _toDateTimeEdit->setEnabled(false);
+    timeLayout->addWidget(_toDateTimeEdit);
+
+    timeLayout->addStretch();
+    layout->addLayout(timeLayout);
+
+    _resultsTree = new QTreeWidget;
+    _resultsTree->setRootIsDecorated(false);
+    _resultsTree->setUniformRowHeights(true);
+    _resultsTree->setHeaderLabels(QStringList() << "Time" << "Level" << "File" << "Line" << "Text");
+    _resultsTree->header()->setStretchLastSection(true);
+    layout->addWidget(_resultsTree);
+
+    _statusLabel = new QLabel;
+    layout->addWidget(_statusLabel);
+
+    setLayout(layout);
+
+    connect(_searchButton, &QPushButton::clicked, this, &LogSearchWidget::startSearch);
+    connect(_queryLineEdit, &QLineEdit::returnPressed, this, &LogSearchWidget::startSearch);
+    connect(_timeRangeCheckBox, &QCheckBox::toggled, _fromDateTimeEdit, &QWidget::setEnabled);
+    connect(_timeRangeCheckBox, &QCheckBox::toggled, _toDateTimeEdit, &QWidget::setEnabled);
+}
+
+void LogSearchWidget::startSearch() {
+    LogQuery query;
+    query.text = _queryLineEdit->text();
+    query.isRegex = _regexCheckBox->isChecked();
+    query.levelMask = _levelComboBox->currentData().toUInt();
+
+    if (_timeRangeCheckBox->isChecked()) {
+        query.fromTimestamp = _fromDateTimeEdit->dateTime().toMSecsSinceEpoch();
+        query.toTimestamp = _toDateTimeEdit->dateTime().toMSecsSinceEpoch();
+    }
+
+    _searchButton->setEnabled(false);
+    _statusLabel->setText("Searching...");
+
+    emit searchRequested(query, MAX_SEARCH_MATCHES);
+}
+
+void LogSearchWidget::showResults(const QList<LogSearchMatch>& matches, bool wasTruncated) {
+    _resultsTree->clear();
+
+    QList<QTreeWidgetItem*> items;
+    foreach(const LogSearchMatch& match, matches) {
+        QTreeWidgetItem* item = new QTreeWidgetItem;
+        if (match.timestamp > 0) {
+            item->setText(0, QDateTime::fromMSecsSinceEpoch(match.timestamp).toString(RESULT_TIME_FORMAT));
+        }
+        item->setText(1, LogLineParser::nameForLevel(match.level));
+        item->setText(2, QFileInfo(match.path).fileName());
+        item->setText(3, QString::number(match.lineNumber));
+        item->setText(4, match.text);
+        item->setToolTip(2, match.path);
+        items << item;
+    }
+    _resultsTree->addTopLevelItems(items);
+
+    _statusLabel->setText(QString("%1 matches%2").arg(matches.size())
+                          .arg(wasTruncated ? " (showing the first " + QString::number(matches.size()) + ")" : ""));
+    _searchButton->setEnabled(true);
+}
+
+void LogSearchWidget::showIndexStatus(int fileCount, int lineCount) {
+    if (_searchButton->isEnabled()) {
+        _statusLabel->setText(QString("%1 lines indexed across %2 log files").arg(lineCount).arg(fileCount));
+    }
+}
@@ -0,0 +1,50 @@
+//
+//  LogSearchWidget.h
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_LogSearchWidget_h
+#define hifi_LogSearchWidget_h
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDateTimeEdit>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QWidget>
+
+#include "LogIndex.h"
+
+class LogSearchWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit LogSearchWidget(QWidget* parent = 0);
+
+signals:
+    void searchRequested(const LogQuery& query, int maxMatches);
+
+public slots:
+    void showResults(const QList<LogSearchMatch>& matches, bool wasTruncated);
+    void showIndexStatus(int fileCount, int lineCount);
+
+private slots:
+    void startSearch();
+
+private:
+    QLineEdit* _queryLineEdit;
+    QCheckBox* _regexCheckBox;
+    QComboBox* _levelComboBox;
+    QCheckBox* _timeRangeCheckBox;
+    QDateTimeEdit* _fromDateTimeEdit;
+    QDateTimeEdit* _toDateTimeEdit;
+    QPushButton* _searchButton;
+    QTreeWidget* _resultsTree;
+    QLabel* _statusLabel;
+};
+
+#endif
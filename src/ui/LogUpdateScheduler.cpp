@@ -0,0 +1,149 @@
+//
+//  LogUpdateScheduler.cpp
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "LogUpdateScheduler.h"
+#include "Tracer.h"
+
+#include <QDebug>
+#include <QEvent>
+
+const int FRAME_INTERVAL_MS = 16;
+const int STATS_REPORT_INTERVAL_MS = 60 * 1000;
+
+// past this a hidden viewer is cheaper to rebuild from its store than to catch up
+const int MAX_HIDDEN_PENDING_CHARS = 1024 * 1024;
+
+LogUpdateScheduler::LogUpdateScheduler(QObject* parent) :
+    QObject(parent),
+    _lastFrameMSecs(0),
+    _reportedFlushes(0)
+{
+    _clock.start();
+
+    _frameTimer.setSingleShot(true);
+    _frameTimer.setInterval(FRAME_INTERVAL_MS);
+    connect(&_frameTimer, &QTimer::timeout, this, &LogUpdateScheduler::flushFrame);
+
+    _statsTimer.setInterval(STATS_REPORT_INTERVAL_MS);
+    connect(&_statsTimer, &QTimer::timeout, this, &LogUpdateScheduler::reportStats);
+    _statsTimer.start();
+}
+
+void LogUpdateScheduler::queue(LogViewer* viewer, LogStream stream, const QString& text) {
+    if (!_pending.contains(viewer)) {
+        // catch up as soon as the viewer is shown, and forget it when it goes away
+        viewer->installEventFilter(this);
+        connect(viewer, &QObject::destroyed, this, &LogUpdateScheduler::forgetViewer);
+    }
+
+    PendingOutput& pending = _pending[viewer];
+    if (pending.needsReload) {
+        // the store already holds this output and the viewer will be rebuilt from it
+        return;
+    }
+
+    if (pending.queuedAtMSecs < 0) {
+        pending.queuedAtMSecs = _clock.elapsed();
+    }
+
+    QString& buffer = stream == LogStreamStandardOutput ? pending.standardOutput : pending.standardError;
+    buffer += text;
+
+    if (pending.standardOutput.size() + pending.standardError.size() > MAX_HIDDEN_PENDING_CHARS) {
+        pending.standardOutput.clear();
+        pending.standardError.clear();
+        pending.needsReload = true;
+    }
+
+    if (viewer->isVisible() && !_frameTimer.isActive()) {
+        _lastFrameMSecs = _clock.elapsed();
+        _frameTimer.start();
+    }
+}
+
+void LogUpdateScheduler::discard(LogViewer* viewer) {
+    if (_pending.contains(viewer)) {
+        _pending[viewer] = PendingOutput();
+    }
+}
+
+void LogUpdateScheduler::forgetViewer(QObject* viewer) {
+    _pending.remove(static_cast<LogViewer*>(viewer));
+}
+
+bool LogUpdateScheduler::eventFilter(QObject* object, QEvent* event) {
+    if (event->type() == QEvent::Show) {
+        LogViewer* viewer = static_cast<LogViewer*>(object);
+        QHash<LogViewer*, PendingOutput>::iterator it = _pending.find(viewer);
+
+        if (it != _pending.end() && it.value().queuedAtMSecs >= 0) {
+            flushViewer(viewer, it.value());
+        }
+    }
+
+    return QObject::eventFilter(object, event);
+}
+
+void LogUpdateScheduler::flushFrame() {
+    TraceSpan span("log", "flushFrame");
+
+    qint64 now = _clock.elapsed();
+
+    // a frame that fires late stands in for every frame it missed
+    ++_stats.frames;
+    qint64 lateness = now - _lastFrameMSecs - FRAME_INTERVAL_MS;
+    if (lateness >= FRAME_INTERVAL_MS) {
+        _stats.droppedFrames += lateness / FRAME_INTERVAL_MS;
+    }
+
+    int flushedCount = 0;
+    QHash<LogViewer*, PendingOutput>::iterator it = _pending.begin();
+    for (; it != _pending.end(); ++it) {
+        if (it.value().queuedAtMSecs >= 0 && it.key()->isVisible()) {
+            flushViewer(it.key(), it.value());
+            ++flushedCount;
+        }
+    }
+
+    // a frame whose viewers were all hidden by the time it fired is not worth a slot in the ring
+    if (flushedCount == 0) {
+        span.cancel();
+    }
+}
+
+void LogUpdateScheduler::flushViewer(LogViewer* viewer, PendingOutput& pending) {
+    qint64 latency = _clock.elapsed() - pending.queuedAtMSecs;
+
+    if (pending.needsReload) {
+        viewer->reload();
+    } else {
+        if (!pending.standardOutput.isEmpty()) {
+            viewer->appendStandardOutput(pending.standardOutput);
+        }
+        if (!pending.standardError.isEmpty()) {
+            viewer->appendStandardError(pending.standardError);
+        }
+    }
+
+    ++_stats.flushes;
+    _stats.flushedChars += pending.standardOutput.size() + pending.standardError.size();
+    _stats.totalLatencyMSecs += latency;
+    _stats.maxLatencyMSecs = qMax(_stats.maxLatencyMSecs, latency);
+
+    pending = PendingOutput();
+}
+
+void LogUpdateScheduler::reportStats() {
+    if (_stats.flushes == _reportedFlushes) {
+        return;
+    }
+    _reportedFlushes = _stats.flushes;
+
+    qDebug() << "Log view updates:" << _stats.flushes << "flushes over" << _stats.frames << "frames,"
+        << _stats.droppedFrames << "dropped frames, average latency"
+        << _stats.totalLatencyMSecs / _stats.flushes << "ms, max" << _stats.maxLatencyMSecs << "ms";
+}
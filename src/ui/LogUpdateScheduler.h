@@ -0,0 +1,76 @@
+//
+//  LogUpdateScheduler.h
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_LogUpdateScheduler_h
+#define hifi_LogUpdateScheduler_h
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+
+#include "LogStore.h"
+#include "LogViewer.h"
+
+struct LogUpdateStats {
+    LogUpdateStats() : frames(0), droppedFrames(0), flushes(0), flushedChars(0), totalLatencyMSecs(0), maxLatencyMSecs(0) {}
+
+    quint64 frames;
+    quint64 droppedFrames;
+    quint64 flushes;
+    quint64 flushedChars;
+    quint64 totalLatencyMSecs;
+    qint64 maxLatencyMSecs;
+};
+
+// Coalesces child output into at most one append per viewer per frame.
+//
+// Output is buffered per LogViewer and a frame timer runs only while a visible one has some.
+// Each frame flushes only viewers that are actually on screen; hidden tabs and a closed logs
+// window keep buffering and catch up in one batch when shown. A hidden viewer that buffers too
+// much drops its buffer and is rebuilt from its LogStore instead.
+class LogUpdateScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogUpdateScheduler(QObject* parent = 0);
+
+    void queue(LogViewer* viewer, LogStream stream, const QString& text);
+    void discard(LogViewer* viewer);
+
+    const LogUpdateStats& getStats() const { return _stats; }
+
+protected:
+    bool eventFilter(QObject* object, QEvent* event);
+
+private slots:
+    void flushFrame();
+    void reportStats();
+    void forgetViewer(QObject* viewer);
+
+private:
+    struct PendingOutput {
+        PendingOutput() : queuedAtMSecs(-1), needsReload(false) {}
+
+        QString standardOutput;
+        QString standardError;
+        qint64 queuedAtMSecs;
+        bool needsReload;
+    };
+
+    void flushViewer(LogViewer* viewer, PendingOutput& pending);
+
+    QHash<LogViewer*, PendingOutput> _pending;
+    QTimer _frameTimer;
+    QTimer _statsTimer;
+    QElapsedTimer _clock;
+    qint64 _lastFrameMSecs;
+    LogUpdateStats _stats;
+    quint64 _reportedFlushes;
+};
+
+#endif
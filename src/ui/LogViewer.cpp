@@ -10,13 +10,34 @@
 #include "GlobalData.h"
 
 #include <QTextCursor>
+#include <QHBoxLayout>
 #include <QLabel>
 #include <QVBoxLayout>
 
+const int ALL_CATEGORIES = -1;
+
 LogViewer::LogViewer(QWidget* parent) :
-    QWidget(parent)
+    QWidget(parent),
+    _logStore(NULL),
+    _nextLine(0)
 {
     QVBoxLayout* layout = new QVBoxLayout;
+
+    QHBoxLayout* filterLayout = new QHBoxLayout;
+
+    _levelFilter = new QComboBox;
+    _levelFilter->addItem("All levels", ALL_LOG_LEVELS);
+    _levelFilter->addItem("Warnings and errors",
+                          logLevelBit(LogLevelWarning) | logLevelBit(LogLevelCritical) | logLevelBit(LogLevelFatal));
+    _levelFilter->addItem("Errors only", logLevelBit(LogLevelCritical) | logLevelBit(LogLevelFatal));
+    filterLayout->addWidget(_levelFilter);
+
+    _categoryFilter = new QComboBox;
+    _categoryFilter->addItem("All categories", ALL_CATEGORIES);
+    filterLayout->addWidget(_categoryFilter);
+    filterLayout->addStretch();
+
+    layout->addLayout(filterLayout);
     QLabel* outputLabel = new QLabel;
     outputLabel->setText("Standard Output:");
     outputLabel->setStyleSheet("font-size: 13pt;");
@@ -41,14 +62,110 @@ LogViewer::LogViewer(QWidget* parent) :
 
     layout->addWidget(_errorView);
     setLayout(layout);
+
+    connect(_levelFilter, SIGNAL(currentIndexChanged(int)), SLOT(applyFilter()));
+    connect(_categoryFilter, SIGNAL(currentIndexChanged(int)), SLOT(applyFilter()));
 }
 
 void LogViewer::clear() {
     _outputView->clear();
     _errorView->clear();
+    _nextLine = 0;
+
+    _categoryFilter->blockSignals(true);
+    while (_categoryFilter->count() > 1) {
+        _categoryFilter->removeItem(1);
+    }
+    _categoryFilter->blockSignals(false);
+
+    // category ids are per run, the level filter carries over
+    _filter.categories.clear();
+}
+
+bool LogViewer::isFiltering() const {
+    return _logStore && (_filter.levelMask != ALL_LOG_LEVELS || !_filter.categories.isEmpty());
+}
+
+void LogViewer::updateCategories() {
+    for (int category = _categoryFilter->count(); category < _logStore->getCategoryCount(); ++category) {
+        _categoryFilter->addItem(_logStore->getCategoryName(category), category);
+    }
+}
+
+void LogViewer::applyFilter() {
+    if (!_logStore) {
+        return;
+    }
+
+    _filter.levelMask = _levelFilter->currentData().toUInt();
+
+    int category = _categoryFilter->currentData().toInt();
+    if (category == ALL_CATEGORIES) {
+        _filter.categories.clear();
+    } else {
+        _filter.categories.fill(false, _logStore->getCategoryCount());
+        _filter.categories.setBit(category);
+    }
+
+    reload();
+}
+
+void LogViewer::reload() {
+    if (!_logStore) {
+        return;
+    }
+
+    // the views are rebuilt from the store, it holds everything still on screen
+    _outputView->clear();
+    _errorView->clear();
+    _nextLine = _logStore->getFirstLine();
+
+    appendStoreLines();
+}
+
+void LogViewer::appendStoreLines() {
+    QVector<int> lines;
+    if (isFiltering()) {
+        _logStore->filter(_filter, lines, _nextLine);
+    } else {
+        for (int line = qMax(_nextLine, _logStore->getFirstLine()); line < _logStore->getEndLine(); ++line) {
+            lines << line;
+        }
+    }
+    _nextLine = _logStore->getEndLine();
+
+    QString outputText;
+    QString errorText;
+
+    // live, reloaded and filtered lines all go through getLineText so they read the same
+    foreach(int line, lines) {
+        QString& text = _logStore->getStream(line) == LogStreamStandardOutput ? outputText : errorText;
+        text += _logStore->getLineText(line) + "\n";
+    }
+
+    if (!outputText.isEmpty()) {
+        QTextCursor cursor = _outputView->textCursor();
+        cursor.movePosition(QTextCursor::End);
+        cursor.insertText(outputText);
+        _outputView->ensureCursorVisible();
+    }
+
+    if (!errorText.isEmpty()) {
+        QTextCursor cursor = _errorView->textCursor();
+        cursor.movePosition(QTextCursor::End);
+        cursor.insertText(errorText);
+        _errorView->ensureCursorVisible();
+    }
 }
 
 void LogViewer::appendStandardOutput(const QString& output) {
+    // the process appends to the store before handing the output on, so it already has these lines
+    if (_logStore) {
+        updateCategories();
+        appendStoreLines();
+        return;
+    }
+
     QTextCursor cursor = _outputView->textCursor();
     cursor.movePosition(QTextCursor::End);
     cursor.insertText(output);
@@ -56,6 +173,12 @@ void LogViewer::appendStandardOutput(const QString& output) {
 }
 
 void LogViewer::appendStandardError(const QString& error) {
+    if (_logStore) {
+        updateCategories();
+        appendStoreLines();
+        return;
+    }
+
     QTextCursor cursor = _errorView->textCursor();
     cursor.movePosition(QTextCursor::End);
     cursor.insertText(error);
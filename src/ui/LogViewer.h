@@ -9,21 +9,40 @@
 #ifndef hifi_LogViewer_h
 #define hifi_LogViewer_h
 
+#include <QComboBox>
 #include <QWidget>
 #include <QTextEdit>
 
+#include "LogStore.h"
+
 class LogViewer : public QWidget
 {
     Q_OBJECT
 public:
     explicit LogViewer(QWidget* parent = 0);
-    
+
+    void setLogStore(const LogStore* logStore) { _logStore = logStore; }
+
     void clear();
+    void reload();
 
     void appendStandardOutput(const QString& output);
     void appendStandardError(const QString& error);
 
+private slots:
+    void applyFilter();
+
 private:
+    bool isFiltering() const;
+    void updateCategories();
+    void appendStoreLines();
+
+    const LogStore* _logStore;
+    LogStoreFilter _filter;
+    int _nextLine;
+
+    QComboBox* _levelFilter;
+    QComboBox* _categoryFilter;
     QTextEdit* _outputView;
     QTextEdit* _errorView;
 };
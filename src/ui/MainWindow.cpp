@@ -18,11 +18,17 @@
 #include <QMutex>
 #include <QLayoutItem>
 #include <QCursor>
+#include <QHeaderView>
 #include <QtWebKitWidgets/qwebview.h>
 
 #include "AppDelegate.h"
-#include "AssignmentWidget.h"
+#include "AssignmentDelegate.h"
+#include "BackgroundProcess.h"
 #include "GlobalData.h"
+#include "LogBrowser.h"
+#include "LogIndexService.h"
+#include "LogSearchWidget.h"
+#include "TimelineWidget.h"
 #include "StackManagerVersion.h"
 
 const int GLOBAL_X_PADDING = 55;
@@ -32,8 +38,10 @@ const int HORIZONTAL_RULE_TOP_MARGIN = 25;
 
 const int BUTTON_PADDING_FIX = -5;
 
-const int ASSIGNMENT_LAYOUT_RESIZE_FACTOR = 56;
-const int ASSIGNMENT_LAYOUT_WIDGET_STRETCH = 0;
+const int ASSIGNMENT_ROW_HEIGHT = 32;
+const int MAX_VISIBLE_ASSIGNMENT_ROWS = 10;
+
+const int DOMAIN_STATS_TOP_MARGIN = 15;
 
 const QColor lightGrayColor = QColor(205, 205, 205);
 const QColor darkGrayColor = QColor(84, 84, 84);
@@ -45,15 +53,24 @@ const QString SHARE_BUTTON_COPY_LINK_TEXT = "Copy link";
 MainWindow::MainWindow() :
     QWidget(),
     _domainServerRunning(false),
+    _stagedUpdateAvailable(false),
     _startServerButton(NULL),
     _stopServerButton(NULL),
     _serverAddressLabel(NULL),
+    _stackStatusLabel(NULL),
     _viewLogsButton(NULL),
     _settingsButton(NULL),
+    _runAssignmentButton(NULL),
+    _startSelectedButton(NULL),
+    _stopSelectedButton(NULL),
+    _removeSelectedButton(NULL),
     _copyLinkButton(NULL),
     _contentSetButton(NULL),
+    _applyUpdateButton(NULL),
     _logsWidget(NULL),
-    _localHttpPortSharedMem(NULL)
+    _assignmentModel(NULL),
+    _assignmentView(NULL),
+    _domainStatsWidget(NULL)
 {
     // Set build version
     QCoreApplication::setApplicationVersion(BUILD_VERSION);
@@ -107,6 +124,11 @@ MainWindow::MainWindow() :
                               TOP_Y_PADDING + SERVER_ADDRESS_LABEL_TOP_MARGIN);
     _serverAddressLabel->setOpenExternalLinks(true);
 
+    // only shown when this host runs more than one stack
+    const int STACK_STATUS_LABEL_TOP_MARGIN = 20;
+    _stackStatusLabel = new QLabel(this);
+    _stackStatusLabel->move(_serverAddressLabel->x(), _serverAddressLabel->y() + STACK_STATUS_LABEL_TOP_MARGIN);
+
     const int SECONDARY_BUTTON_ROW_TOP_MARGIN = 10;
 
     int secondaryButtonY = _stopServerButton->geometry().bottom() + SECONDARY_BUTTON_ROW_TOP_MARGIN;
@@ -132,13 +154,33 @@ MainWindow::MainWindow() :
     _contentSetButton->setGeometry(_copyLinkButton->geometry().right(), secondaryButtonY,
                                    _contentSetButton->width(), _contentSetButton->height());
 
+    _applyUpdateButton = new QPushButton("Apply update", this);
+    _applyUpdateButton->adjustSize();
+    _applyUpdateButton->setGeometry(_contentSetButton->geometry().right(), secondaryButtonY,
+                                    _applyUpdateButton->width(), _applyUpdateButton->height());
+
     const int ASSIGNMENT_BUTTON_TOP_MARGIN = 10;
 
     _runAssignmentButton = new QPushButton("Run assignment", this);
+    _runAssignmentButton->adjustSize();
     _runAssignmentButton->move(GLOBAL_X_PADDING + BUTTON_PADDING_FIX,
                                _viewLogsButton->geometry().bottom() + REQUIREMENTS_TEXT_TOP_MARGIN
                                + HORIZONTAL_RULE_TOP_MARGIN + ASSIGNMENT_BUTTON_TOP_MARGIN);
 
+    int assignmentButtonY = _runAssignmentButton->geometry().top();
+
+    _startSelectedButton = new QPushButton("Start selected", this);
+    _startSelectedButton->adjustSize();
+    _startSelectedButton->move(_runAssignmentButton->geometry().right(), assignmentButtonY);
+
+    _stopSelectedButton = new QPushButton("Stop selected", this);
+    _stopSelectedButton->adjustSize();
+    _stopSelectedButton->move(_startSelectedButton->geometry().right(), assignmentButtonY);
+
+    _removeSelectedButton = new QPushButton("Remove selected", this);
+    _removeSelectedButton->adjustSize();
+    _removeSelectedButton->move(_stopSelectedButton->geometry().right(), assignmentButtonY);
+
     const QSize logsWidgetSize = QSize(500, 500);
     _logsWidget = new QTabWidget;
     _logsWidget->setUsesScrollButtons(true);
@@ -147,24 +189,56 @@ MainWindow::MainWindow() :
                                 Qt::WindowMinMaxButtonsHint | Qt::WindowCloseButtonHint);
     _logsWidget->resize(logsWidgetSize);
 
-    const int ASSIGNMENT_SCROLL_AREA_TOP_MARGIN = 10;
-
-    _assignmentScrollArea = new QScrollArea(this);
-    _assignmentScrollArea->setWidget(new QWidget);
-    _assignmentScrollArea->setWidgetResizable(true);
-    _assignmentScrollArea->setFrameShape(QFrame::NoFrame);
-    _assignmentScrollArea->move(GLOBAL_X_PADDING, _runAssignmentButton->geometry().bottom() + ASSIGNMENT_SCROLL_AREA_TOP_MARGIN);
-    _assignmentScrollArea->setMaximumWidth(width() - GLOBAL_X_PADDING * 2);
-    _assignmentScrollArea->setMaximumHeight(qApp->desktop()->availableGeometry().height() -
-                                            _assignmentScrollArea->geometry().top());
-
-    const int assignmentLayoutSpacingMargin = 0;
-    _assignmentLayout = new QVBoxLayout;
-    _assignmentLayout->setSpacing(assignmentLayoutSpacingMargin);
-	_assignmentLayout->setMargin(assignmentLayoutSpacingMargin);
-    _assignmentLayout->setContentsMargins(assignmentLayoutSpacingMargin, assignmentLayoutSpacingMargin,
-                                          assignmentLayoutSpacingMargin, assignmentLayoutSpacingMargin);
-    _assignmentScrollArea->widget()->setLayout(_assignmentLayout);
+    LogSearchWidget* logSearchWidget = new LogSearchWidget;
+    _logsWidget->addTab(logSearchWidget, "Search");
+    _logsWidget->addTab(new LogBrowser, "History");
+    _logsWidget->addTab(new TimelineWidget(AppDelegate::getInstance()->getLogTimeline()), "Timeline");
+    connect(_logsWidget, &QTabWidget::currentChanged, this, &MainWindow::openProcessLogTab);
+
+    const int ASSIGNMENT_VIEW_TOP_MARGIN = 10;
+
+    // one row per scripted assignment, painted by the delegate rather than built from widgets
+    _assignmentModel = new AssignmentModel(this);
+
+    _assignmentView = new QTableView(this);
+    _assignmentView->setModel(_assignmentModel);
+    _assignmentView->setItemDelegate(new AssignmentDelegate(_assignmentView));
+    _assignmentView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    _assignmentView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    _assignmentView->setEditTriggers(QAbstractItemView::DoubleClicked | QAbstractItemView::EditKeyPressed);
+    _assignmentView->setShowGrid(false);
+    _assignmentView->setFrameShape(QFrame::NoFrame);
+    _assignmentView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    _assignmentView->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+
+    // fixed row heights and column widths so nothing has to measure every row
+    _assignmentView->verticalHeader()->hide();
+    _assignmentView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    _assignmentView->verticalHeader()->setDefaultSectionSize(ASSIGNMENT_ROW_HEIGHT);
+
+    QHeaderView* assignmentHeader = _assignmentView->horizontalHeader();
+    assignmentHeader->setSectionResizeMode(QHeaderView::Fixed);
+    assignmentHeader->setSectionResizeMode(AssignmentModel::PoolColumn, QHeaderView::Stretch);
+    assignmentHeader->resizeSection(AssignmentModel::ScriptIDColumn, 80);
+    assignmentHeader->resizeSection(AssignmentModel::ProcessIDColumn, 60);
+    assignmentHeader->resizeSection(AssignmentModel::StateColumn, 120);
+    assignmentHeader->resizeSection(AssignmentModel::CPUColumn, 60);
+    assignmentHeader->resizeSection(AssignmentModel::MemoryColumn, 80);
+
+    _assignmentView->setGeometry(GLOBAL_X_PADDING, _runAssignmentButton->geometry().bottom() + ASSIGNMENT_VIEW_TOP_MARGIN,
+                                 width() - GLOBAL_X_PADDING * 2, 0);
+
+    AppDelegate* app = AppDelegate::getInstance();
+
+    // live numbers from the domain-server, below everything else
+    _domainStatsWidget = new DomainStatsWidget(app->getDomainStatsPoller(), this);
+    _domainStatsWidget->resize(width() - GLOBAL_X_PADDING * 2, _domainStatsWidget->sizeHint().height());
+
+    connect(_assignmentModel, &QAbstractItemModel::rowsInserted, this, &MainWindow::updateAssignmentViewHeight);
+    connect(_assignmentModel, &QAbstractItemModel::rowsRemoved, this, &MainWindow::updateAssignmentViewHeight);
+    connect(_assignmentView->selectionModel(), &QItemSelectionModel::selectionChanged,
+            this, &MainWindow::updateAssignmentButtons);
+    updateAssignmentButtons();
 
     connect(_startServerButton, &QPushButton::clicked, this, &MainWindow::toggleDomainServerButton);
     connect(_stopServerButton, &QPushButton::clicked, this, &MainWindow::toggleDomainServerButton);
@@ -173,12 +247,21 @@ MainWindow::MainWindow() :
     connect(_viewLogsButton, &QPushButton::clicked, _logsWidget, &QTabWidget::show);
     connect(_settingsButton, &QPushButton::clicked, this, &MainWindow::openSettings);\
     connect(_runAssignmentButton, &QPushButton::clicked, this, &MainWindow::addAssignment);
+    connect(_startSelectedButton, &QPushButton::clicked, this, &MainWindow::startSelectedAssignments);
+    connect(_stopSelectedButton, &QPushButton::clicked, this, &MainWindow::stopSelectedAssignments);
+    connect(_removeSelectedButton, &QPushButton::clicked, this, &MainWindow::removeSelectedAssignments);
 
-    AppDelegate* app = AppDelegate::getInstance();
+    connect(_applyUpdateButton, &QPushButton::clicked, app, &AppDelegate::applyStagedUpdate);
+
+    // searches run on the log index thread and come back as queued signals
+    LogIndexService* logIndexService = app->getLogIndexService();
+    connect(logSearchWidget, &LogSearchWidget::searchRequested, logIndexService, &LogIndexService::search);
+    connect(logIndexService, &LogIndexService::searchFinished, logSearchWidget, &LogSearchWidget::showResults);
+    connect(logIndexService, &LogIndexService::indexUpdated, logSearchWidget, &LogSearchWidget::showIndexStatus);
     // update the current server address label and change it if the AppDelegate says the address has changed
     updateServerAddressLabel();
     connect(app, &AppDelegate::domainAddressChanged, this, &MainWindow::updateServerAddressLabel);
-    connect(app, &AppDelegate::domainAddressChanged, this, &MainWindow::updateServerBaseUrl);
+    connect(app, &AppDelegate::stacksChanged, this, &MainWindow::updateStackStatusLabel);
 
     // handle response for content set download
     connect(app, &AppDelegate::contentSetDownloadResponse, this, &MainWindow::handleContentSetDownloadResponse);
@@ -204,12 +287,14 @@ void MainWindow::updateServerAddressLabel() {
     _serverAddressLabel->adjustSize();
 }
 
-void MainWindow::updateServerBaseUrl() {
-    quint16 localPort;
+void MainWindow::updateStackStatusLabel() {
+    AppDelegate* app = AppDelegate::getInstance();
 
-    if (getLocalServerPortFromSharedMemory("domain-server.local-http-port", _localHttpPortSharedMem, localPort)) {
-        GlobalData::getInstance().setDomainServerBaseUrl(QString("http://localhost:") + QString::number(localPort));
-    }
+    _stackStatusLabel->setText(QString("%1 of %2 stacks running").arg(app->getRunningStackCount())
+                               .arg(app->getStackCount()));
+    _stackStatusLabel->setToolTip(app->describeStacks());
+    _stackStatusLabel->adjustSize();
+    _stackStatusLabel->setVisible(_domainServerRunning && app->getStackCount() > 1);
 }
 
 
@@ -266,18 +351,104 @@ void MainWindow::setUpdateNotification(const QString& updateNotification) {
     _updateNotification = updateNotification;
 }
 
+void MainWindow::setStagedUpdateAvailable(bool isAvailable) {
+    _stagedUpdateAvailable = isAvailable;
+    _applyUpdateButton->setVisible(_domainServerRunning && _stagedUpdateAvailable);
+}
+
+void MainWindow::addProcessLogTab(BackgroundProcess* process, const QString& title) {
+    // a restarted process keeps its tab, and its viewer if it had one
+    QWidget* page = _processLogTabs.value(process);
+    if (page) {
+        _logsWidget->setTabText(_logsWidget->indexOf(page), title);
+        return;
+    }
+
+    // the viewer is only built once the tab is opened, the process's log store holds the output until then
+    page = process->getLogViewer() ? static_cast<QWidget*>(process->getLogViewer()) : new QWidget;
+    _processLogTabs.insert(process, page);
+    _logsWidget->addTab(page, title);
+}
+
+void MainWindow::removeProcessLogTab(BackgroundProcess* process) {
+    QWidget* page = _processLogTabs.take(process);
+    if (page) {
+        _logsWidget->removeTab(_logsWidget->indexOf(page));
+        delete page;
+    }
+}
+
+void MainWindow::openProcessLogTab(int index) {
+    QWidget* page = _logsWidget->widget(index);
+    BackgroundProcess* process = _processLogTabs.key(page);
+    if (!process || page == process->getLogViewer()) {
+        return;
+    }
+
+    QString title = _logsWidget->tabText(index);
+    QIcon icon = _logsWidget->tabIcon(index);
+    QString toolTip = _logsWidget->tabToolTip(index);
+
+    // swap the placeholder for the real viewer in the same spot
+    _logsWidget->blockSignals(true);
+    _logsWidget->removeTab(index);
+    _logsWidget->insertTab(index, process->createLogViewer(), icon, title);
+    _logsWidget->setTabToolTip(index, toolTip);
+    _logsWidget->setCurrentIndex(index);
+    _logsWidget->blockSignals(false);
+
+    _processLogTabs.insert(process, process->getLogViewer());
+    delete page;
+}
+
+void MainWindow::setLogTabAlert(BackgroundProcess* process, bool isAlerting, const QString& description) {
+    const int ALERT_BADGE_SIZE = 8;
+
+    int tabIndex = _logsWidget->indexOf(_processLogTabs.value(process));
+    if (tabIndex == -1) {
+        return;
+    }
+
+    if (isAlerting) {
+        QPixmap badge(ALERT_BADGE_SIZE, ALERT_BADGE_SIZE);
+        badge.fill(Qt::transparent);
+
+        QPainter painter(&badge);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(redColor);
+        painter.drawEllipse(badge.rect());
+
+        _logsWidget->setTabIcon(tabIndex, QIcon(badge));
+        _logsWidget->setTabToolTip(tabIndex, description);
+    } else {
+        _logsWidget->setTabIcon(tabIndex, QIcon());
+        _logsWidget->setTabToolTip(tabIndex, QString());
+    }
+}
+
 void MainWindow::toggleContent(bool isRunning) {
     _stopServerButton->setVisible(isRunning);
     _startServerButton->setVisible(!isRunning);
     _domainServerRunning = isRunning;
     _serverAddressLabel->setVisible(isRunning);
+    updateStackStatusLabel();
     _viewLogsButton->setVisible(isRunning);
     _settingsButton->setVisible(isRunning);
     _copyLinkButton->setVisible(isRunning);
     _contentSetButton->setVisible(isRunning);
+    _applyUpdateButton->setVisible(isRunning && _stagedUpdateAvailable);
     _runAssignmentButton->setVisible(isRunning);
-    _assignmentScrollArea->setVisible(isRunning);
-    _assignmentScrollArea->widget()->setEnabled(isRunning);
+    _startSelectedButton->setVisible(isRunning);
+    _stopSelectedButton->setVisible(isRunning);
+    _removeSelectedButton->setVisible(isRunning);
+    _assignmentView->setVisible(isRunning && _assignmentModel->rowCount() > 0);
+    _assignmentView->setEnabled(isRunning);
+    _domainStatsWidget->setVisible(isRunning);
+
+    if (isRunning) {
+        updateWindowHeight();
+    }
     update();
 }
 
@@ -340,35 +511,67 @@ void MainWindow::toggleDomainServerButton() {
 }
 
 void MainWindow::addAssignment() {
-    AssignmentWidget* widget = new AssignmentWidget(this);
-    _assignmentLayout->addWidget(widget, ASSIGNMENT_LAYOUT_WIDGET_STRETCH, Qt::AlignTop);
-    resize(width(), _assignmentScrollArea->geometry().y()
-           + ASSIGNMENT_LAYOUT_RESIZE_FACTOR * _assignmentLayout->count()
-           + TOP_Y_PADDING);
-    _assignmentScrollArea->resize(_assignmentScrollArea->maximumWidth(), height() - _assignmentScrollArea->geometry().top());
+    _assignmentModel->addAssignment();
+    _assignmentView->scrollToBottom();
 }
 
-void MainWindow::openSettings() {
-    QDesktopServices::openUrl(QUrl(GlobalData::getInstance().getDomainServerBaseUrl() + "/settings/"));
+QList<int> MainWindow::selectedAssignmentRows() const {
+    QList<int> rows;
+    foreach(const QModelIndex& index, _assignmentView->selectionModel()->selectedRows()) {
+        rows << index.row();
+    }
+    return rows;
+}
+
+void MainWindow::startSelectedAssignments() {
+    _assignmentModel->start(selectedAssignmentRows());
 }
 
+void MainWindow::stopSelectedAssignments() {
+    _assignmentModel->stop(selectedAssignmentRows());
+}
 
-// XXX this code is duplicate of LimitedNodeList::getLocalServerPortFromSharedMemory
-bool MainWindow::getLocalServerPortFromSharedMemory(const QString key, QSharedMemory*& sharedMem, quint16& localPort) {
-    if (!sharedMem) {
-        sharedMem = new QSharedMemory(key, this);
+void MainWindow::removeSelectedAssignments() {
+    _assignmentModel->remove(selectedAssignmentRows());
+}
 
-        if (!sharedMem->attach(QSharedMemory::ReadOnly)) {
-            qWarning() << "Could not attach to shared memory at key" << key;
-        }
+void MainWindow::updateAssignmentButtons() {
+    bool hasSelection = _assignmentView->selectionModel()->hasSelection();
+    _startSelectedButton->setEnabled(hasSelection);
+    _stopSelectedButton->setEnabled(hasSelection);
+    _removeSelectedButton->setEnabled(hasSelection);
+}
+
+void MainWindow::updateAssignmentViewHeight() {
+    int rowCount = _assignmentModel->rowCount();
+    _assignmentView->setVisible(_domainServerRunning && rowCount > 0);
+
+    // grow with the list up to a point, past that the view scrolls and the window stays put
+    int visibleRows = qMin(rowCount, MAX_VISIBLE_ASSIGNMENT_ROWS);
+    int viewHeight = _assignmentView->horizontalHeader()->sizeHint().height()
+        + visibleRows * ASSIGNMENT_ROW_HEIGHT + _assignmentView->frameWidth() * 2;
+
+    if (viewHeight == _assignmentView->height()) {
+        return;
     }
 
-    if (sharedMem->isAttached()) {
-        sharedMem->lock();
-        memcpy(&localPort, sharedMem->data(), sizeof(localPort));
-        sharedMem->unlock();
-        return true;
+    _assignmentView->resize(_assignmentView->width(), viewHeight);
+    updateWindowHeight();
+}
+
+void MainWindow::updateWindowHeight() {
+    int bottom = _assignmentView->isVisibleTo(this) ? _assignmentView->geometry().bottom()
+        : _runAssignmentButton->geometry().bottom();
+
+    if (_domainStatsWidget->isVisibleTo(this)) {
+        _domainStatsWidget->move(GLOBAL_X_PADDING, bottom + DOMAIN_STATS_TOP_MARGIN);
+        bottom = _domainStatsWidget->geometry().bottom();
     }
 
-    return false;
+    resize(width(), bottom + TOP_Y_PADDING);
 }
+
+void MainWindow::openSettings() {
+    QDesktopServices::openUrl(QUrl(GlobalData::getInstance().getDomainServerBaseUrl() + "/settings/"));
+}
+
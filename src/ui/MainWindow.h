@@ -10,18 +10,21 @@
 #define hifi_MainWindow_h
 
 #include <QComboBox>
+#include <QHash>
 #include <QLabel>
 #include <QMouseEvent>
 #include <QPushButton>
-#include <QScrollArea>
 #include <QTabWidget>
-#include <QVBoxLayout>
+#include <QTableView>
 #include <QWidget>
-#include <QSharedMemory>
 
 
+#include "AssignmentModel.h"
+#include "DomainStatsWidget.h"
 #include "SvgButton.h"
 
+class BackgroundProcess;
+
 class MainWindow : public QWidget {
     Q_OBJECT
 public:
@@ -29,8 +32,11 @@ public:
 
     void setRequirementsLastChecked(const QString& lastCheckedDateTime);
     void setUpdateNotification(const QString& updateNotification);
+    void setStagedUpdateAvailable(bool isAvailable);
+    void addProcessLogTab(BackgroundProcess* process, const QString& title);
+    void removeProcessLogTab(BackgroundProcess* process);
+    void setLogTabAlert(BackgroundProcess* process, bool isAlerting, const QString& description);
     QTabWidget* getLogsWidget() { return _logsWidget; }
-    bool getLocalServerPortFromSharedMemory(const QString key, QSharedMemory*& sharedMem, quint16& localPort);
 
 protected:
     virtual void paintEvent(QPaintEvent*);
@@ -38,9 +44,16 @@ protected:
 private slots:
     void toggleDomainServerButton();
     void addAssignment();
+    void startSelectedAssignments();
+    void stopSelectedAssignments();
+    void removeSelectedAssignments();
+    void updateAssignmentButtons();
+    void updateAssignmentViewHeight();
+    void updateWindowHeight();
+    void openProcessLogTab(int index);
     void openSettings();
     void updateServerAddressLabel();
-    void updateServerBaseUrl();
+    void updateStackStatusLabel();
     void handleCopyLinkButton();
     void showContentSetPage();
 
@@ -48,24 +61,31 @@ private slots:
     void handleIndexPathChangeResponse(bool wasSuccessful);
 private:
     void toggleContent(bool isRunning);
+    QList<int> selectedAssignmentRows() const;
 
     bool _domainServerRunning;
+    bool _stagedUpdateAvailable;
 
     QString _requirementsLastCheckedDateTime;
     QString _updateNotification;
     SvgButton* _startServerButton;
     SvgButton* _stopServerButton;
     QLabel* _serverAddressLabel;
+    QLabel* _stackStatusLabel;
     QPushButton* _viewLogsButton;
     QPushButton* _settingsButton;
     QPushButton* _runAssignmentButton;
+    QPushButton* _startSelectedButton;
+    QPushButton* _stopSelectedButton;
+    QPushButton* _removeSelectedButton;
     QPushButton* _copyLinkButton;
     QPushButton* _contentSetButton;
+    QPushButton* _applyUpdateButton;
     QTabWidget* _logsWidget;
-    QVBoxLayout* _assignmentLayout;
-    QScrollArea* _assignmentScrollArea;
-
-    QSharedMemory* _localHttpPortSharedMem; // memory shared with domain server
+    QHash<BackgroundProcess*, QWidget*> _processLogTabs; // a placeholder until the tab is first opened
+    AssignmentModel* _assignmentModel;
+    QTableView* _assignmentView;
+    DomainStatsWidget* _domainStatsWidget;
 };
 
 #endif
@@ -7,9 +7,9 @@
 //
 
 #include "SvgButton.h"
+#include "SvgPixmapCache.h"
 
 #include <QPainter>
-#include <QSvgRenderer>
 #include <QCursor>
 
 SvgButton::SvgButton(QWidget* parent) :
@@ -23,10 +23,15 @@ void SvgButton::enterEvent(QEvent*) {
 
 void SvgButton::setSvgImage(const QString& svg) {
     _svgImage = svg;
+    update();
 }
 
 void SvgButton::paintEvent(QPaintEvent*) {
+    if (_svgImage.isEmpty()) {
+        return;
+    }
+
     QPainter painter(this);
-    QSvgRenderer renderer(_svgImage);
-    renderer.render(&painter);
+    painter.drawPixmap(0, 0, SvgPixmapCache::pixmap(_svgImage, size(), devicePixelRatio(),
+                                                    isEnabled() ? SvgPixmapCache::Normal : SvgPixmapCache::Disabled));
 }
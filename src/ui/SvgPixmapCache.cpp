@@ -0,0 +1,57 @@
+//
+//  SvgPixmapCache.cpp
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "SvgPixmapCache.h"
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QImage>
+#include <QPainter>
+#include <QPixmapCache>
+#include <QSvgRenderer>
+
+const qreal DISABLED_OPACITY = 0.4;
+
+static QSvgRenderer* sharedRenderer(const QString& path) {
+    static QHash<QString, QSvgRenderer*> renderers;
+
+    QSvgRenderer* renderer = renderers.value(path);
+    if (!renderer) {
+        // parented to the application so they go away with it
+        renderer = new QSvgRenderer(path, QCoreApplication::instance());
+        renderers.insert(path, renderer);
+    }
+
+    return renderer;
+}
+
+QPixmap SvgPixmapCache::pixmap(const QString& path, const QSize& size, qreal devicePixelRatio, State state) {
+    QString key = QString("svg:%1|%2x%3|%4|%5").arg(path).arg(size.width()).arg(size.height())
+        .arg(devicePixelRatio).arg(state);
+
+    QPixmap cachedPixmap;
+    if (QPixmapCache::find(key, &cachedPixmap)) {
+        return cachedPixmap;
+    }
+
+    // render at device resolution so the blit stays sharp on high-DPI screens
+    QImage image(size * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    if (state == Disabled) {
+        painter.setOpacity(DISABLED_OPACITY);
+    }
+    sharedRenderer(path)->render(&painter);
+    painter.end();
+
+    cachedPixmap = QPixmap::fromImage(image);
+    cachedPixmap.setDevicePixelRatio(devicePixelRatio);
+    QPixmapCache::insert(key, cachedPixmap);
+
+    return cachedPixmap;
+}
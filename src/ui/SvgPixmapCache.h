@@ -0,0 +1,29 @@
+//
+//  SvgPixmapCache.h
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_SvgPixmapCache_h
+#define hifi_SvgPixmapCache_h
+
+#include <QPixmap>
+#include <QSize>
+#include <QString>
+
+// Rendered SVGs shared by every widget that draws them. Each SVG file is parsed once into a
+// renderer, and each (path, size, device pixel ratio, state) is rendered once into a pixmap kept
+// in QPixmapCache, so repaints are a blit instead of an XML parse and rasterization.
+class SvgPixmapCache
+{
+public:
+    enum State {
+        Normal = 0,
+        Disabled
+    };
+
+    static QPixmap pixmap(const QString& path, const QSize& size, qreal devicePixelRatio, State state = Normal);
+};
+
+#endif
@@ -0,0 +1,131 @@
+//
+//  TimelineView.cpp
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "TimelineView.h"
+
+#include <QDateTime>
+#include <QFontDatabase>
+#include <QPainter>
+#include <QScrollBar>
+
+#include <algorithm>
+
+const int TEXT_LEFT_MARGIN = 4;
+const int COLUMN_SPACING = 8;
+const QString ROW_TIMESTAMP_FORMAT = "hh:mm:ss.zzz";
+
+TimelineView::TimelineView(LogTimeline* timeline, QWidget* parent) :
+    QAbstractScrollArea(parent),
+    _timeline(timeline),
+    _levelMask(ALL_LOG_LEVELS),
+    _nextSequence(0),
+    _sourceColumnWidth(0)
+{
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    viewport()->setAutoFillBackground(true);
+
+    connect(_timeline, &LogTimeline::entriesAppended, this, &TimelineView::appendEntries);
+
+    appendEntries();
+}
+
+void TimelineView::setFilter(const QBitArray& hiddenSources, quint8 levelMask) {
+    _hiddenSources = hiddenSources;
+    _levelMask = levelMask;
+
+    _rows.clear();
+    _nextSequence = _timeline->getFirstSequence();
+    appendEntries();
+}
+
+bool TimelineView::isVisibleEntry(const TimelineEntry& entry) const {
+    return (logLevelBit(entry.level) & _levelMask)
+        && !(entry.source < _hiddenSources.size() && _hiddenSources.testBit(entry.source));
+}
+
+void TimelineView::appendEntries() {
+    QScrollBar* scrollBar = verticalScrollBar();
+    bool followTail = scrollBar->value() >= scrollBar->maximum();
+
+    // the ring has moved past our oldest rows
+    qint64 firstSequence = _timeline->getFirstSequence();
+    QVector<qint64>::iterator firstKept = std::lower_bound(_rows.begin(), _rows.end(), firstSequence);
+    int droppedRows = firstKept - _rows.begin();
+    if (droppedRows > 0) {
+        _rows.remove(0, droppedRows);
+    }
+
+    _nextSequence = qMax(_nextSequence, firstSequence);
+    for (qint64 sequence = _nextSequence; sequence < _timeline->getEndSequence(); ++sequence) {
+        if (isVisibleEntry(_timeline->getEntry(sequence))) {
+            _rows.append(sequence);
+        }
+    }
+    _nextSequence = _timeline->getEndSequence();
+
+    // keep the same rows on screen when the top of the list was trimmed
+    if (!followTail && droppedRows > 0) {
+        scrollBar->setValue(qMax(0, scrollBar->value() - droppedRows));
+    }
+
+    updateScrollRange(followTail);
+}
+
+void TimelineView::resizeEvent(QResizeEvent* event) {
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollRange(false);
+}
+
+int TimelineView::visibleRowCount() const {
+    return viewport()->height() / fontMetrics().lineSpacing() + 1;
+}
+
+void TimelineView::updateScrollRange(bool followTail) {
+    int pageStep = visibleRowCount();
+    QScrollBar* scrollBar = verticalScrollBar();
+
+    scrollBar->setPageStep(pageStep);
+    scrollBar->setRange(0, qMax(0, _rows.size() - pageStep));
+
+    if (followTail) {
+        scrollBar->setValue(scrollBar->maximum());
+    }
+
+    _sourceColumnWidth = 0;
+    for (int source = 0; source < _timeline->getSourceCount(); ++source) {
+        _sourceColumnWidth = qMax(_sourceColumnWidth, fontMetrics().width(_timeline->getSourceName(source)));
+    }
+
+    viewport()->update();
+}
+
+void TimelineView::paintEvent(QPaintEvent*) {
+    QPainter painter(viewport());
+
+    int lineSpacing = fontMetrics().lineSpacing();
+    int timestampWidth = fontMetrics().width("00:00:00.000");
+    int sourceX = TEXT_LEFT_MARGIN + timestampWidth + COLUMN_SPACING;
+    int textX = sourceX + _sourceColumnWidth + COLUMN_SPACING;
+
+    int firstRow = verticalScrollBar()->value();
+    int endRow = qMin(_rows.size(), firstRow + visibleRowCount());
+    int y = fontMetrics().ascent();
+
+    for (int row = firstRow; row < endRow; ++row) {
+        const TimelineEntry& entry = _timeline->getEntry(_rows[row]);
+
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawText(TEXT_LEFT_MARGIN, y, QDateTime::fromMSecsSinceEpoch(entry.timestamp).toString(ROW_TIMESTAMP_FORMAT));
+        painter.drawText(textX, y, entry.text);
+
+        painter.setPen(_timeline->getSourceColor(entry.source));
+        painter.drawText(sourceX, y, _timeline->getSourceName(entry.source));
+
+        y += lineSpacing;
+    }
+}
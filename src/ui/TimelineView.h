@@ -0,0 +1,48 @@
+//
+//  TimelineView.h
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_TimelineView_h
+#define hifi_TimelineView_h
+
+#include <QAbstractScrollArea>
+#include <QBitArray>
+#include <QVector>
+
+#include "LogTimeline.h"
+
+// Virtualized view of the merged timeline. It keeps only the sequence numbers that pass the
+// current filter and paints the rows on screen, coloured by source.
+class TimelineView : public QAbstractScrollArea
+{
+    Q_OBJECT
+public:
+    explicit TimelineView(LogTimeline* timeline, QWidget* parent = 0);
+
+    void setFilter(const QBitArray& hiddenSources, quint8 levelMask);
+
+public slots:
+    void appendEntries();
+
+protected:
+    virtual void paintEvent(QPaintEvent*);
+    virtual void resizeEvent(QResizeEvent*);
+
+private:
+    bool isVisibleEntry(const TimelineEntry& entry) const;
+    void updateScrollRange(bool followTail);
+    int visibleRowCount() const;
+
+    LogTimeline* _timeline;
+    QBitArray _hiddenSources;
+    quint8 _levelMask;
+
+    QVector<qint64> _rows;
+    qint64 _nextSequence;
+    int _sourceColumnWidth;
+};
+
+#endif
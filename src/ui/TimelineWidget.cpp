@@ -0,0 +1,128 @@
+//
+//  TimelineWidget.cpp
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#include "TimelineWidget.h"
+
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QMessageBox>
+#include <QPixmap>
+#include <QPushButton>
+#include <QSplitter>
+#include <QVBoxLayout>
+
+const int SOURCE_LIST_WIDTH = 180;
+const int SOURCE_SWATCH_SIZE = 10;
+
+TimelineWidget::TimelineWidget(LogTimeline* timeline, QWidget* parent) :
+    QWidget(parent),
+    _timeline(timeline)
+{
+    QVBoxLayout* layout = new QVBoxLayout;
+
+    QHBoxLayout* controlsLayout = new QHBoxLayout;
+
+    _levelComboBox = new QComboBox;
+    _levelComboBox->addItem("All levels", ALL_LOG_LEVELS);
+    _levelComboBox->addItem("Warnings and errors", logLevelBit(LogLevelWarning) | logLevelBit(LogLevelCritical)
+                            | logLevelBit(LogLevelFatal));
+    _levelComboBox->addItem("Errors only", logLevelBit(LogLevelCritical) | logLevelBit(LogLevelFatal));
+    controlsLayout->addWidget(_levelComboBox);
+
+    QPushButton* exportButton = new QPushButton("Export...");
+    controlsLayout->addWidget(exportButton);
+    controlsLayout->addStretch();
+
+    layout->addLayout(controlsLayout);
+
+    QSplitter* splitter = new QSplitter;
+
+    _sourceList = new QListWidget;
+    _sourceList->setMaximumWidth(SOURCE_LIST_WIDTH);
+    splitter->addWidget(_sourceList);
+
+    _view = new TimelineView(_timeline);
+    splitter->addWidget(_view);
+    splitter->setStretchFactor(1, 1);
+
+    layout->addWidget(splitter, 1);
+    setLayout(layout);
+
+    updateSources();
+
+    connect(_timeline, &LogTimeline::sourcesChanged, this, &TimelineWidget::updateSources);
+    connect(_timeline, &LogTimeline::sourceRemoved, this, &TimelineWidget::removeSource);
+    connect(_sourceList, &QListWidget::itemChanged, this, &TimelineWidget::applyFilter);
+    connect(_levelComboBox, SIGNAL(currentIndexChanged(int)), SLOT(applyFilter()));
+    connect(exportButton, &QPushButton::clicked, this, &TimelineWidget::exportTimeline);
+}
+
+void TimelineWidget::showEvent(QShowEvent* event) {
+    QWidget::showEvent(event);
+
+    // the timeline only merges while it is on screen
+    _timeline->start();
+}
+
+void TimelineWidget::hideEvent(QHideEvent* event) {
+    QWidget::hideEvent(event);
+    _timeline->stop();
+}
+
+void TimelineWidget::updateSources() {
+    _sourceList->blockSignals(true);
+
+    for (int source = 0; source < _timeline->getSourceCount(); ++source) {
+        QListWidgetItem* item = _sourceList->item(source);
+
+        if (!item) {
+            QPixmap swatch(SOURCE_SWATCH_SIZE, SOURCE_SWATCH_SIZE);
+            swatch.fill(_timeline->getSourceColor(source));
+
+            item = new QListWidgetItem(QIcon(swatch), _timeline->getSourceName(source));
+            item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+            item->setCheckState(Qt::Checked);
+            _sourceList->addItem(item);
+        }
+
+        // stopped sources stay listed, their lines are still in the timeline
+        item->setForeground(_timeline->isSourceActive(source) ? palette().color(QPalette::Text)
+                                                               : palette().color(QPalette::Disabled, QPalette::Text));
+    }
+
+    _sourceList->blockSignals(false);
+}
+
+void TimelineWidget::removeSource(int source) {
+    delete _sourceList->takeItem(source);
+
+    // the sources after it moved down, and their filter bits with them
+    applyFilter();
+}
+
+QBitArray TimelineWidget::hiddenSources() const {
+    QBitArray hidden(_sourceList->count());
+    for (int source = 0; source < _sourceList->count(); ++source) {
+        hidden.setBit(source, _sourceList->item(source)->checkState() != Qt::Checked);
+    }
+    return hidden;
+}
+
+void TimelineWidget::applyFilter() {
+    _view->setFilter(hiddenSources(), _levelComboBox->currentData().toUInt());
+}
+
+void TimelineWidget::exportTimeline() {
+    QString path = QFileDialog::getSaveFileName(this, "Export timeline", "timeline.txt");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    if (!_timeline->exportTo(path, hiddenSources(), _levelComboBox->currentData().toUInt())) {
+        QMessageBox::warning(this, "Export failed", "Could not write the timeline to " + path);
+    }
+}
@@ -0,0 +1,43 @@
+//
+//  TimelineWidget.h
+//  StackManagerQt/src/ui
+//
+//  Copyright (c) 2014 High Fidelity. All rights reserved.
+//
+
+#ifndef hifi_TimelineWidget_h
+#define hifi_TimelineWidget_h
+
+#include <QComboBox>
+#include <QListWidget>
+#include <QWidget>
+
+#include "LogTimeline.h"
+#include "TimelineView.h"
+
+class TimelineWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit TimelineWidget(LogTimeline* timeline, QWidget* parent = 0);
+
+protected:
+    virtual void showEvent(QShowEvent*);
+    virtual void hideEvent(QHideEvent*);
+
+private slots:
+    void updateSources();
+    void removeSource(int source);
+    void applyFilter();
+    void exportTimeline();
+
+private:
+    QBitArray hiddenSources() const;
+
+    LogTimeline* _timeline;
+    QListWidget* _sourceList;
+    QComboBox* _levelComboBox;
+    TimelineView* _view;
+};
+
+#endif